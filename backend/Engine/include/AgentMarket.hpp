@@ -0,0 +1,80 @@
+#pragma once
+#include "SeriesAllocator.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Population of an agent-based market. Agents are split by kind:
+//  - fundamentalists buy below and sell above their own estimate of the
+//    value, once the mispricing exceeds their threshold
+//  - chartists follow the trend over their horizon (kHorizons)
+//  - noise traders follow the market's mood of the step plus their own
+//    noise
+// Parameters are drawn per agent around these centers.
+struct AgentMarketConfig {
+    size_t agents = 65536;
+    double fundamentalists = 0.3;   // shares of the agents; the rest trade on noise
+    double chartists = 0.3;
+    double value = 100.0;           // median fundamental value
+    double impact = 0.025;          // log-price change per unit of mean demand
+    double mood = 0.2;              // std-dev of the noise traders' common mood per step
+    uint64_t seed = 42;
+    int threads = 0;                // 0 = by population, up to one per hardware thread
+};
+
+// Prices formed by the aggregate demand of many simple agents: each step
+// every agent decides a demand in [-1, 1] x its weight from the current
+// price, its own parameters and, for noise traders, a draw keyed by
+// (seed, step, agent); the log price then moves by impact x the mean
+// demand. Nothing else is carried between steps, so the prices continue
+// from the last kLookback + 1 bars alone.
+//
+// Agents are stored as one array per parameter and kind, and decided by
+// the agent kernels (see Kernels.hpp) over fixed chunks of agents. The
+// chunks are spread over threads and their sums added in chunk order, so
+// prices depend neither on the thread count nor on the ISA.
+class AgentMarket {
+public:
+    static constexpr int kHorizons[] = {1, 2, 5, 10, 20, 50};   // chartist lookbacks, bars
+    static constexpr size_t kLookback = 50;
+
+    // Throws std::invalid_argument for a bad population or parameters
+    explicit AgentMarket(const AgentMarketConfig& config);
+
+    // Append steps to `prices`, which holds bars [first, first + size)
+    // and at least one bar, until it holds bar `bars - 1`
+    void extend(Series<double>& prices, size_t first, size_t bars);
+
+    const AgentMarketConfig& getConfig() const { return config; }
+    size_t fundamentalists() const { return value.size(); }
+    size_t chartists() const { return sensitivity.size(); }
+    size_t noiseTraders() const { return noise_weight.size(); }
+    int threads() const { return workers; }
+
+private:
+    struct Chunk {
+        enum Kind { FUNDAMENTAL, CHARTIST, NOISE } kind;
+        size_t begin, end;      // into the kind's arrays
+        int horizon;            // chartists: index into kHorizons
+    };
+    // What every chunk of one step reads
+    struct Step {
+        float inv_price;
+        float momentum[sizeof(kHorizons) / sizeof(int)];
+        float mood;
+        uint32_t key;
+    };
+    double chunkDemand(const Chunk& c, const Step& s) const;
+    Step inputs(const double* prices, size_t first, size_t t) const;
+
+    AgentMarketConfig config;
+    // Fundamentalists
+    Series<float> value, threshold, fundamental_weight;
+    // Chartists, grouped by horizon
+    Series<float> sensitivity, chartist_weight;
+    // Noise traders, numbered from noise_first for their draws
+    Series<float> noise_weight;
+    uint32_t noise_first = 0;
+    std::vector<Chunk> chunks;
+    int workers = 1;
+};
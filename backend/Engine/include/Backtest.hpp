@@ -0,0 +1,96 @@
+#pragma once
+#include "MarketSimulator.hpp"
+#include "strategy.hpp"
+#include "TradeLog.hpp"
+#include "SeriesAllocator.hpp"
+#include "CancelToken.hpp"
+#include "OrderBook.hpp"
+#include <memory>
+#include <string>
+
+// Start at t=50 to allow indicators to warm up
+constexpr int kFirstBar = 50;
+
+// Indicator windows of computeAllSignals
+constexpr int kRsiPeriod = 14;
+constexpr int kVolatilityWindow = 20;
+constexpr int kMaShort = 20;
+constexpr int kMaLong = 50;
+constexpr int kVolatilityMaWindow = 50;
+
+struct BacktestResult {
+    TradeLog trades;
+    Series<double> equity;   // realized equity per bar, from first_bar
+    size_t first_bar = kFirstBar;   // later in a run resumed from a checkpoint
+    double total_pnl = 0.0;
+    int num_trades = 0;
+    int win_count = 0;
+    double max_drawdown = 0.0;
+};
+
+// Compute ALL indicators so the user can select any combination
+void computeAllSignals(MarketSimulator& sim);
+
+// Long-only, one unit, fills at the bar price; stop loss and take profit
+// fill inside the bar, on its tick path (MarketSimulator::ticks).
+// Runs incrementally: advance(to) evaluates bars up to `to`, which the
+// simulator's signals must already cover. The strategy is copied.
+//
+// With Execution::BOOK, entries and rule exits are market orders for the
+// unit against an OrderBook that OrderFlow feeds from the simulator's
+// dynamics and seed, bar by bar up to the bar traded; they fill at the
+// average price taken, and an order finding no liquidity does not
+// trade. Stop loss and take profit still fill on the tick path.
+class Backtester {
+public:
+    // Throws std::invalid_argument if the strategy uses a missing signal
+    Backtester(const MarketSimulator& sim, const Strategy& strategy);
+
+    void advance(size_t to);
+    size_t position() const { return next; }    // next bar to evaluate
+    const Strategy& rules() const { return strategy; }
+
+    // Checkpoint: position, open trade and metrics. After restore() the
+    // result holds the trades and equity from the checkpoint on; the
+    // metrics are those of the whole run. Throws std::runtime_error if
+    // the state does not fit the simulator.
+    void save(CheckpointWriter& out) const;
+    void restore(CheckpointReader& in);
+    const BacktestResult& result() const { return res; }
+    BacktestResult& result() { return res; }
+
+private:
+    bool exitInBar(int t, double& fill) const;
+    bool fillAtBook(Side side, double& fill);
+
+    const MarketSimulator& sim;
+    Strategy strategy;
+    BacktestResult res;
+    std::vector<uint8_t> buy_mask, sell_mask, frame_mask;
+
+    size_t next = kFirstBar;
+    bool in_pos = false;
+    double entry_price = 0.0;
+    int entry_t = 0;
+    double peak = 0.0;      // running equity peak for the drawdown
+
+    // Execution::BOOK only
+    std::unique_ptr<OrderBook> book;
+    std::unique_ptr<OrderFlow> flow;
+    size_t flow_next = 0;   // next bar of order flow
+};
+
+// Whole series in one advance()
+BacktestResult runBacktest(const MarketSimulator& sim, const Strategy& strategy);
+
+// {"total_pnl","num_trades","win_rate","max_drawdown"}, rounded for display
+void appendMetricsJson(std::string& out, const BacktestResult& result);
+
+// {"metrics":{...},"prices":[...],"status":"...","trades":[...]}, the
+// contract App.jsx reads. A stopped run lists the bars it reached.
+void appendResultJson(std::string& out, PriceSpan prices,
+                      const BacktestResult& result,
+                      RunStatus status = RunStatus::COMPLETED);
+void appendResultJson(std::string& out, const double* prices, size_t count,
+                      const BacktestResult& result,
+                      RunStatus status = RunStatus::COMPLETED);
@@ -0,0 +1,30 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+// Threads of one run meet here between its phases; reusable, each
+// wait() returns once `count` threads have arrived
+class Barrier {
+public:
+    explicit Barrier(int count) : count(count) {}
+
+    void wait() {
+        std::unique_lock<std::mutex> lock(mu);
+        uint64_t gen = generation;
+        if (++arrived == count) {
+            arrived = 0;
+            generation++;
+            cv.notify_all();
+            return;
+        }
+        cv.wait(lock, [&] { return generation != gen; });
+    }
+
+private:
+    std::mutex mu;
+    std::condition_variable cv;
+    int count;
+    int arrived = 0;
+    uint64_t generation = 0;
+};
@@ -0,0 +1,55 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// How a run ended. Stopped runs keep the bars processed so far.
+enum class RunStatus {
+    COMPLETED,
+    CANCELLED,
+    DEADLINE_EXCEEDED
+};
+
+inline const char* runStatusName(RunStatus s) {
+    switch (s) {
+        case RunStatus::CANCELLED: return "cancelled";
+        case RunStatus::DEADLINE_EXCEEDED: return "deadline_exceeded";
+        default: return "completed";
+    }
+}
+
+// Cooperative stop signal for one run: an explicit cancel() from any
+// thread (or a signal handler) and/or a deadline. Long loops poll
+// check() between chunks; nothing is interrupted mid-chunk.
+class CancelToken {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    void cancel() { cancelled.store(true, std::memory_order_relaxed); }
+
+    // Deadline `ms` from now; ms <= 0 clears it
+    void setTimeout(int64_t ms) {
+        int64_t at = 0;
+        if (ms > 0) {
+            auto when = Clock::now() + std::chrono::milliseconds(ms);
+            at = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     when.time_since_epoch()).count();
+        }
+        deadline_ns.store(at, std::memory_order_relaxed);
+    }
+
+    RunStatus check() const {
+        if (cancelled.load(std::memory_order_relaxed)) return RunStatus::CANCELLED;
+        int64_t at = deadline_ns.load(std::memory_order_relaxed);
+        if (at != 0) {
+            int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                              Clock::now().time_since_epoch()).count();
+            if (now >= at) return RunStatus::DEADLINE_EXCEEDED;
+        }
+        return RunStatus::COMPLETED;
+    }
+
+private:
+    std::atomic<bool> cancelled{false};
+    std::atomic<int64_t> deadline_ns{0};    // steady clock, 0 = none
+};
@@ -0,0 +1,79 @@
+#pragma once
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+// Field encoding of run snapshots (see Pipeline::checkpoint). Plain
+// values in host byte order, like TradeLog::writeBinary: a snapshot is
+// read back by the engine build that wrote it.
+class CheckpointWriter {
+public:
+    explicit CheckpointWriter(std::ostream& out) : out(out) {}
+
+    template <typename T>
+    void value(const T& v) {
+        static_assert(std::is_trivially_copyable<T>::value, "plain values only");
+        raw(&v, sizeof(v));
+    }
+
+    void raw(const void* p, size_t bytes) {
+        out.write(static_cast<const char*>(p), (std::streamsize)bytes);
+    }
+
+    // u64 count, then the elements
+    template <typename T>
+    void values(const T* v, size_t n) {
+        value((uint64_t)n);
+        raw(v, n * sizeof(T));
+    }
+
+    void text(const std::string& s) { values(s.data(), s.size()); }
+
+    bool ok() const { return (bool)out; }
+
+private:
+    std::ostream& out;
+};
+
+// Reads what CheckpointWriter wrote. Throws std::runtime_error on a
+// short or oversized field, so a truncated file is never half-applied.
+class CheckpointReader {
+public:
+    explicit CheckpointReader(std::istream& in) : in(in) {}
+
+    template <typename T>
+    T value() {
+        static_assert(std::is_trivially_copyable<T>::value, "plain values only");
+        T v;
+        raw(&v, sizeof(v));
+        return v;
+    }
+
+    // Element count of the next values() field, at most `limit`
+    size_t count(size_t limit) {
+        uint64_t n = value<uint64_t>();
+        if (n > limit) throw std::runtime_error("Corrupt checkpoint");
+        return (size_t)n;
+    }
+
+    // The n elements of a values() field whose count() was read
+    template <typename T>
+    void values(T* v, size_t n) { raw(v, n * sizeof(T)); }
+
+    std::string text(size_t limit = 4096) {
+        std::string s(count(limit), '\0');
+        raw(&s[0], s.size());
+        return s;
+    }
+
+    void raw(void* p, size_t bytes) {
+        if (!in.read(static_cast<char*>(p), (std::streamsize)bytes))
+            throw std::runtime_error("Corrupt checkpoint");
+    }
+
+private:
+    std::istream& in;
+};
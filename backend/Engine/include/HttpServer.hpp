@@ -0,0 +1,81 @@
+#pragma once
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct HttpRequest {
+    std::string method;
+    std::string path;       // without the query string
+    std::string query;
+    std::vector<std::pair<std::string, std::string>> headers;  // names lower-cased
+    std::string body;
+
+    // nullptr if absent; name must be lower case
+    const std::string* header(const std::string& name) const;
+};
+
+struct HttpResponse {
+    int status = 200;
+    std::string content_type = "application/json";
+    std::string body;
+    std::vector<std::pair<std::string, std::string>> headers;   // extra headers
+};
+
+// Completes one request, from any thread and at any time after the
+// handler was called; copies refer to the same request. Either send()
+// once, or begin() + chunk()... + end() for a chunked response. If the
+// last copy goes away first the client gets a 500 (or a cut-short body).
+class HttpReply {
+public:
+    struct Channel;
+    explicit HttpReply(std::shared_ptr<Channel> channel) : ch(std::move(channel)) {}
+
+    void send(const HttpResponse& r);
+    bool begin(const HttpResponse& head);       // status + headers, body ignored
+    bool chunk(const std::string& data);        // false once the client has gone
+    void end();
+    bool gone() const;                          // client disconnected
+
+private:
+    std::shared_ptr<Channel> ch;
+};
+
+// Called on a worker thread, once per request. Quick routes reply before
+// returning; long ones keep the reply and finish it elsewhere.
+using HttpHandler = std::function<void(const HttpRequest&, HttpReply)>;
+
+struct HttpServerOptions {
+    std::string host = "127.0.0.1";
+    int port = 8000;
+    int workers = 0;                    // 0 = one per hardware thread
+    size_t max_body = size_t(8) << 20;
+    int idle_timeout_s = 30;            // keep-alive connections
+};
+
+// Minimal HTTP/1.1 server: one I/O thread (epoll on Linux, poll() on
+// other POSIX systems) feeding a fixed worker pool. Supports keep-alive,
+// pipelining, Content-Length bodies and chunked (streamed) responses;
+// every response carries CORS
+// headers and OPTIONS preflights are answered directly. Replies may
+// complete off the pool (see HttpReply), so workers need not block on
+// long runs.
+class HttpServer {
+public:
+    HttpServer(HttpServerOptions opts, HttpHandler handler);
+    ~HttpServer();
+
+    // Requests matching `predicate` skip the worker queue and are handled
+    // on the I/O thread, e.g. cancellation that must not wait behind the
+    // runs it cancels. Those handler calls must reply before returning.
+    void setInline(std::function<bool(const HttpRequest&)> predicate);
+
+    // Blocks until stop(), SIGINT or SIGTERM. false + error if it can't listen.
+    bool run(std::string& error);
+    void stop();
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+};
@@ -0,0 +1,52 @@
+#pragma once
+#include "SeriesAllocator.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+// Ticks per bar of an expanded bar
+constexpr int kTicksPerBar = 64;
+
+// Tick paths inside bars, generated only for the bars asked for. The
+// path of bar t is a Brownian bridge from close t-1 to close t whose
+// randomness comes from (seed, t) alone, so it is the same whichever
+// bars are expanded, in whatever order, and the bars themselves are
+// untouched. Recently used paths are kept, least recently used out
+// first. Thread-safe.
+class IntrabarPaths {
+public:
+    // kTicksPerBar + 1 prices: close t-1, the ticks, close t
+    using Path = std::shared_ptr<const Series<double>>;
+
+    struct Stats {
+        size_t entries = 0;
+        size_t capacity = 0;
+        uint64_t hits = 0;
+        uint64_t misses = 0;     // = paths generated
+    };
+
+    IntrabarPaths(uint64_t seed, size_t capacity) : seed(seed), capacity(capacity) {}
+
+    // Path of bar t between its open (close t-1) and close; sd is the
+    // std-dev of a whole bar's change, spread evenly over the ticks
+    Path get(size_t t, double open, double close, double sd);
+
+    Stats stats() const;
+
+private:
+    struct Entry {
+        size_t bar;
+        Path path;
+    };
+    using List = std::list<Entry>;
+
+    uint64_t seed;
+    size_t capacity;
+    mutable std::mutex mu;
+    List lru;                           // front = most recent
+    std::unordered_map<size_t, List::iterator> index;
+    uint64_t hits = 0, misses = 0;
+};
@@ -0,0 +1,49 @@
+#pragma once
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Minimal append-only JSON emitters for the hot output columns.
+// nlohmann::json is still used for small objects (metrics); large
+// numeric arrays are written straight into the output buffer.
+
+inline void appendNumber(std::string& out, double v) {
+    if (!std::isfinite(v)) {
+        out += "null";    // same as nlohmann for NaN / inf
+        return;
+    }
+    char buf[32];
+    auto res = std::to_chars(buf, buf + sizeof(buf), v);
+    out.append(buf, res.ptr);
+}
+
+inline void appendNumber(std::string& out, int64_t v) {
+    char buf[24];
+    auto res = std::to_chars(buf, buf + sizeof(buf), v);
+    out.append(buf, res.ptr);
+}
+
+// Array elements without the brackets, for arrays written in pieces;
+// `first` = no separator before v[0]
+template <typename T>
+inline void appendElements(std::string& out, const T* v, size_t n, bool first = true) {
+    out.reserve(out.size() + n * 20 + 1);
+    for (size_t i = 0; i < n; i++) {
+        if (i || !first) out += ',';
+        appendNumber(out, (double)v[i]);
+    }
+}
+
+template <typename T>
+inline void appendArray(std::string& out, const T* v, size_t n) {
+    out += '[';
+    appendElements(out, v, n);
+    out += ']';
+}
+
+template <typename Vec>
+inline void appendArray(std::string& out, const Vec& v) {
+    appendArray(out, v.data(), v.size());
+}
@@ -0,0 +1,142 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Instruction set a kernel table was built for.
+enum class Isa {
+    SCALAR,
+    SSE2,
+    AVX2,
+    AVX512
+};
+
+// Most jumps a model path takes in one bar (see ModelCoefficients)
+constexpr int kMaxJumps = 8;
+
+// Per-bar coefficients of the stochastic model kernels, set up by the
+// models from their parameters (see StochasticModel.hpp)
+struct ModelCoefficients {
+    double drift = 0.0;             // of the log price; GBM and Jumps Ito-corrected
+    double sigma = 0.0;
+    double omega = 0.0, alpha = 0.0, beta = 0.0;    // GARCH(1,1)
+    double jump_mean = 0.0, jump_sd = 0.0;
+    double jump_cdf[kMaxJumps] = {};                // P(jumps <= k); the rest is cut off
+    double switch_at[2] = {};       // transition draw past which a regime moves by 1 / 2
+    double regime_drift[3] = {}, regime_reversion[3] = {}, regime_mean[3] = {},
+           regime_noise[3] = {};
+};
+
+// Paths in a lane block of the path-parallel kernels (see PathBatch.hpp).
+// A block's series are interleaved: bar t of path l at [t * kPathLanes + l].
+constexpr size_t kPathLanes = 8;
+
+// Long-only positions of the paths of a lane block (see laneBacktest);
+// counts are held as doubles so every field is a lane of doubles
+struct LaneBook {
+    double open[kPathLanes] = {};       // 1 while a position is open
+    double entry[kPathLanes] = {};
+    double equity[kPathLanes] = {};
+    double trades[kPathLanes] = {};
+    double wins[kPathLanes] = {};
+    double peak[kPathLanes] = {};       // running equity peak
+    double drawdown[kPathLanes] = {};   // largest so far
+};
+
+// Hot loops of the engine, one implementation per ISA.
+// Every variant produces bit-identical results: sums run in the same
+// order as the scalar code and no variant contracts into FMA.
+struct KernelTable {
+    Isa isa;
+
+    // out[i] = mean(in[t-w+1 .. t]) for t = from + i, t in [from, to).
+    // Requires from >= w - 1.
+    void (*rollingMean)(const double* in, double* out,
+                        size_t from, size_t to, int w);
+
+    // out[i] = population std-dev of r[t-w+1 .. t] for t = from + i.
+    // Requires from >= w - 1.
+    void (*rollingStd)(const double* r, double* out,
+                       size_t from, size_t to, int w);
+
+    // mask bit i &= (lhs[i] op rhs[i]), rhs == nullptr compares against c.
+    // Bit i lives in byte i / 8, bit i % 8. op is '<', '>' or '='.
+    void (*compareF64)(const double* lhs, const double* rhs, double c,
+                       char op, uint8_t* mask, size_t n);
+    void (*compareF32)(const float* lhs, const float* rhs, float c,
+                       char op, uint8_t* mask, size_t n);
+
+    // Largest (running peak - equity) over equity[0 .. n).
+    // peak carries the running maximum in and out across calls.
+    double (*maxDrawdown)(const double* equity, size_t n, double& peak);
+
+    // Demand of n agents of one kind (see AgentMarket.hpp), added into
+    // 16 float lanes: agent i into lanes[i % 16], in agent order, so
+    // every variant sums the same values in the same order.
+    // Fundamentalists: weight * x if |x| > threshold, x = value * inv_price - 1
+    void (*fundamentalDemand)(const float* value, const float* threshold, const float* weight,
+                              float inv_price, size_t n, float* lanes);
+    // Chartists: weight * clamp(sensitivity * momentum, -1, 1)
+    void (*chartistDemand)(const float* sensitivity, const float* weight, float momentum,
+                           size_t n, float* lanes);
+    // Noise traders: weight * clamp(sentiment + u, -1, 1), u uniform in
+    // [-1, 1] hashed from key and the agent's number first + i
+    void (*noiseDemand)(const float* weight, float sentiment, uint32_t key, uint32_t first,
+                        size_t n, float* lanes);
+
+    // n paths of a stochastic model, one per lane: advance each from bar
+    // t by `steps` bars. price[p] and state[p] hold path p's bar t (and
+    // the model's state: GARCH variance, regime) and are left at its
+    // last bar; bar t + 1 + s goes to out[s * stride + p]. Path p draws
+    // its normals from key[p] and the bar number alone.
+    void (*gbmPaths)(const ModelCoefficients& c, const uint64_t* key, double* price,
+                     double* state, size_t n, uint64_t t, size_t steps, double* out,
+                     size_t stride);
+    void (*garchPaths)(const ModelCoefficients& c, const uint64_t* key, double* price,
+                       double* state, size_t n, uint64_t t, size_t steps, double* out,
+                       size_t stride);
+    void (*jumpPaths)(const ModelCoefficients& c, const uint64_t* key, double* price,
+                      double* state, size_t n, uint64_t t, size_t steps, double* out,
+                      size_t stride);
+    void (*switchingPaths)(const ModelCoefficients& c, const uint64_t* key, double* price,
+                           double* state, size_t n, uint64_t t, size_t steps, double* out,
+                           size_t stride);
+
+    // Lane blocks: each path of the block gets exactly what the single
+    // path kernels and loops compute for it. out[(t - from) * kPathLanes
+    // + l] for t in [from, to), as rollingMean / rollingStd per path.
+    void (*laneMean)(const double* in, double* out, size_t from, size_t to, int w);
+    void (*laneStd)(const double* r, double* out, size_t from, size_t to, int w);
+    // Wilder RSI of window w over bars [from, to), the average gain and
+    // loss of bar from - 1 carried in and out of gain[l] / loss[l]
+    void (*laneRsi)(const double* prices, double* out, double* gain, double* loss,
+                    size_t from, size_t to, int w);
+    // Backtester's state machine (close fills) over n bars: bit l of
+    // buy[i] / sell[i] is path l's rule mask at bar i
+    void (*laneBacktest)(const double* prices, const uint8_t* buy, const uint8_t* sell,
+                         size_t n, LaneBook& book);
+
+    // Strategy variants in lanes (see StrategySweep.hpp): bit l of
+    // mask[i] &= (signal[i] op threshold[l]) for the kPathLanes
+    // thresholds, one mask byte per bar
+    void (*thresholdF64)(const double* signal, const double* threshold, char op,
+                         uint8_t* mask, size_t n);
+    void (*thresholdF32)(const float* signal, const float* threshold, char op,
+                         uint8_t* mask, size_t n);
+    // laneBacktest with one price per bar, the same for every lane
+    void (*variantBacktest)(const double* prices, const uint8_t* buy, const uint8_t* sell,
+                            size_t n, LaneBook& book);
+};
+
+// Kernels for the selected ISA. Detected from CPUID on first use.
+const KernelTable& kernels();
+
+// Best ISA this CPU (and OS) supports.
+Isa detectIsa();
+
+// Force a variant, e.g. from --isa. Returns false if the CPU or the
+// build does not support it; the current selection is kept.
+bool selectIsa(Isa isa);
+
+const char* isaName(Isa isa);
+bool parseIsa(const std::string& name, Isa& out);
@@ -0,0 +1,24 @@
+#pragma once
+#include "SeriesAllocator.hpp"
+#include <cstddef>
+#include <string>
+
+// Whole file, read-only. POSIX maps it shared, so every process reading
+// the same file uses the same page cache pages and nothing is copied;
+// elsewhere the file is read into 64-byte aligned memory.
+// Throws std::runtime_error if the file cannot be opened or read.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return base; }
+    size_t size() const { return length; }
+
+private:
+    const char* base = nullptr;
+    size_t length = 0;
+    Series<char> copy;          // without mmap
+};
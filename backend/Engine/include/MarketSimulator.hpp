@@ -1,9 +1,36 @@
 #pragma once
+#include <memory>
 #include <vector>
 #include <unordered_map>
 #include <random>
 #include "config.hpp"
 #include "PriceSeries.hpp"
+#include "SignalColumn.hpp"
+#include "SeriesAllocator.hpp"
+#include "Checkpoint.hpp"
+#include "PriceSource.hpp"
+#include "Intrabar.hpp"
+#include "AgentMarket.hpp"
+#include "StochasticModel.hpp"
+
+constexpr int kMaxTimeframe = 1 << 20;     // base bars per frame bar
+constexpr size_t kMaxTimeframes = 8;        // per simulator
+
+// Price process of a generated market, per bar:
+//   next = price + drift + reversion * (mean - price) + noise * z
+// with z standard normal, floored at 0.01; bar 0 is 100
+struct MarketDynamics {
+    double drift;
+    double reversion;
+    double mean;
+    double noise;
+};
+// Market names as in Config ("Trending", "Sideways", "MeanReverting").
+// "Agents" prices form from an AgentMarket's demand and the stochastic
+// model markets follow their StochasticModel; their dynamics are the
+// closest walk (for the default parameters), for tick paths and order
+// flow.
+MarketDynamics marketDynamics(const std::string& market);
 
 enum class SignalType {
     PRICE,
@@ -14,21 +41,34 @@ enum class SignalType {
     VOLATILITY_MA
 };
 
-
 class MarketSimulator {
 public:
     MarketSimulator(const Config& cfg);
     
     // Phase 1
     void runMarket();
+    // Generate until the series holds `bars` prices (continues the rng)
+    void extendMarket(size_t bars);
+
+    // Take prices from `source` instead of generating them, e.g. a path
+    // library or recorded data on disk. Runs then only expose them bar by
+    // bar; nothing is copied. timesteps is capped at the source's bars.
+    void usePrices(std::shared_ptr<const PriceSource> source);
+    bool borrowsPrices() const { return source != nullptr; }
 
     // Phase 2
     void computeMovingAverage(int short_w, int long_w);
 
-    // Access
-    const std::vector<double>& getPrices() const;
+    // Access. Series hold bars [origin(), bars()); origin() is 0 unless
+    // the simulator was restored from a checkpoint.
+    PriceSpan getPrices() const { return {price_data, price_count}; }
+    size_t origin() const { return first; }
+    size_t bars() const { return first + price_count; }
     std::vector<SignalType> getAvailableSignals() const;
     double getSignal(SignalType type, int t) const;
+    const SignalColumn& getColumn(SignalType type) const;
+    SignalPrecision getPrecision() const { return config.precision; }
+    const Config& getConfig() const { return config; }
     void computeRSI(int period);
     void computeVolatility(int window);
     void computeMovingAverageOnSignal(
@@ -36,8 +76,38 @@ public:
         SignalType dst,
         int window
     );
+    // Fill every computed signal up to the current price count
+    void extendSignals();
+
+    // Timeframes: the prices resampled into bars of k base bars (see
+    // Resampler) and a simulator on their closes with every indicator of
+    // this one, so indicators run on the frame bars. Kept up to date by
+    // extendMarket() / extendSignals(); k = 1 is this simulator. Throws
+    // std::invalid_argument for k outside 1..kMaxTimeframe, past
+    // kMaxTimeframes, or after restore().
+    void addTimeframe(int k);
+    // Simulator of timeframe k, whose bar j is frame bar j (nullptr = none)
+    const MarketSimulator* timeframe(int k) const;
+    // OHLCV of every timeframe
+    const Resampler& timeframes() const { return resampler; }
+
+    // Tick path inside bar t (origin() < t < bars()), see IntrabarPaths;
+    // expanded on first use and cached
+    IntrabarPaths::Path ticks(size_t t) const;
+    // Std-dev of one bar's price change: the market's noise, or for
+    // recorded prices that of their first changes
+    double barVolatility() const;
+    // The market's dynamics; recorded prices have no drift or reversion
+    // and their barVolatility() as noise
+    MarketDynamics dynamics() const;
     static std::string signalName(SignalType s);
 
+    // Checkpoint: the rng (or model state), the indicator states and the
+    // last bars the indicators look back on. restore() replaces the market state with
+    // the saved one; only that tail of the earlier bars is held after it.
+    void save(CheckpointWriter& out) const;
+    void restore(CheckpointReader& in);
+
 
 private:
     // existing
@@ -46,9 +116,44 @@ private:
     double stepTrending(double price);
     double stepSideways(double price);
     double stepMeanReverting(double price);
+    SignalColumn& newColumn(SignalType type);
+
+    // Indicators registered by the compute* calls, so extendSignals()
+    // can fill the bars added by extendMarket()
+    struct Indicator {
+        enum Kind { MOVING_AVERAGE, RSI, VOLATILITY, SIGNAL_AVERAGE } kind;
+        SignalType dst;
+        SignalType src;
+        int window;
+        size_t done = 0;        // bars filled so far
+        double gain = 0.0;      // RSI smoothing state
+        double loss = 0.0;
+    };
+    void addIndicator(Indicator ind);
+    void fill(Indicator& ind);
+
+    std::unique_ptr<MarketSimulator> frameSimulator(int k) const;
+    void appendPrices(const double* data, size_t count);
+    void resample();
+    void resetTimeframes();
+
     // new
-    std::vector<double> prices;
-    std::unordered_map<SignalType, std::vector<double>> signals;
+    Series<double> prices;      // generated bars
+    std::shared_ptr<const PriceSource> source;  // of borrowed bars
+    const double* source_data = nullptr;        // bar 0 of them
+    size_t source_bars = 0;
+    const double* price_data = nullptr;     // bar `first`, either way
+    size_t price_count = 0;
+    std::unordered_map<SignalType, SignalColumn> signals;
+    std::vector<Indicator> indicators;
+    size_t first = 0;           // bar of prices[0]
+    double recorded_sd = 0.0;   // barVolatility() of recorded prices
+    std::unique_ptr<IntrabarPaths> intrabar;
+    std::unique_ptr<AgentMarket> agents;    // "Agents" market, made on first use
+    std::unique_ptr<StochasticModel> model; // of a model market, else nullptr
+    double model_state = 0.0;               // its path's state at the last bar
+    Resampler resampler;        // prices -> timeframes
+    std::vector<std::unique_ptr<MarketSimulator>> frames;  // one per resampler frame
 };
 
 
@@ -0,0 +1,69 @@
+#pragma once
+#include "MarketSimulator.hpp"
+#include "SeriesAllocator.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// How a MultiAssetMarket stores its prices:
+//  - TIME_MAJOR: bar t's prices of every asset are contiguous, for
+//    cross-sectional passes (one bar, all assets)
+//  - ASSET_MAJOR: each asset's prices are contiguous, for per-asset
+//    passes like the single-asset indicators
+enum class AssetLayout { TIME_MAJOR, ASSET_MAJOR };
+
+struct MultiAssetConfig {
+    std::string market = "Sideways";    // dynamics of every asset (marketDynamics)
+    size_t assets = 1;
+    int timesteps = 1000;
+    uint64_t seed = 42;
+    // Correlation of the assets' noise: assets x assets, row-major,
+    // symmetric positive definite. Empty = every pair has `rho`.
+    std::vector<double> correlation;
+    double rho = 0.0;                   // 0 <= rho < 1
+    AssetLayout layout = AssetLayout::TIME_MAJOR;
+    int threads = 0;                    // 0 = one per hardware thread
+};
+
+// Many assets following one market's dynamics with correlated noise.
+// The correlation matrix is factorized once (Cholesky, L L^T = C); the
+// noise of bar t is L z_t, computed for blocks of bars and rows of L so
+// each block of L is reused from cache. z_t comes from a counter-based
+// generator keyed by (seed, t, asset), so the prices do not depend on
+// how the bars are split between threads. A single rho uses the
+// one-factor form sqrt(rho) f_t + sqrt(1 - rho) z_t instead, which has
+// the same correlation at O(assets) per bar.
+class MultiAssetMarket {
+public:
+    // Throws std::invalid_argument for a bad size or a correlation that
+    // is not symmetric positive definite
+    explicit MultiAssetMarket(MultiAssetConfig cfg);
+
+    // Generate every bar: noise in parallel over chunks of bars, then the
+    // price recursion in parallel over groups of assets
+    void generate();
+
+    const MultiAssetConfig& getConfig() const { return config; }
+    size_t assets() const { return config.assets; }
+    size_t bars() const { return bars_; }
+
+    double price(size_t asset, size_t t) const {
+        return config.layout == AssetLayout::TIME_MAJOR ? data[t * config.assets + asset]
+                                                        : data[asset * bars_ + t];
+    }
+    // All prices in the configured layout
+    const double* prices() const { return data.data(); }
+    // Bar t of every asset (TIME_MAJOR) / every bar of one asset
+    // (ASSET_MAJOR); nullptr in the other layout
+    const double* crossSection(size_t t) const;
+    const double* series(size_t asset) const;
+
+private:
+    void noiseChunk(size_t from, size_t to, Series<double>& z, Series<double>& e);
+    void recurse(size_t first_asset, size_t last_asset);
+
+    MultiAssetConfig config;
+    size_t bars_;
+    Series<double> chol;        // packed lower triangle: row i at i * (i + 1) / 2
+    Series<double> data;
+};
@@ -0,0 +1,147 @@
+#pragma once
+#include "Checkpoint.hpp"
+#include "MarketSimulator.hpp"
+#include "TradeLog.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Price of one book tick
+constexpr double kBookTick = 0.01;
+
+// Price-time priority limit order book over a window of integer price
+// ticks. Every tick in the window is a level in one array holding the
+// head and tail of its queue and its total quantity; orders are nodes
+// of a pool, linked into their level's queue, so adding, cancelling and
+// filling an order is O(1) and allocates nothing once the pool has
+// grown. A bitmap of the non-empty levels finds the next price when the
+// best one empties. Order ids carry their pool slot and a generation:
+// a cancel goes straight to its node, and the id of an order that was
+// filled or cancelled is simply stale.
+//
+// The window (a power of two of ticks) is a ring: recenter() moves it
+// with the market, and the orders on levels it leaves are cancelled.
+class OrderBook {
+public:
+    using OrderId = uint64_t;
+    static constexpr OrderId kNoOrder = 0;
+    static constexpr int64_t kNoPrice = INT64_MIN;
+
+    // What an incoming order took from the book
+    struct Execution {
+        int64_t qty = 0;
+        int64_t notional = 0;   // sum of tick x qty
+        uint32_t fills = 0;     // resting orders it traded with
+    };
+
+    struct Stats {
+        uint64_t adds = 0;
+        uint64_t cancels = 0;
+        uint64_t rejects = 0;   // limit orders outside the window
+        uint64_t fills = 0;
+        uint64_t volume = 0;
+        uint64_t evicted = 0;   // cancelled by recenter()
+    };
+
+    // Window of `window_ticks` (rounded up to a power of two, >= 128)
+    // around center_tick
+    explicit OrderBook(int64_t center_tick, size_t window_ticks = 1 << 16);
+
+    // Trade against the other side at prices up to `tick` (BUY) / down
+    // to it (SELL), then rest what is left. Returns the resting order,
+    // or kNoOrder if it filled completely or `tick` is outside the window.
+    OrderId limit(Side side, int64_t tick, int64_t qty, Execution* taken = nullptr);
+    // Take up to qty from the other side, best prices first
+    Execution market(Side side, int64_t qty);
+    // Immediate or cancel: the trading part of limit(), nothing rests
+    Execution ioc(Side side, int64_t tick, int64_t qty);
+    // false if the order is no longer resting
+    bool cancel(OrderId id);
+
+    // Move the window to be centered on `tick`
+    void recenter(int64_t tick);
+
+    int64_t bestBid() const { return bid; }     // kNoPrice if none
+    int64_t bestAsk() const { return ask; }
+    int64_t depth(int64_t tick) const;          // resting quantity at a tick
+    size_t orders() const { return live; }
+    const Stats& stats() const { return counts; }
+
+    // Checkpoint: every resting order with its id and queue position
+    void save(CheckpointWriter& out) const;
+    void restore(CheckpointReader& in);
+
+private:
+    static constexpr uint32_t kNil = UINT32_MAX;
+
+    struct Level {
+        uint32_t head = kNil;
+        uint32_t tail = kNil;
+        int64_t qty = 0;
+    };
+    struct Node {
+        int64_t tick;
+        int64_t qty;
+        uint32_t prev, next;    // queue links; next is the free list when unused
+        uint32_t generation;
+        Side side;
+    };
+
+    bool inWindow(int64_t tick) const { return tick >= lo && tick < lo + (int64_t)size; }
+    Level& level(int64_t tick) { return levels[(size_t)tick & mask]; }
+    const Level& level(int64_t tick) const { return levels[(size_t)tick & mask]; }
+    uint32_t allocate();
+    void release(uint32_t slot);
+    void unlink(uint32_t slot);     // from its queue; fixes bitmap and best prices
+    void take(Side side, int64_t limit_tick, int64_t& qty, Execution& e);
+    int64_t scanDown(int64_t tick) const;   // highest non-empty tick in [lo, tick]
+    int64_t scanUp(int64_t tick) const;     // lowest non-empty tick in [tick, lo + size)
+    void evict(int64_t from, int64_t to);   // cancel the orders on ticks [from, to)
+    void rebuild();
+
+    size_t size, mask;
+    int64_t lo;                     // lowest tick of the window, a multiple of 64
+    std::vector<Level> levels;
+    std::vector<uint64_t> occupied; // bit per level
+    std::vector<Node> nodes;
+    uint32_t free_head = kNil;
+    size_t live = 0;
+    int64_t bid = kNoPrice, ask = kNoPrice;
+    Stats counts;
+};
+
+// Synthetic order flow from a market's dynamics, around the path's
+// prices: each bar brings `events_per_bar` events, a mix of limit orders
+// quoted around the bar's price, cancels of resting ones and market
+// orders. Before them, the quotes the bar's move left on the wrong side
+// of its price are taken, so the book trades around the path. The
+// dynamics shape the rest:
+//  - noise sets how far from the price orders are quoted
+//  - drift tilts market orders toward buying (or selling)
+//  - reversion tilts them toward the mean
+// Each event is drawn from (seed, bar, event) alone.
+struct OrderFlowOptions {
+    int events_per_bar = 64;
+    double market_share = 0.05;     // of events
+    size_t depth = 2000;            // resting orders the cancels hold the book near
+    int max_qty = 10;
+};
+
+class OrderFlow {
+public:
+    OrderFlow(const MarketDynamics& dynamics, uint64_t seed, OrderFlowOptions options = {});
+
+    // Run bar t's events on `book`, recentered on `price`
+    void bar(OrderBook& book, size_t t, double price);
+    uint64_t events() const { return count; }
+
+    void save(CheckpointWriter& out) const;
+    void restore(CheckpointReader& in);
+
+private:
+    MarketDynamics dynamics;
+    uint64_t seed;
+    OrderFlowOptions options;
+    std::vector<OrderBook::OrderId> resting;    // ids it placed; stale once filled
+    uint64_t count = 0;
+};
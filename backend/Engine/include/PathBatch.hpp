@@ -0,0 +1,67 @@
+#pragma once
+#include "Kernels.hpp"
+#include "MarketSimulator.hpp"
+#include "SignalColumn.hpp"
+#include "StochasticModel.hpp"
+#include "strategy.hpp"
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+
+// What a backtest of one strategy on one path comes to (BacktestResult
+// without the trades and equity)
+struct PathMetrics {
+    double total_pnl = 0.0;
+    int num_trades = 0;
+    int win_count = 0;
+    double max_drawdown = 0.0;
+};
+
+// The paths of kPathLanes seeds of one market, generated, indicated and
+// backtested together as a lane block (see Kernels.hpp): prices and
+// signal columns are interleaved by path, so the indicator and strategy
+// kernels advance every path of the block with each vector instruction.
+// Each path gets exactly the prices, signals (computeAllSignals) and
+// metrics of a MarketSimulator and Backtester run of its seed.
+//
+// Model markets draw every lane's path in one kernel call, from the
+// lane's own counter-based stream. The regime markets draw from one
+// mt19937 per path, which has no lane form that keeps their paths, so
+// their prices are generated a path at a time and then interleaved.
+class PathBlock {
+public:
+    // cfg.seed is not used. Throws std::invalid_argument for the markets
+    // without generated paths ("Agents", recorded prices).
+    explicit PathBlock(const Config& cfg);
+
+    // Generate the paths of seeds[0 .. n), n from 1 to kPathLanes, and
+    // their signals; lanes past n repeat the last path
+    void generate(const uint32_t* seeds, size_t n);
+
+    size_t bars() const { return count; }
+    size_t paths() const { return lanes; }
+    const double* prices() const { return price_rows.data(); }
+    const SignalColumn& column(SignalType type) const;
+
+    // Metrics of `strategy` on each path, into out[0 .. paths()). Throws
+    // std::invalid_argument for what the lanes do not run: stop loss or
+    // take profit, book execution, timeframes and cross-sectional rules.
+    void backtest(const Strategy& strategy, PathMetrics* out) const;
+
+private:
+    void indicate();
+    void ruleMask(const std::vector<Condition>& rules, std::vector<uint8_t>& mask) const;
+
+    Config config;
+    std::unique_ptr<StochasticModel> model;
+    size_t count = 0, lanes = 0;
+    Series<double> price_rows;      // bar t of path l at [t * kPathLanes + l]
+    std::map<SignalType, SignalColumn> signals;     // as price_rows
+};
+
+// Metrics of every strategy on the path of every seed, at
+// [p * strategies.size() + s], over lane blocks spread across `threads`
+// threads (0 = one per hardware thread). Throws as PathBlock does.
+std::vector<PathMetrics> runPaths(const Config& cfg, const std::vector<Strategy>& strategies,
+                                  const std::vector<uint32_t>& seeds, int threads = 0);
@@ -0,0 +1,50 @@
+#pragma once
+#include "MappedFile.hpp"
+#include "MarketSimulator.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Pre-generated market paths in one indexed file, so runs over the same
+// seeds start backtesting without generating prices:
+//   "AXPL" | u32 version | u32 paths | u32 reserved
+//   | per path: char market[16], u32 seed, u32 reserved, u64 bars, u64 offset
+//   | per path, at a 4096-byte aligned offset: bars float64 prices
+// Host byte order, like the other binary formats of the engine. Each
+// path is exactly what MarketSimulator generates for its market and
+// seed, so a run on it gives the same result as one that generates.
+class PathLibrary {
+public:
+    struct Path {
+        const double* prices = nullptr;
+        size_t bars = 0;
+    };
+
+    // Maps the file. Throws std::runtime_error if it is not a library.
+    explicit PathLibrary(const std::string& path);
+
+    // The path of (market, seed) with at least `bars` bars, or none
+    Path find(const std::string& market, uint32_t seed, size_t bars) const;
+    size_t paths() const { return index.size(); }
+
+    // Generate every market x seed path of `timesteps` bars into `path`,
+    // on `threads` threads (0 = one per hardware thread). Markets are
+    // marketFromString() names. Returns the file size.
+    static uint64_t generate(const std::string& path, const std::vector<std::string>& markets,
+                             const std::vector<uint32_t>& seeds, int timesteps, int threads = 0);
+
+    // Library that Pipeline and the library API take prices from when it
+    // has the requested path (nullptr = none). Thread-safe.
+    static void install(std::shared_ptr<const PathLibrary> library);
+    static std::shared_ptr<const PathLibrary> installed();
+
+private:
+    MappedFile file;
+    std::unordered_map<std::string, Path> index;    // "market|seed"
+};
+
+// Point sim at the installed library's path for its config, if there is
+// one covering its timesteps; returns whether it did
+bool useLibraryPrices(MarketSimulator& sim);
@@ -0,0 +1,162 @@
+#pragma once
+#include "Backtest.hpp"
+#include "CancelToken.hpp"
+#include "Request.hpp"
+#include <deque>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Bars generated, indicated and backtested per step
+constexpr size_t kStreamChunk = 16384;
+
+// One request run chunk by chunk: prices, indicators and the backtest
+// advance together, so the first chunk is ready after kStreamChunk bars
+// whatever `timesteps` is, and a run can stop between any two chunks.
+// A completed run matches runMarket + computeAllSignals + runBacktest.
+// More strategies can ride on the same bars: each gets its own
+// Backtester, advanced chunk by chunk with the first while the chunk is
+// still in cache.
+// A run can be snapshotted and continued from the snapshot bit-exactly,
+// also to more timesteps than it had: see checkpoint().
+class Pipeline {
+public:
+    // Throws std::invalid_argument for a strategy it cannot run
+    explicit Pipeline(const Request& req, size_t chunk_bars = kStreamChunk);
+    Pipeline(const Pipeline&) = delete;
+    Pipeline& operator=(const Pipeline&) = delete;
+
+    bool done() const { return bars >= total; }
+    // First bar this run outputs: 0, or where a restored run resumed
+    size_t start() const { return first; }
+
+    // Process the next chunk; returns the bars [from, to) it covered
+    std::pair<size_t, size_t> step();
+
+    // Step until done or until the token stops the run
+    RunStatus run(const CancelToken* token = nullptr);
+
+    // Backtest another strategy over the same bars; returns its index.
+    // It catches up with the bars already run. Throws like the constructor.
+    size_t addStrategy(const Strategy& strategy);
+    size_t strategies() const { return backtests.size(); }
+
+    const MarketSimulator& simulator() const { return *sim; }
+    std::shared_ptr<const MarketSimulator> shareSimulator() const { return sim; }
+    const Backtester& backtester(size_t i = 0) const { return backtests[i]; }
+    BacktestResult takeResult(size_t i = 0) { return std::move(backtests[i].result()); }
+
+    // Snapshot of the run so far, a few KB whatever its length:
+    //   "AXCP" | u32 version | market | rules per strategy
+    //   | simulator (MarketSimulator::save) | Backtester::save per strategy
+    void checkpoint(std::ostream& out) const;
+
+    // Continue from a snapshot of the same market (timesteps aside) and
+    // strategies, before the first step(). Output then starts at the
+    // snapshot's bar (start()); metrics cover the whole run. Throws
+    // std::invalid_argument for a snapshot of another run or one past
+    // `timesteps`, std::runtime_error for an unreadable one.
+    void restore(std::istream& in);
+
+    // Write a snapshot to `path` every `every_bars` bars (at the end of
+    // a chunk; 0 = only on saveCheckpoint()). The file is replaced
+    // atomically, so a run killed while writing keeps the last one.
+    void checkpointTo(const std::string& path, size_t every_bars);
+    void saveCheckpoint();      // throws std::runtime_error if it cannot
+
+private:
+    std::shared_ptr<MarketSimulator> sim;
+    std::deque<Backtester> backtests;   // stable addresses as strategies join
+    size_t chunk;
+    size_t total;
+    size_t bars = 0;
+    size_t first = 0;
+    std::string save_path;
+    size_t save_every = 0;
+    size_t saved_at = 0;        // bars at the last snapshot
+};
+
+// Receives one NDJSON line (with its '\n'); return false to stop early
+using LineSink = std::function<bool(const std::string&)>;
+
+// Stream the pipeline as newline-delimited JSON:
+//   {"type":"chunk","from":F,"to":T,"prices":[...],"trades":[...],"metrics":{...}}
+//   ...
+//   {"type":"done","bars":N,"status":"completed","metrics":{...}}
+// prices are bars [F, T); trades are the fills inside them; metrics are
+// running totals. A sink returning false counts as CANCELLED (no done
+// line is sent); a token stop still ends with the done line.
+RunStatus streamNdjson(Pipeline& pipeline, const LineSink& sink,
+                       const CancelToken* token = nullptr);
+
+// streamNdjson a line at a time, for callers that interleave runs: each
+// next() runs at most one chunk and yields one line, the last being the
+// done line.
+class NdjsonRun {
+public:
+    NdjsonRun(Pipeline& pipeline, const CancelToken* token = nullptr)
+        : pipeline(pipeline), token(token) {}
+
+    bool finished() const { return sent_done; }
+    RunStatus status() const { return stop; }
+
+    // Replaces `line` with the next line (and its '\n')
+    void next(std::string& line);
+
+private:
+    Pipeline& pipeline;
+    const CancelToken* token;
+    RunStatus stop = RunStatus::COMPLETED;
+    size_t trades_sent = 0;
+    bool sent_done = false;
+};
+
+// simulateToJson a slice at a time: each step() runs one chunk or, once
+// the run is over, writes one block of the response, so even formatting
+// a long run leaves room for other work between slices. With several
+// strategies the prices text is written once and shared by every body.
+class JsonRun {
+public:
+    JsonRun(Pipeline& pipeline, const CancelToken* token = nullptr)
+        : pipeline(pipeline), token(token) {}
+
+    bool done() const { return phase == DONE; }
+    // The run itself is over; the strategies are fixed from here on
+    bool formatting() const { return phase != RUN; }
+    void step();
+
+    // Response JSON of strategy i, complete once done()
+    std::string& output(size_t i = 0) { return outputs[i]; }
+
+private:
+    enum Phase { RUN, PRICES, BODIES, DONE };
+
+    void appendHead(std::string& out, size_t i) const;  // up to the prices
+    void appendTail(std::string& out, size_t i) const;  // after them
+
+    Pipeline& pipeline;
+    const CancelToken* token;
+    RunStatus stop = RunStatus::COMPLETED;
+    Phase phase = RUN;
+    size_t written = 0;     // prices written so far
+    size_t bodies = 0;      // outputs assembled so far
+    std::string prices_text;    // shared by the bodies, several strategies only
+    std::vector<std::string> outputs;
+};
+
+// Peak bytes a request holds while it runs: prices, indicator columns
+// and equity per bar, plus the response body unless it is streamed.
+// An estimate for admission control, not a bound.
+size_t estimateMemory(const Request& req, bool streamed);
+
+// What one more strategy adds to a shared run: equity and its body
+size_t estimateStrategyMemory(const Request& req);
+
+// Whole request to the response JSON (see appendResultJson), with a
+// "status" field. req.timeout_ms arms the token's deadline; without a
+// token one is made for the deadline alone.
+std::string simulateToJson(const Request& req, CancelToken* token = nullptr);
@@ -0,0 +1,60 @@
+#pragma once
+#include "Backtest.hpp"
+#include "CancelToken.hpp"
+#include "MultiAsset.hpp"
+#include "SeriesAllocator.hpp"
+#include "strategy.hpp"
+#include <cstddef>
+#include <cstdint>
+
+// One strategy run on every asset of a portfolio. Each asset trades as
+// the Backtester trades one instrument (long-only, one unit, fills at
+// the bar price, from kFirstBar); equity is the realized P&L summed
+// over the assets.
+struct PortfolioResult {
+    size_t assets = 0;
+    size_t first_bar = kFirstBar;
+    Series<double> equity;          // aggregate realized equity per bar, from first_bar
+    Series<int64_t> open;           // positions held after each bar, from first_bar
+    double total_pnl = 0.0;
+    int64_t num_trades = 0;         // round trips, all assets
+    int64_t win_count = 0;
+    double max_drawdown = 0.0;      // of the aggregate equity
+    // Per asset
+    Series<double> asset_pnl;
+    Series<int64_t> asset_trades;
+    Series<int64_t> asset_wins;
+    RunStatus status = RunStatus::COMPLETED;
+};
+
+struct PortfolioOptions {
+    int threads = 0;                        // 0 = one per hardware thread
+    const CancelToken* cancel = nullptr;    // polled between blocks of bars
+};
+
+// Run `strategy` over prices stored time-major: bar t of asset a is
+// prices[t * assets + a]. Every asset gets the indicators of
+// computeAllSignals, with the same values a MarketSimulator computes on
+// its prices alone, so an asset without cross-sectional rules trades
+// exactly as runBacktest on it would.
+//
+// Rules with `cross` compare a signal's rank or z-score among the
+// assets of the bar, e.g. {"lhs": "RSI", "cross": "rank", "op": "<",
+// "rhs_value": 11} holds for the 10 assets with the highest RSI.
+//
+// Bars are processed in blocks, each in three passes over data held
+// time-major so every inner loop runs along the contiguous assets of a
+// bar: indicators for groups of assets, then the rules bar by bar (a
+// bar's cross-section is one row), then positions for groups of
+// assets. Only a block's indicators are held, so memory does not grow
+// with the bars. Results do not depend on the thread count; a stopped
+// run covers the blocks it finished.
+//
+// Throws std::invalid_argument for stop loss / take profit, book
+// execution, timeframes or cross-sectional rules against a signal.
+PortfolioResult runPortfolio(const double* prices, size_t assets, size_t bars,
+                             const Strategy& strategy, const PortfolioOptions& options = {});
+
+// Same on a generated market, which must be TIME_MAJOR
+PortfolioResult runPortfolio(const MultiAssetMarket& market, const Strategy& strategy,
+                             const PortfolioOptions& options = {});
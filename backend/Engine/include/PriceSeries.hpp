@@ -1,12 +1,87 @@
 #pragma once
+#include "SeriesAllocator.hpp"
+#include "Checkpoint.hpp"
 #include <vector>
 
-using namespace std;
+// OHLCV bars, one column per field
 class PriceSeries {
-    public :
-    vector<double> prices;
-    void add (double price){
-        prices.push_back(price);
+public:
+    Series<double> open, high, low, close, volume;
+
+    size_t size() const { return close.size(); }
+    bool empty() const { return close.empty(); }
+
+    // One tick: open = high = low = close, volume 1
+    void add(double price) { add(price, price, price, price, 1.0); }
+    void add(double o, double h, double l, double c, double v) {
+        open.push_back(o);
+        high.push_back(h);
+        low.push_back(l);
+        close.push_back(c);
+        volume.push_back(v);
     }
-    
+
+    void reserve(size_t n);
+    void clear();
+};
+
+// Frame bar that base bar t sees on a timeframe of k base bars: the last
+// one completed at or before t, -1 while there is none. Reading a frame
+// column through it aligns it to base bars without copying it.
+inline long frameBar(size_t t, int k) {
+    return (long)((t + 1) / (size_t)k) - 1;
+}
+
+// Aggregates base prices into bars of several sizes in one pass, e.g.
+// 5, 15 and 60 base bars each. Frame bar j of size k covers base bars
+// [j*k, (j+1)*k): open and close of the first and last, high and low
+// their max and min, volume their tick count. Only completed bars are
+// appended; the one in progress is kept apart.
+class Resampler {
+public:
+    // Add a frame and aggregate the `bars` base prices seen so far into
+    // it; returns its index. Throws std::invalid_argument for k < 1.
+    size_t add(int k, const double* prices, size_t bars);
+
+    // Aggregate the next `count` base prices into every frame
+    void extend(const double* prices, size_t count);
+
+    size_t frames() const { return list.size(); }
+    int frameSize(size_t i) const { return list[i].size; }
+    const PriceSeries& frame(size_t i) const { return list[i].bars; }
+    size_t origin(size_t i) const { return list[i].first; }    // frame bar of frame(i)[0]
+    size_t bars() const { return done; }                        // base bars aggregated
+
+    void clear();
+
+    // Checkpoint: the sizes and the bars in progress. After restore()
+    // the frames hold the bars completed from then on.
+    void save(CheckpointWriter& out) const;
+    void restore(CheckpointReader& in);
+
+private:
+    struct Frame {
+        int size;
+        PriceSeries bars;
+        size_t first = 0;
+        int ticks = 0;      // of the bar in progress
+        double o = 0.0, h = 0.0, l = 0.0, c = 0.0;
+
+        void tick(double p) {
+            if (ticks == 0) {
+                o = h = l = p;
+            } else {
+                if (p > h) h = p;
+                if (p < l) l = p;
+            }
+            c = p;
+            if (++ticks == size) {
+                bars.add(o, h, l, c, (double)ticks);
+                ticks = 0;
+            }
+        }
+    };
+
+    std::vector<Frame> list;
+    size_t done = 0;
 };
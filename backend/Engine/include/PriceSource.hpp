@@ -0,0 +1,53 @@
+#pragma once
+#include "SeriesAllocator.hpp"
+#include <cstddef>
+#include <memory>
+#include <string>
+
+// Read-only view of the held prices, generated or borrowed
+struct PriceSpan {
+    const double* ptr = nullptr;
+    size_t count = 0;
+
+    const double* data() const { return ptr; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    double operator[](size_t i) const { return ptr[i]; }
+    const double* begin() const { return ptr; }
+    const double* end() const { return ptr + count; }
+};
+
+// Prices a MarketSimulator takes instead of generating them: a recorded
+// series or a path of a PathLibrary. The indicators and the backtest
+// run on them exactly as on generated prices.
+class PriceSource {
+public:
+    virtual ~PriceSource() = default;
+    PriceSpan prices() const { return span; }
+    // Generated by this engine for the simulator's market and seed
+    virtual bool simulated() const { return false; }
+
+protected:
+    PriceSpan span;     // set by the subclass, valid while it lives
+};
+
+// Recorded prices from a file:
+//  - ".csv" / ".txt": one price per line, parsed in parallel (see
+//    parseCsvPrices); `column` picks the field by header name
+//  - anything else: raw float64 values in host byte order (numpy
+//    tofile(), or --convert-prices), mapped without copying
+// Throws std::runtime_error for a file it cannot read,
+// std::invalid_argument for a column it cannot find.
+std::shared_ptr<const PriceSource> loadPrices(const std::string& path,
+                                              const std::string& column = "",
+                                              int threads = 0);
+
+// CSV text to prices. Fields are split on ',' (or ';' / tab, whichever
+// the first line uses). A first line that is not all numbers is a
+// header; the column is `column` if given, else "close", else "price"
+// (any case), else the last one. Blank lines are skipped. The text is
+// cut into `threads` chunks on line boundaries (0 = one per hardware
+// thread) and each is parsed on its own thread. Numbers are parsed
+// exactly, as strtod would. Throws std::runtime_error on a bad number.
+Series<double> parseCsvPrices(const char* data, size_t size,
+                              const std::string& column = "", int threads = 0);
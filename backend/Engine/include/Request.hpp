@@ -0,0 +1,60 @@
+#pragma once
+#include "config.hpp"
+#include "strategy.hpp"
+#include "../json/json.hpp"
+#include <cstdint>
+#include <string>
+
+// One /simulate request: market config + strategy rules.
+struct Request {
+    Config config;
+    Strategy strategy;
+    bool stream = false;    // NDJSON chunks instead of one document
+    int64_t timeout_ms = 0; // deadline for the run, 0 = none
+    std::string id;         // "request_id", for cancel-by-id in server mode
+    std::string priority;   // "interactive" / "batch" in server mode, "" = by cost
+};
+
+// Map string names to SignalType Enum
+SignalType signalFromString(const std::string& s);
+
+// "rank" / "zscore" -> CrossSection, "" -> NONE; throws
+// std::invalid_argument for anything else
+CrossSection crossFromString(const std::string& s);
+
+// "close" / "book" -> Execution, "" -> CLOSE; throws
+// std::invalid_argument for anything else
+Execution executionFromString(const std::string& s);
+
+// Market name as the simulator knows it, from the UI's names:
+// "Mean Reversion" / "MeanReversion" -> "MeanReverting", "Sideways",
+// "Agents" / "Agent-based" -> "Agents", the stochastic models "GBM",
+// "GARCH", "Jumps" / "Jump diffusion", "Switching" / "Regime switching",
+// anything else -> "Trending"
+std::string marketFromString(const std::string& s);
+
+// {"mu": ..., "sigma": ..., ...} -> ModelParams, defaults for the
+// missing fields
+ModelParams parseModel(const nlohmann::json& j);
+
+// {"buy": [...], "sell": [...]} -> Strategy
+Strategy parseStrategy(const nlohmann::json& j);
+
+// Full request object, with the frontend defaults for missing fields
+Request parseRequest(const nlohmann::json& input);
+
+// What a completed run's output depends on (market, timesteps, seed,
+// precision, prices file, model parameters, rules) in one canonical
+// string: equal keys, equal results, however the JSON was written.
+// Delivery fields (stream, timeout_ms, request_id, priority) are left out.
+std::string canonicalKey(const Request& req);
+
+// The rules part of canonicalKey
+std::string rulesKey(const Strategy& strategy);
+
+// The market part of canonicalKey: requests that can share prices and
+// indicators and differ only in their rules
+std::string marketKey(const Request& req);
+
+// The model parameters' part of marketKey, "" for a market without them
+std::string modelKey(const Config& cfg);
@@ -0,0 +1,15 @@
+#pragma once
+#include "Request.hpp"
+#include <cstddef>
+
+// Single-pass, DOM-free parser for the /simulate request schema:
+//   market, timesteps, seed, precision, stream, timeout_ms, request_id,
+//   strategy.buy/sell[] = {lhs, op, rhs_type, rhs_value, rhs_signal}
+// Values are decoded straight into Config / Strategy. Returns false on
+// anything outside that schema (unknown fields, escapes, non-integer
+// timesteps, malformed input); callers then fall back to nlohmann.
+bool parseRequestFast(const char* data, size_t length, Request& out);
+
+// Fast path first, nlohmann DOM (parseRequest) as the fallback.
+// Throws nlohmann::json::parse_error for invalid JSON.
+Request parseRequestText(const char* data, size_t length);
@@ -0,0 +1,54 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Completed response bodies by canonicalKey(), least recently used out
+// first. Every byte an entry holds (key copies, body, list and map
+// nodes) counts against the capacity. Thread-safe.
+class ResultCache {
+public:
+    using Body = std::shared_ptr<const std::string>;
+
+    struct Stats {
+        size_t entries = 0;
+        size_t bytes = 0;
+        size_t capacity = 0;
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+    };
+
+    explicit ResultCache(size_t capacity_bytes) : capacity(capacity_bytes) {}
+
+    // nullptr on a miss; a hit becomes the most recent entry
+    Body get(const std::string& key);
+
+    // Bodies over a quarter of the capacity are not kept, so one large
+    // run cannot flush everything else
+    void put(const std::string& key, Body body);
+
+    Stats stats() const;
+
+private:
+    struct Entry {
+        std::string key;
+        Body body;
+        size_t bytes;
+    };
+    using List = std::list<Entry>;
+
+    static size_t footprint(const std::string& key, const std::string& body);
+    void evict(List::iterator it);      // lock held
+
+    size_t capacity;
+    mutable std::mutex mu;
+    List lru;                           // front = most recent
+    std::unordered_map<std::string, List::iterator> index;
+    size_t bytes = 0;
+    uint64_t hits = 0, misses = 0, evictions = 0;
+};
@@ -0,0 +1,99 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Priority classes, most urgent first
+enum class Priority {
+    INTERACTIVE,    // UI runs: short, latency matters
+    BATCH           // sweeps, Monte Carlo, long histories
+};
+
+const char* priorityName(Priority p);
+
+// Work in a request: bars evaluated over all strategies and seeds
+inline uint64_t jobCost(uint64_t timesteps, uint64_t strategies = 1, uint64_t seeds = 1) {
+    return timesteps * (strategies ? strategies : 1) * (seeds ? seeds : 1);
+}
+
+struct SchedulerOptions {
+    int executors = 0;                          // 0 = one per hardware thread
+    size_t memory_budget = size_t(1) << 30;     // estimated bytes in flight
+    size_t interactive_reserve = size_t(1) << 28;   // part of it BATCH may not use
+    size_t max_waiting = 256;                   // jobs held back by the budget
+    uint64_t interactive_cost = 1 << 18;        // classify(): up to this is INTERACTIVE
+    int interactive_burst = 16;                 // then one BATCH slice, so batch still moves
+};
+
+// A run cut into slices (one Pipeline chunk each). slice() is never
+// called concurrently for one job and returns true while work remains;
+// the job is finished, and its memory released, when it returns false.
+// not_before delays the first slice, e.g. to let related work gather.
+struct Job {
+    Priority priority = Priority::BATCH;
+    size_t memory = 0;
+    std::chrono::steady_clock::time_point not_before{};   // hold the first slice until
+    std::function<bool()> slice;
+};
+
+// Runs jobs on a fixed set of executor threads, one slice at a time.
+// Between slices an executor always takes the next INTERACTIVE job if
+// there is one, so a batch run is preempted at its next chunk boundary
+// and a UI request waits at most one chunk per executor. Jobs of one
+// class take turns. Jobs are admitted while their estimated memory fits
+// the budget, batch jobs leaving a reserve for interactive ones; the
+// rest wait, interactive first, and a full wait queue turns new jobs away.
+class Scheduler {
+public:
+    enum class Admission { ACCEPTED, TOO_LARGE, QUEUE_FULL };
+
+    struct Stats {
+        size_t running[2] = {0, 0};     // admitted and unfinished, by Priority
+        size_t waiting[2] = {0, 0};     // held back by the memory budget
+        size_t memory = 0;              // estimate for admitted jobs
+        uint64_t slices[2] = {0, 0};    // run since start
+    };
+
+    explicit Scheduler(SchedulerOptions opts = SchedulerOptions());
+    ~Scheduler();       // stops the executors; unfinished jobs are dropped
+    Scheduler(const Scheduler&) = delete;
+    Scheduler& operator=(const Scheduler&) = delete;
+
+    Priority classify(uint64_t cost) const;
+
+    // ACCEPTED: the job will run. Otherwise it is dropped unrun:
+    // TOO_LARGE if it alone exceeds the budget, QUEUE_FULL if too many wait.
+    Admission submit(Job job);
+
+    // Adjust the in-flight estimate for a job that took on more work
+    // (or gives it back, negative), outside its submitted `memory`
+    void charge(int64_t bytes);
+
+    Stats stats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void executorLoop();
+    // Next slice to run, else the earliest not_before into `wake`; lock held
+    bool pick(Job& job, Clock::time_point& wake);
+    void admit();               // waiting -> ready while memory allows; lock held
+    size_t budget(Priority p) const;
+
+    SchedulerOptions opts;
+    mutable std::mutex mu;
+    std::condition_variable cv;
+    std::deque<Job> ready[2];
+    std::deque<Job> waiting[2];
+    size_t memory = 0;
+    size_t running[2] = {0, 0};
+    uint64_t slices[2] = {0, 0};
+    int burst = 0;              // INTERACTIVE slices since the last BATCH one
+    bool stopping = false;
+    std::vector<std::thread> executors;
+};
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <vector>
+
+// Backing store for price and signal columns.
+//  - every block is 64-byte (cache line) aligned, so aligned AVX-512
+//    loads are legal from element 0
+//  - blocks of kHugePageBytes or more are mapped 2 MiB aligned and backed
+//    by huge pages where the OS allows it (explicit hugetlb, then THP via
+//    madvise); otherwise they silently fall back to normal pages
+constexpr size_t kSeriesAlignment = 64;
+constexpr size_t kHugePageBytes = size_t(2) << 20;
+
+void* seriesAllocate(size_t bytes);
+void seriesRelease(void* p, size_t bytes) noexcept;
+
+template <typename T>
+struct SeriesAllocator {
+    using value_type = T;
+
+    SeriesAllocator() noexcept = default;
+    template <typename U>
+    SeriesAllocator(const SeriesAllocator<U>&) noexcept {}
+
+    T* allocate(size_t n) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T))
+            throw std::bad_array_new_length();
+        return static_cast<T*>(seriesAllocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        seriesRelease(p, n * sizeof(T));
+    }
+};
+
+template <typename T, typename U>
+bool operator==(const SeriesAllocator<T>&, const SeriesAllocator<U>&) { return true; }
+template <typename T, typename U>
+bool operator!=(const SeriesAllocator<T>&, const SeriesAllocator<U>&) { return false; }
+
+// Column type used for every per-bar series in the engine
+template <typename T>
+using Series = std::vector<T, SeriesAllocator<T>>;
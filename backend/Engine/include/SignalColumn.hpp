@@ -0,0 +1,54 @@
+#pragma once
+#include "config.hpp"
+#include "SeriesAllocator.hpp"
+
+// One indicator series, stored as float64 or float32.
+// Kernels accumulate in double and narrow on set(); readers get the
+// stored value back widened to double (exact for both widths).
+class SignalColumn {
+public:
+    void reset(size_t n, SignalPrecision p) {
+        precision = p;
+        wide.clear();
+        narrow.clear();
+        if (p == SignalPrecision::F32) narrow.assign(n, 0.0f);
+        else wide.assign(n, 0.0);
+    }
+
+    void reserve(size_t n) {
+        if (precision == SignalPrecision::F32) narrow.reserve(n);
+        else wide.reserve(n);
+    }
+
+    // Grow to n bars, keeping the values already stored
+    void resize(size_t n) {
+        if (precision == SignalPrecision::F32) narrow.resize(n, 0.0f);
+        else wide.resize(n, 0.0);
+    }
+
+    size_t size() const {
+        return precision == SignalPrecision::F32 ? narrow.size() : wide.size();
+    }
+
+    bool isSingle() const { return precision == SignalPrecision::F32; }
+
+    void set(size_t i, double v) {
+        if (precision == SignalPrecision::F32) narrow[i] = (float)v;
+        else wide[i] = v;
+    }
+
+    double get(size_t i) const {
+        return precision == SignalPrecision::F32 ? (double)narrow[i] : wide[i];
+    }
+
+    // Raw column access for vector kernels
+    const double* f64() const { return wide.data(); }
+    const float* f32() const { return narrow.data(); }
+    double* f64() { return wide.data(); }
+    float* f32() { return narrow.data(); }
+
+private:
+    SignalPrecision precision = SignalPrecision::F64;
+    Series<double> wide;
+    Series<float> narrow;
+};
@@ -0,0 +1,131 @@
+#pragma once
+#include "CancelToken.hpp"
+#include "HttpServer.hpp"
+#include "Request.hpp"
+#include "ResultCache.hpp"
+#include "Scheduler.hpp"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Pipeline;
+class JsonRun;
+
+struct ServiceOptions {
+    int64_t default_timeout_ms = 0;         // for requests without "timeout_ms"; 0 = none
+    SchedulerOptions scheduling;
+    size_t cache_bytes = size_t(256) << 20;
+    int64_t batch_window_us = 0;            // hold a new market run for joiners
+    size_t max_batch = 64;                  // strategies on one market run
+};
+
+// HTTP routes of the engine service, same contract as backend/app.py:
+//   GET    /               health text
+//   POST   /simulate       request JSON in, simulation JSON out; NDJSON chunks
+//                          with "stream": true or Accept: application/x-ndjson
+//   DELETE /simulate/<id>  cancel a running request
+//   GET    /stats          scheduler queues and memory in flight
+// Every run gets an id: the request's "request_id", or one generated and
+// returned in X-Request-Id. Cancelled or timed-out runs answer 200 with
+// the bars reached and "status": "cancelled" / "deadline_exceeded".
+// Runs go through a Scheduler: "priority" picks the class, else the
+// cost (timesteps) does; a run over the memory budget gets 413 and one
+// that cannot even queue gets 503.
+// Identical non-streamed requests (same canonicalKey) share one run while
+// it is in flight and are then answered from an LRU cache; X-Cache says
+// "miss", "coalesced" or "hit". Each waiter keeps its own deadline and
+// cancel: it is answered with the bars reached when it stops, and the
+// run itself stops once nobody waits for it.
+// Requests that differ only in their rules batch onto one market run
+// (same marketKey): joins are taken while the run is queued, during
+// batch_window_us if set, and until its bars are all run (a late joiner
+// catches up on the bars already made). Prices and indicators
+// are computed once, every strategy is backtested per chunk, and the
+// prices text is formatted once for all bodies.
+class SimulateService {
+public:
+    explicit SimulateService(ServiceOptions opts = ServiceOptions());
+
+    void handle(const HttpRequest& req, HttpReply reply);
+
+    // Cheap control requests (cancel) that the server should answer
+    // without queueing behind running simulations
+    static bool isControl(const HttpRequest& req);
+
+private:
+    void simulate(const HttpRequest& req, HttpReply reply);
+    void stream(Request& request, std::shared_ptr<CancelToken> token, HttpReply reply);
+    Job newJob(const Request& request, bool streamed) const;    // class and memory set
+    HttpResponse cancel(const std::string& id);
+    HttpResponse stats() const;
+
+    // Register a run under request.id (assigned if empty); nullptr if the
+    // id is already running
+    std::shared_ptr<CancelToken> track(Request& request);
+    void untrack(const std::string& id);
+
+    // untrack(id) when the run's job lets go of it
+    struct Untrack {
+        SimulateService* self;
+        std::string id;
+        ~Untrack() { self->untrack(id); }
+    };
+
+    // One request waiting on a shared run
+    struct Waiter {
+        HttpReply reply;
+        std::string id;
+        std::shared_ptr<CancelToken> token;
+        std::shared_ptr<Untrack> untrack;
+        const char* cache;      // X-Cache
+    };
+
+    // One strategy run, shared by identical requests; waiters guarded by mu
+    struct Flight {
+        std::string key;            // canonicalKey
+        Strategy strategy;
+        std::vector<Waiter> waiters;
+    };
+
+    // Flights on one market run; strategy i of its Pipeline is members[i]
+    struct Batch {
+        std::string key;            // marketKey
+        std::vector<std::shared_ptr<Flight>> members;   // the running job's
+        std::vector<std::shared_ptr<Flight>> joining;   // mu: added next slice
+        size_t size = 0;            // mu: members + joining
+        size_t charged = 0;         // mu: memory charged for joiners
+    };
+
+    void join(Request& request, std::shared_ptr<CancelToken> token, HttpReply reply);
+
+    // Add the flights that joined since the last slice; `closing` stops
+    // further joins. Joiners whose strategy cannot run are failed.
+    void gather(const std::shared_ptr<Batch>& batch, Pipeline& pipeline, bool closing);
+
+    // Answer and drop waiters that stopped or left; false once nobody is
+    // left on the batch, which is then closed and should stop
+    bool prune(const std::shared_ptr<Batch>& batch, const Pipeline& pipeline);
+
+    // Hand every waiter its strategy's body and cache them all
+    void finish(const std::shared_ptr<Batch>& batch, JsonRun& run);
+
+    // Close the batch and answer all its waiters with `error`
+    void fail(const std::shared_ptr<Batch>& batch, const HttpResponse& error);
+
+    void release(const std::shared_ptr<Batch>& batch);      // joiners' memory
+    void retire(const std::shared_ptr<Flight>& flight);     // from flights; lock held
+    void close(const std::shared_ptr<Batch>& batch);        // from batches; lock held
+
+    ServiceOptions opts;
+    mutable std::mutex mu;
+    std::unordered_map<std::string, std::shared_ptr<CancelToken>> running;
+    uint64_t next_id = 1;
+    std::unordered_map<std::string, std::shared_ptr<Flight>> flights;
+    std::unordered_map<std::string, std::shared_ptr<Batch>> batches;   // open ones
+    uint64_t batched = 0;       // flights that joined an existing market run
+    ResultCache cache;
+    Scheduler scheduler;        // last: its jobs untrack on the way out
+};
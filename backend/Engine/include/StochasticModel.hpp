@@ -0,0 +1,85 @@
+#pragma once
+#include "Kernels.hpp"
+#include "config.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// Price processes with parameters (Config::model), one per market:
+//  - "GBM": geometric Brownian motion, log returns mu - sigma^2 / 2 + sigma z
+//  - "GARCH": GARCH(1,1) volatility clustering, log returns
+//    mu - h / 2 + r with r = sqrt(h) z and h' = omega + alpha r^2 + beta h;
+//    h starts at its long-run value
+//  - "Jumps": Merton's jump diffusion, GBM plus Poisson(jump_rate)
+//    jumps a bar of normal log size (jump_mean, jump_sd), compensated so
+//    the mean return stays mu
+//  - "Switching": a Markov chain over the Trending, Sideways and
+//    MeanReverting regimes (marketDynamics), which keeps its regime with
+//    probability `stay` a bar and otherwise moves to one of the other two
+// Bar 0 is 100. GBM, GARCH and Jumps prices stay within [0.01, 1e12],
+// where a strong drift over a long run would otherwise overflow. Paths
+// are generated in batches by the model kernels (see Kernels.hpp), one
+// path per SIMD lane, and each draws from its seed and the bar number
+// alone: a path is the same in any batch, on any ISA, and continues from
+// its last price and state.
+class StochasticModel {
+public:
+    // The model of `market`, nullptr for the other markets. Throws
+    // std::invalid_argument for parameters outside the model's range.
+    static std::unique_ptr<StochasticModel> create(const std::string& market,
+                                                   const ModelParams& params);
+    static bool isModel(const std::string& market);
+    // Key of the draws of the path of `seed`
+    static uint64_t pathKey(uint64_t seed);
+
+    virtual ~StochasticModel() = default;
+
+    // State of a path at bar 0
+    double initialState() const { return initial; }
+    // Mean and std-dev of a bar's price change around 100 in the long
+    // run: the closest additive walk (MarketDynamics)
+    double drift() const { return walk_drift; }
+    double volatility() const { return walk_noise; }
+
+    // Advance n paths from bar t by `steps` bars: price[p] and state[p]
+    // hold path p's bar t and are left at its last one; bar t + 1 + s of
+    // path p goes to out[s * stride + p]
+    void advance(const uint64_t* keys, double* price, double* state, size_t n, uint64_t t,
+                 size_t steps, double* out, size_t stride) const;
+
+    // Bars [0, bars) of the paths of seeds[0 .. n), interleaved: bar t of
+    // path p at out[t * n + p]
+    void generate(const uint64_t* seeds, size_t n, size_t bars, double* out) const;
+
+protected:
+    using Kernel = decltype(KernelTable::gbmPaths);
+    explicit StochasticModel(Kernel KernelTable::*kernel) : kernel(kernel) {}
+
+    ModelCoefficients coefficients;
+    double initial = 0.0;
+    double walk_drift = 0.0, walk_noise = 0.0;
+
+private:
+    Kernel KernelTable::*kernel;
+};
+
+class GbmModel : public StochasticModel {
+public:
+    explicit GbmModel(const ModelParams& params);
+};
+
+class GarchModel : public StochasticModel {
+public:
+    explicit GarchModel(const ModelParams& params);
+};
+
+class JumpModel : public StochasticModel {
+public:
+    explicit JumpModel(const ModelParams& params);
+};
+
+class SwitchingModel : public StochasticModel {
+public:
+    explicit SwitchingModel(const ModelParams& params);
+};
@@ -0,0 +1,64 @@
+#pragma once
+#include "MarketSimulator.hpp"
+#include "PathBatch.hpp"
+#include "strategy.hpp"
+#include <vector>
+
+// Many strategies on one market run, metrics only. Strategies that differ
+// only in the constants of their rules (the same signals, operators and
+// rule order on each side, e.g. RSI < 25 / 30 / 35 and RSI > 65 / 70 /
+// 75) are variants of one shape, and a shape's variants run kPathLanes
+// at a time: lane l of a vector holds variant l's threshold, each bar's
+// signal value is compared against all of them at once (thresholdF64 /
+// F32), and the backtest's state machine advances every variant with
+// masked updates, the price shared (variantBacktest).
+//
+// The lane groups run tile by tile: a tile of bars for every group, each
+// group's LaneBook carried to the next tile, so the signal columns and
+// prices of a tile come from memory once and from cache for the other
+// groups. The tile is tuned while the run goes (see run()).
+//
+// Strategies the lanes do not run (stop loss or take profit, book
+// execution, timeframes) go through a Backtester each. Every strategy
+// gets the metrics runBacktest reports for it.
+class StrategySweep {
+public:
+    // Throws std::invalid_argument as Backtester does for a strategy it
+    // cannot run. sim must hold its signals (computeAllSignals) from bar 0
+    // and outlive the sweep; the strategies are copied.
+    StrategySweep(const MarketSimulator& sim, const std::vector<Strategy>& strategies);
+
+    size_t strategies() const { return list.size(); }
+    size_t shapes() const { return groups.size(); }     // groups run in lanes
+    size_t blocks() const;                              // of up to kPathLanes variants
+    size_t serial() const { return others.size(); }     // through a Backtester each
+
+    // Bytes of columns and prices the lane groups read per bar
+    size_t barBytes() const { return bar_bytes; }
+
+    // Metrics of strategy s at out[s], with tiles of tile_bars bars;
+    // bars() or more is the naive order, one group at a time over all
+    // bars. 0 tunes the tile: the run's first tiles try sizes from a
+    // quarter to twice the one whose reads fill half the L2 cache, and
+    // the fastest per bar runs the rest. Tiles do not change results.
+    // `tile` gets the tile the run settled on.
+    std::vector<PathMetrics> run(size_t tile_bars = 0, size_t* tile = nullptr) const;
+
+private:
+    struct Masks {
+        std::vector<uint8_t> buy, sell, bits;
+    };
+    void runBlock(const size_t* index, size_t m, size_t from, size_t to, LaneBook& book,
+                  Masks& masks) const;
+    void ruleMask(const size_t* index, size_t m, bool buy, size_t from, size_t to,
+                  std::vector<uint8_t>& mask, std::vector<uint8_t>& bits) const;
+
+    const MarketSimulator& sim;
+    std::vector<Strategy> list;
+    std::vector<std::vector<size_t>> groups;    // indexes into list, by shape
+    std::vector<size_t> others;
+    size_t bar_bytes = 0;
+};
+
+// Size of the L2 cache (per core) the OS reports, 1 MB if it does not
+size_t l2CacheBytes();
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+enum class Side : uint8_t {
+    BUY,
+    SELL
+};
+
+// Columnar trade log (struct-of-arrays).
+// One contiguous column per field instead of one json object per fill.
+class TradeLog {
+public:
+    void reserve(size_t n);
+    void clear();
+
+    void recordBuy(int64_t t, double price);
+    void recordSell(int64_t t, double price, double pnl, int64_t entry_t);
+
+    size_t size() const { return bar.size(); }
+
+    // Column access
+    const std::vector<int64_t>& bars() const { return bar; }
+    const std::vector<Side>& sides() const { return side; }
+    const std::vector<double>& prices() const { return price; }
+    const std::vector<double>& pnls() const { return pnl; }
+    const std::vector<int64_t>& entries() const { return entry; }
+
+    // Serialization
+    // JSON keeps the existing contract: [{"t","type","price"[,"pnl"]}, ...]
+    void appendJson(std::string& out) const { appendJson(out, 0, size()); }
+    void appendJson(std::string& out, size_t from, size_t to) const;   // trades [from, to)
+    // Binary: "AXTL" | u32 version | u64 count | bar[] side[] price[] pnl[] entry[]
+    void writeBinary(std::ostream& out) const;
+
+private:
+    std::vector<int64_t> bar;     // bar index of the fill
+    std::vector<Side> side;
+    std::vector<double> price;
+    std::vector<double> pnl;      // realized on SELL, 0 on BUY
+    std::vector<int64_t> entry;   // bar index of the opening BUY
+};
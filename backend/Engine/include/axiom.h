@@ -0,0 +1,401 @@
+/*
+ * libaxiom - C ABI of the AXIOM simulation engine.
+ *
+ * Stable, C-only surface so the engine can be loaded in-process
+ * (Python ctypes/cffi, other languages) instead of spawning the CLI.
+ *
+ * Conventions
+ *  - functions returning int return AXIOM_OK (0) or an axiom_status
+ *  - functions returning a pointer return NULL on failure
+ *  - on failure axiom_last_error() describes the problem (per thread)
+ *  - column pointers stay valid until the owning handle is destroyed or
+ *    the simulator is regenerated; they are never copied
+ */
+#ifndef AXIOM_H
+#define AXIOM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#  if defined(AXIOM_BUILD_DLL)
+#    define AXIOM_API __declspec(dllexport)
+#  elif defined(AXIOM_USE_DLL)
+#    define AXIOM_API __declspec(dllimport)
+#  else
+#    define AXIOM_API
+#  endif
+#else
+#  define AXIOM_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Bumped on any incompatible change to this header */
+#define AXIOM_ABI_VERSION 1
+
+typedef enum axiom_status {
+    AXIOM_OK = 0,
+    AXIOM_ERR_ARGUMENT = 1,   /* bad handle, name or value */
+    AXIOM_ERR_STATE = 2,      /* e.g. signals requested before generate */
+    AXIOM_ERR_PARSE = 3,      /* malformed JSON */
+    AXIOM_ERR_INTERNAL = 4,
+    AXIOM_ERR_STOPPED = 5     /* a callback asked to stop */
+} axiom_status;
+
+typedef enum axiom_column {
+    /* simulator columns (axiom_sim_column) */
+    AXIOM_COL_PRICE = 0,
+    AXIOM_COL_MA_SHORT = 1,
+    AXIOM_COL_MA_LONG = 2,
+    AXIOM_COL_RSI = 3,
+    AXIOM_COL_VOLATILITY = 4,
+    AXIOM_COL_VOLATILITY_MA = 5,
+    /* timeframe bars (axiom_sim_timeframe_column; close is AXIOM_COL_PRICE) */
+    AXIOM_COL_OPEN = 6,
+    AXIOM_COL_HIGH = 7,
+    AXIOM_COL_LOW = 8,
+    AXIOM_COL_VOLUME = 9,             /* f64, base bars per bar */
+    /* result columns (axiom_result_column; also AXIOM_COL_PRICE: f64, the
+     * run's "prices", one per bar from bar 0, or from the checkpoint's
+     * bar when resumed, up to the last bar run) */
+    AXIOM_COL_EQUITY = 16,        /* f64, one per bar from the first traded bar */
+    AXIOM_COL_TRADE_BAR = 17,     /* i64 */
+    AXIOM_COL_TRADE_SIDE = 18,    /* u8: 0 = BUY, 1 = SELL */
+    AXIOM_COL_TRADE_PRICE = 19,   /* f64 */
+    AXIOM_COL_TRADE_PNL = 20,     /* f64, 0 on BUY */
+    AXIOM_COL_TRADE_ENTRY = 21,   /* i64, bar of the opening BUY */
+    /* portfolio columns (axiom_portfolio_column; equity is AXIOM_COL_EQUITY) */
+    AXIOM_COL_OPEN_POSITIONS = 22,    /* i64, positions held, per bar from the first traded bar */
+    AXIOM_COL_ASSET_PNL = 23,         /* f64, one per asset */
+    AXIOM_COL_ASSET_TRADES = 24       /* i64, round trips, one per asset */
+} axiom_column;
+
+typedef enum axiom_run_status {
+    AXIOM_RUN_COMPLETED = 0,
+    AXIOM_RUN_CANCELLED = 1,          /* partial: bars up to the stop */
+    AXIOM_RUN_DEADLINE_EXCEEDED = 2   /* partial, "timeout_ms" elapsed */
+} axiom_run_status;
+
+typedef enum axiom_dtype {
+    AXIOM_F64 = 0,
+    AXIOM_F32 = 1,
+    AXIOM_I64 = 2,
+    AXIOM_U8 = 3
+} axiom_dtype;
+
+typedef struct axiom_metrics {
+    double total_pnl;
+    int64_t num_trades;
+    double win_rate;
+    double max_drawdown;
+} axiom_metrics;
+
+typedef struct axiom_sim axiom_sim;
+typedef struct axiom_result axiom_result;
+typedef struct axiom_cancel axiom_cancel;
+typedef struct axiom_assets axiom_assets;
+typedef struct axiom_portfolio axiom_portfolio;
+
+AXIOM_API int axiom_abi_version(void);
+AXIOM_API const char* axiom_last_error(void);
+
+/* Kernel variant: "scalar", "sse2", "avx2", "avx512" */
+AXIOM_API int axiom_set_isa(const char* name);
+AXIOM_API const char* axiom_isa(void);
+
+/* --- Path library ------------------------------------------------- */
+
+/* Pre-generate the prices of every market x seed, seeds first_seed ..
+ * first_seed + seed_count - 1, as paths of `timesteps` bars in one
+ * indexed file (see PathLibrary.hpp). markets is comma-separated;
+ * threads 0 = one per hardware thread. */
+AXIOM_API int axiom_library_generate(const char* path, const char* markets,
+                                     uint32_t first_seed, uint32_t seed_count,
+                                     int timesteps, int threads);
+/* Map a library for this process: runs whose market and seed it holds,
+ * with at least their timesteps, take their prices from it instead of
+ * generating them, with the same results. Processes mapping the same
+ * file share its pages. NULL stops using it. */
+AXIOM_API int axiom_library_use(const char* path);
+
+/* --- Recorded prices --------------------------------------------- */
+
+/* Parse a CSV of prices (see axiom_sim_use_prices) once and write them
+ * as raw float64 values, which runs then map without parsing. *bars
+ * (may be NULL) receives the count. */
+AXIOM_API int axiom_prices_convert(const char* csv_path, const char* column,
+                                   const char* out_path, uint64_t* bars);
+
+/* --- Simulator ---------------------------------------------------- */
+
+/* market: "Trending", "Sideways", "MeanReverting", "Agents" ("Agent-based"),
+ * or a stochastic model: "GBM", "GARCH", "Jumps" ("Jump diffusion"),
+ * "Switching" ("Regime switching"); see StochasticModel.hpp. UI names are
+ * accepted and any other name runs "Trending". */
+AXIOM_API axiom_sim* axiom_sim_create(const char* market, int timesteps,
+                                      uint32_t seed, int float32_signals);
+AXIOM_API void axiom_sim_destroy(axiom_sim* sim);
+
+/* Run on recorded prices instead of generating them (see loadPrices in
+ * PriceSource.hpp): a CSV file, whose column may name the field (NULL =
+ * close / price / last), or raw float64 values. timesteps is capped at
+ * the file's bars. Call before axiom_sim_generate. */
+AXIOM_API int axiom_sim_use_prices(axiom_sim* sim, const char* path, const char* column);
+
+AXIOM_API int axiom_sim_generate(axiom_sim* sim);
+AXIOM_API int axiom_sim_compute_signals(axiom_sim* sim);
+
+AXIOM_API int axiom_sim_column(const axiom_sim* sim, int column,
+                               const void** data, size_t* length, int* dtype);
+
+/* Resample the prices into bars of `bars` base bars (2 .. 1048576, at
+ * most 8 per simulator; 1 does nothing), with every indicator also computed on them.
+ * Frame bar j covers base bars [j*bars, (j+1)*bars); only completed ones
+ * are held. Rules with "timeframe" add theirs when run. */
+AXIOM_API int axiom_sim_add_timeframe(axiom_sim* sim, int bars);
+/* Simulator and OHLCV columns of a timeframe, one value per frame bar */
+AXIOM_API int axiom_sim_timeframe_column(const axiom_sim* sim, int bars, int column,
+                                         const void** data, size_t* length, int* dtype);
+
+/* strategy_json: {"buy": [...], "sell": [...]} as sent by the UI.
+ * The result keeps the simulator's data alive. */
+AXIOM_API axiom_result* axiom_sim_run_strategy(axiom_sim* sim,
+                                               const char* strategy_json,
+                                               size_t length);
+
+/* --- Multi-asset markets ---------------------------------------- */
+
+/* `assets` assets of one market's dynamics with correlated noise (see
+ * MultiAsset.hpp). correlation: assets x assets row-major, symmetric
+ * positive definite; NULL = every pair has rho (0 <= rho < 1).
+ * asset_major stores each asset's bars contiguously, else each bar's
+ * assets. threads 0 = one per hardware thread. */
+AXIOM_API axiom_assets* axiom_assets_create(const char* market, size_t assets, int timesteps,
+                                            uint64_t seed, const double* correlation,
+                                            double rho, int asset_major, int threads);
+AXIOM_API int axiom_assets_generate(axiom_assets* market);
+/* All prices in the handle's layout: price of asset a at bar t is
+ * data[t * assets + a] (time-major) or data[a * bars + t] */
+AXIOM_API int axiom_assets_prices(const axiom_assets* market, const double** data,
+                                  size_t* assets, size_t* bars);
+AXIOM_API void axiom_assets_destroy(axiom_assets* market);
+
+/* Run strategy_json on every asset of a generated time-major market
+ * (see Portfolio.hpp): per-asset positions, aggregate equity. Rules may
+ * add "cross": "rank" (1 = highest) or "zscore" to compare a signal's
+ * standing among the assets of the bar with rhs_value. cancel may be
+ * NULL; a stopped run covers the bars it finished. */
+AXIOM_API axiom_portfolio* axiom_assets_run_strategy(const axiom_assets* market,
+                                                     const char* strategy_json, size_t length,
+                                                     int threads, axiom_cancel* cancel);
+AXIOM_API int axiom_portfolio_status(const axiom_portfolio* portfolio, int* status);
+/* Over all assets; max_drawdown of the aggregate equity */
+AXIOM_API int axiom_portfolio_metrics(const axiom_portfolio* portfolio, axiom_metrics* out);
+AXIOM_API int axiom_portfolio_column(const axiom_portfolio* portfolio, int column,
+                                     const void** data, size_t* length, int* dtype);
+AXIOM_API void axiom_portfolio_destroy(axiom_portfolio* portfolio);
+
+/* --- Order book --------------------------------------------------- */
+
+typedef struct axiom_book_bench {
+    uint64_t events;        /* order flow events run */
+    double seconds;         /* matching time, without generating the path */
+    double events_per_second;
+    uint64_t adds;          /* limit orders that rested */
+    uint64_t cancels;
+    uint64_t fills;         /* resting orders traded with */
+    uint64_t volume;
+} axiom_book_bench;
+
+/* Time the limit order book alone (see OrderBook.hpp): `events` events
+ * of synthetic order flow from a market's dynamics, on one thread.
+ * Strategies fill against such a book with "execution": "book". */
+AXIOM_API int axiom_book_benchmark(const char* market, uint64_t events, uint32_t seed,
+                                   axiom_book_bench* out);
+
+/* --- Agent-based market ------------------------------------------- */
+
+typedef struct axiom_agents_bench {
+    uint64_t agents;
+    uint64_t steps;
+    int threads;            /* workers the steps ran on */
+    double seconds;         /* stepping time, without drawing the agents */
+    double agent_steps_per_second;
+    double last_price;
+} axiom_agents_bench;
+
+/* Time an agent-based market (see AgentMarket.hpp) of `agents` agents
+ * over `steps` steps from 100. threads 0 picks by population. Runs use
+ * the market "Agents", a population of 65536. */
+AXIOM_API int axiom_agents_benchmark(uint64_t agents, uint64_t steps, uint64_t seed, int threads,
+                                     axiom_agents_bench* out);
+
+/* --- Stochastic models ------------------------------------------ */
+
+typedef struct axiom_model_bench {
+    uint64_t paths;
+    uint64_t bars;
+    double seconds;             /* batched generation of all paths */
+    double ns_per_path_bar;
+    double walk_ns_per_path_bar;    /* the regime walk of "Trending", a path at a time */
+    double mean_last_price;
+} axiom_model_bench;
+
+/* Time the batched kernel of a model market (see StochasticModel.hpp):
+ * `paths` paths of `bars` bars with seeds seed, seed + 1, ..., default
+ * parameters, against the scalar walk of the regime markets. */
+AXIOM_API int axiom_model_benchmark(const char* market, uint64_t paths, uint64_t bars,
+                                    uint64_t seed, axiom_model_bench* out);
+
+/* --- Path blocks ------------------------------------------------ */
+
+/* Monte Carlo over seeds: the request's strategy on the path of each of
+ * seeds[0 .. count) of its market, 8 paths at a time in SIMD lanes (see
+ * PathBatch.hpp). out[i] gets what a run with seed seeds[i] reports.
+ * The request's seed is not used. Rules run on the base bars with close
+ * fills; stops, the book and timeframes are AXIOM_ERR_ARGUMENT. threads
+ * 0 = one per hardware thread. */
+AXIOM_API int axiom_paths_run(const char* request_json, size_t length, const uint32_t* seeds,
+                              size_t count, int threads, axiom_metrics* out);
+
+typedef struct axiom_paths_bench {
+    uint64_t paths;
+    uint64_t bars;
+    double seconds;             /* lane blocks, generation included */
+    double serial_seconds;      /* a MarketSimulator and Backtester per path */
+    double path_bars_per_second;
+    int identical;              /* 1 if every path's metrics equal the serial run's */
+} axiom_paths_bench;
+
+/* Time the request on `paths` seeds from its own, on one thread: lane
+ * blocks against one run per seed */
+AXIOM_API int axiom_paths_benchmark(const char* request_json, size_t length, uint64_t paths,
+                                    axiom_paths_bench* out);
+
+/* --- Strategy sweeps -------------------------------------------- */
+
+/* Many strategies on the request's market, metrics only (see
+ * StrategySweep.hpp). strategies_json is a JSON array of strategy
+ * objects ({"buy": [...], "sell": [...], ...}), count its length; out[i]
+ * gets what a run of strategy i reports. The request's own strategy is
+ * not run. Strategies that differ only in their constants run 8 at a
+ * time in SIMD lanes. */
+AXIOM_API int axiom_sweep_run(const char* request_json, size_t length,
+                              const char* strategies_json, size_t strategies_length,
+                              axiom_metrics* out, size_t count);
+
+typedef struct axiom_sweep_bench {
+    uint64_t strategies;
+    uint64_t bars;              /* backtested per strategy */
+    uint64_t shapes;            /* lane groups the variants formed */
+    double seconds;             /* the sweep, variants in lanes */
+    double serial_seconds;      /* a Backtester per strategy */
+    double strategy_bars_per_second;
+    double serial_strategy_bars_per_second;
+    int identical;              /* 1 if every strategy's metrics equal the serial run's */
+} axiom_sweep_bench;
+
+/* Time `strategies` variants of the request's strategy on its market, on
+ * one thread: variant v has every constant of its rules scaled by
+ * 0.5 + v / strategies. The market run is not timed. */
+AXIOM_API int axiom_sweep_benchmark(const char* request_json, size_t length,
+                                    uint64_t strategies, axiom_sweep_bench* out);
+
+typedef struct axiom_tiling_bench {
+    uint64_t strategies;
+    uint64_t bars;
+    uint64_t blocks;            /* lane groups of up to 8 variants */
+    uint64_t tile_bars;         /* the tile the tuning settled on */
+    uint64_t bar_bytes;         /* columns and prices the lane groups read per bar */
+    double naive_seconds;       /* one lane group at a time over every bar */
+    double tiled_seconds;
+    /* Reads from beyond L2: once per lane group in the naive order when
+     * the columns do not fit in half the L2, once in all when tiled */
+    double naive_read_bytes;
+    double tiled_read_bytes;
+    int identical;              /* 1 if both orders give the same metrics */
+} axiom_tiling_bench;
+
+/* Time the sweep of axiom_sweep_benchmark's variants in the naive order
+ * and tiled, on one thread. The market run is not timed. */
+AXIOM_API int axiom_tiling_benchmark(const char* request_json, size_t length,
+                                     uint64_t strategies, axiom_tiling_bench* out);
+
+/* --- Cancellation ------------------------------------------------- */
+
+/* Runs poll the token between chunks and stop with partial results.
+ * axiom_cancel_trigger is thread-safe and async-signal-safe. */
+AXIOM_API axiom_cancel* axiom_cancel_create(void);
+AXIOM_API void axiom_cancel_trigger(axiom_cancel* cancel);
+AXIOM_API void axiom_cancel_destroy(axiom_cancel* cancel);
+
+/* --- Results ------------------------------------------------------ */
+
+/* Full request JSON in, same response as the CLI out. The request's
+ * "timeout_ms" sets a deadline; check axiom_result_status. */
+AXIOM_API axiom_result* axiom_run_json(const char* request_json, size_t length);
+/* Same, stoppable through cancel (may be NULL) */
+AXIOM_API axiom_result* axiom_run_json_cancellable(const char* request_json, size_t length,
+                                                   axiom_cancel* cancel);
+
+/* Streaming variant: the run advances in chunks and each NDJSON line
+ * (see Pipeline.hpp) is passed to on_line as soon as it is ready; the
+ * pointer is valid only during the call. Return non-zero from on_line
+ * to stop early (AXIOM_ERR_STOPPED). */
+typedef int (*axiom_line_fn)(const char* line, size_t length, void* user);
+AXIOM_API int axiom_stream_json(const char* request_json, size_t length,
+                                axiom_line_fn on_line, void* user);
+/* Same, stoppable through cancel (may be NULL); still ends with the
+ * done line, whose "status" says why it stopped */
+AXIOM_API int axiom_stream_json_cancellable(const char* request_json, size_t length,
+                                            axiom_line_fn on_line, void* user,
+                                            axiom_cancel* cancel);
+
+/* *status = axiom_run_status; metrics and columns cover the bars run */
+AXIOM_API int axiom_result_status(const axiom_result* result, int* status);
+AXIOM_API int axiom_result_metrics(const axiom_result* result, axiom_metrics* out);
+AXIOM_API int axiom_result_column(const axiom_result* result, int column,
+                                  const void** data, size_t* length, int* dtype);
+
+/* Response JSON, built on first call and owned by the result */
+AXIOM_API const char* axiom_result_json(axiom_result* result, size_t* length);
+
+/* Trade log as packed binary columns (see TradeLog::writeBinary) */
+AXIOM_API int axiom_result_save_trades(const axiom_result* result, const char* path);
+
+AXIOM_API void axiom_result_destroy(axiom_result* result);
+
+/* --- Checkpoints -------------------------------------------------- */
+
+/* Long runs can snapshot their state (rng, indicator state, the bars
+ * the indicators look back on, each strategy's position and metrics;
+ * a few KB) and later continue from it bit-exactly, also to more
+ * timesteps than they had. A resumed run outputs the bars from the
+ * snapshot on: its prices, trades and columns start there, its metrics
+ * cover the whole run. A snapshot is read by the build that wrote it. */
+typedef struct axiom_checkpoint {
+    const char* save_path;      /* NULL = no snapshots; else written at the end
+                                   of the run, stopped or not, replaced atomically */
+    uint64_t every_bars;        /* and every this many bars (0 = end only) */
+    const char* resume_path;    /* NULL = start from bar 0 */
+} axiom_checkpoint;
+
+/* axiom_run_json_cancellable / axiom_stream_json_cancellable with
+ * snapshots (checkpoint may be NULL). A snapshot of another market or
+ * strategy is AXIOM_ERR_ARGUMENT. */
+AXIOM_API axiom_result* axiom_run_json_checkpointed(const char* request_json, size_t length,
+                                                    axiom_cancel* cancel,
+                                                    const axiom_checkpoint* checkpoint);
+AXIOM_API int axiom_stream_json_checkpointed(const char* request_json, size_t length,
+                                             axiom_line_fn on_line, void* user,
+                                             axiom_cancel* cancel,
+                                             const axiom_checkpoint* checkpoint);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AXIOM_H */
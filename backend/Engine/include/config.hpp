@@ -3,8 +3,35 @@
 #include <string>
 
 using namespace std;
+
+// Storage type of indicator columns. Accumulation is always double;
+// F32 only narrows what is stored and compared.
+enum class SignalPrecision {
+    F64,
+    F32
+};
+
+// Parameters of the stochastic model markets ("GBM", "GARCH", "Jumps",
+// "Switching"; see StochasticModel.hpp), per bar of the log price. Each
+// model reads its own; the defaults move about like the regimes do.
+struct ModelParams {
+    double mu = 0.0005;         // drift
+    double sigma = 0.002;       // volatility of GBM and Jumps
+    double omega = 1e-7;        // GARCH(1,1): h' = omega + alpha r^2 + beta h
+    double alpha = 0.08;
+    double beta = 0.9;
+    double jump_rate = 0.01;    // Jumps: expected jumps per bar, at most 1
+    double jump_mean = -0.01;   // of a jump's log size
+    double jump_sd = 0.02;
+    double stay = 0.995;        // Switching: chance of keeping the regime for a bar
+};
+
 struct Config{
     string market;
     int timesteps;
     unsigned int seed;
+    SignalPrecision precision = SignalPrecision::F64;
+    string prices_file;     // recorded prices to run on instead of generating (see loadPrices)
+    string prices_column;   // its CSV column, "" = close / price / last
+    ModelParams model;      // of a stochastic model market
 };
@@ -8,12 +8,28 @@ enum class OperandType {
     SIGNAL
 };
 
+// What a portfolio compares instead of the lhs signal itself, taken
+// across the assets of one bar (see Portfolio.hpp)
+enum class CrossSection {
+    NONE,
+    RANK,       // 1 = highest; ties share the better rank
+    ZSCORE      // (value - mean) / std-dev of the bar; 0 if all equal
+};
+
 struct Condition {
     SignalType lhs;
     char op;                 // '<' or '>'
     OperandType rhs_type;
     SignalType rhs_signal;   // valid if rhs_type == SIGNAL
     double rhs_value;        // valid if rhs_type == CONSTANT
+    int timeframe = 1;       // both signals on bars of this many bars (see addTimeframe)
+    CrossSection cross = CrossSection::NONE;    // portfolios only, rhs a constant
+};
+
+// Where the strategy's orders fill
+enum class Execution {
+    CLOSE,      // at the bar price
+    BOOK        // against a limit order book fed synthetic flow (see OrderBook.hpp)
 };
 
 enum class LogicType { AND, OR };
@@ -29,7 +45,15 @@ struct Strategy {
     LogicType sell_logic = LogicType::AND;
     std::vector<Condition> buy;
     std::vector<Condition> sell;
+    // Exits inside the bar, as fractions of the entry price (0 = none):
+    // sell on the first tick at or below entry * (1 - stop_loss), or at
+    // entry * (1 + take_profit) once a tick reaches it
+    double stop_loss = 0.0;
+    double take_profit = 0.0;
+    Execution execution = Execution::CLOSE;
     bool isValid(const MarketSimulator& sim) const;
+    // Add the timeframes the rules read to sim (may throw, see addTimeframe)
+    void addTimeframes(MarketSimulator& sim) const;
 };
 
 struct StrategyState {
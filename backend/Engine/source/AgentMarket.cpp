@@ -0,0 +1,180 @@
+#include "../include/AgentMarket.hpp"
+#include "../include/Barrier.hpp"
+#include "../include/Kernels.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace {
+
+constexpr size_t kMaxAgents = size_t(1) << 26;
+constexpr size_t kChunk = 16384;                    // agents per kernel call
+constexpr size_t kAgentsPerThread = size_t(1) << 18;
+constexpr int kKinds = sizeof(AgentMarket::kHorizons) / sizeof(int);
+
+uint64_t mix(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Uniform in [0, 1): draw k of agent a
+double draw(uint64_t seed, size_t a, int k) {
+    return (mix(seed ^ mix((uint64_t)a * 8 + k)) >> 11) * 0x1.0p-53;
+}
+
+// Standard normal from two uniforms, u in (0, 1]
+double normal(double u, double v) {
+    return std::sqrt(-2.0 * std::log(u)) * std::cos(6.283185307179586 * v);
+}
+
+}
+
+AgentMarket::AgentMarket(const AgentMarketConfig& cfg) : config(cfg) {
+    const size_t n = config.agents;
+    if (n < 1 || n > kMaxAgents)
+        throw std::invalid_argument("agents: 1 to " + std::to_string(kMaxAgents));
+    if (!(config.fundamentalists >= 0.0 && config.chartists >= 0.0 &&
+          config.fundamentalists + config.chartists <= 1.0))
+        throw std::invalid_argument("Agent shares: fundamentalists + chartists within [0, 1]");
+    if (!(config.value > 0.0 && config.impact > 0.0 && config.mood >= 0.0) ||
+        !std::isfinite(config.value + config.impact + config.mood))
+        throw std::invalid_argument("Agent market: value and impact positive, mood 0 or more");
+
+    const size_t nf = (size_t)std::llround(n * config.fundamentalists);
+    const size_t nc = std::min(n - nf, (size_t)std::llround(n * config.chartists));
+    const size_t nn = n - nf - nc;
+    // agents are numbered fundamentalists, chartists, noise traders
+    const uint64_t seed = mix(config.seed ^ 0xA6E7ull);
+
+    value.resize(nf);
+    threshold.resize(nf);
+    fundamental_weight.resize(nf);
+    for (size_t i = 0; i < nf; i++) {
+        double z = normal(1.0 - draw(seed, i, 0), draw(seed, i, 1));
+        value[i] = (float)(config.value * std::exp(0.1 * z));
+        threshold[i] = (float)(0.05 * draw(seed, i, 2));
+        fundamental_weight[i] = (float)(0.5 + draw(seed, i, 3));
+    }
+    sensitivity.resize(nc);
+    chartist_weight.resize(nc);
+    for (size_t i = 0; i < nc; i++) {
+        sensitivity[i] = (float)(1.0 + 9.0 * draw(seed, nf + i, 0));
+        chartist_weight[i] = (float)(0.5 + draw(seed, nf + i, 1));
+    }
+    noise_first = (uint32_t)(nf + nc);
+    noise_weight.resize(nn);
+    for (size_t i = 0; i < nn; i++) noise_weight[i] = (float)(0.5 + draw(seed, nf + nc + i, 0));
+
+    auto split = [&](Chunk::Kind kind, size_t begin, size_t end, int horizon) {
+        for (size_t at = begin; at < end; at += kChunk)
+            chunks.push_back({kind, at, std::min(end, at + kChunk), horizon});
+    };
+    split(Chunk::FUNDAMENTAL, 0, nf, 0);
+    for (int h = 0; h < kKinds; h++) split(Chunk::CHARTIST, nc * h / kKinds, nc * (h + 1) / kKinds, h);
+    split(Chunk::NOISE, 0, nn, 0);
+
+    int hw = (int)std::max(1u, std::thread::hardware_concurrency());
+    workers = config.threads > 0 ? config.threads
+                                 : std::min(hw, (int)std::max<size_t>(1, n / kAgentsPerThread));
+    workers = std::max(1, std::min(workers, (int)chunks.size()));
+}
+
+AgentMarket::Step AgentMarket::inputs(const double* prices, size_t first, size_t t) const {
+    Step s;
+    const double now = prices[t - first];
+    const double log_now = std::log(now);
+    s.inv_price = (float)(1.0 / now);
+    for (int h = 0; h < kKinds; h++) {
+        size_t back = t >= first + kHorizons[h] ? t - kHorizons[h] : first;
+        s.momentum[h] = (float)(log_now - std::log(prices[back - first]));
+    }
+    const uint64_t base = mix(config.seed ^ mix((uint64_t)t * 0x9E3779B97F4A7C15ull));
+    double u = ((mix(base) >> 11) + 1) * 0x1.0p-53;
+    double v = (mix(base + 1) >> 11) * 0x1.0p-53;
+    s.mood = (float)(config.mood * normal(u, v));
+    s.key = (uint32_t)(mix(base + 2) >> 32);
+    return s;
+}
+
+double AgentMarket::chunkDemand(const Chunk& c, const Step& s) const {
+    const KernelTable& k = kernels();
+    const size_t n = c.end - c.begin;
+    alignas(64) float lanes[16] = {};
+    switch (c.kind) {
+        case Chunk::FUNDAMENTAL:
+            k.fundamentalDemand(value.data() + c.begin, threshold.data() + c.begin,
+                                fundamental_weight.data() + c.begin, s.inv_price, n, lanes);
+            break;
+        case Chunk::CHARTIST:
+            k.chartistDemand(sensitivity.data() + c.begin, chartist_weight.data() + c.begin,
+                             s.momentum[c.horizon], n, lanes);
+            break;
+        case Chunk::NOISE:
+            k.noiseDemand(noise_weight.data() + c.begin, s.mood, s.key,
+                          noise_first + (uint32_t)c.begin, n, lanes);
+            break;
+    }
+    double sum = 0.0;
+    for (float l : lanes) sum += l;
+    return sum;
+}
+
+// Workers take chunks w, w + workers, ...; worker 0 (the caller) also
+// adds the chunk sums in order and moves the price between the steps
+void AgentMarket::extend(Series<double>& prices, size_t first, size_t bars) {
+    if (prices.empty()) throw std::invalid_argument("An agent market continues from a price");
+    std::vector<double> partial(chunks.size());
+    Step step;
+    auto work = [&](int w) {
+        for (size_t c = w; c < chunks.size(); c += workers) partial[c] = chunkDemand(chunks[c], step);
+    };
+    auto next = [&] {
+        double demand = 0.0;
+        for (double d : partial) demand += d;
+        double price = std::exp(std::log(prices.back()) + config.impact * demand / config.agents);
+        prices.push_back(price > 0.01 ? price : 0.01);
+    };
+
+    if (workers == 1) {
+        while (first + prices.size() < bars) {
+            step = inputs(prices.data(), first, first + prices.size() - 1);
+            work(0);
+            next();
+        }
+        return;
+    }
+
+    Barrier barrier(workers);
+    std::atomic<bool> finished{false};
+    std::vector<std::thread> pool;
+    for (int w = 1; w < workers; w++)
+        pool.emplace_back([&, w] {
+            for (;;) {
+                barrier.wait();     // step inputs ready
+                if (finished.load(std::memory_order_relaxed)) return;
+                work(w);
+                barrier.wait();     // chunk sums ready
+            }
+        });
+    try {
+        while (first + prices.size() < bars) {
+            step = inputs(prices.data(), first, first + prices.size() - 1);
+            barrier.wait();
+            work(0);
+            barrier.wait();
+            next();
+        }
+    } catch (...) {
+        finished = true;
+        barrier.wait();
+        for (auto& t : pool) t.join();
+        throw;
+    }
+    finished = true;
+    barrier.wait();
+    for (auto& t : pool) t.join();
+}
@@ -0,0 +1,323 @@
+#include "../include/Backtest.hpp"
+#include "../include/Kernels.hpp"
+#include "../include/JsonWriter.hpp"
+#include "../json/json.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+using json = nlohmann::json;
+
+void computeAllSignals(MarketSimulator& sim) {
+    sim.computeRSI(kRsiPeriod);
+    sim.computeVolatility(kVolatilityWindow);
+    sim.computeMovingAverage(kMaShort, kMaLong);
+    sim.computeMovingAverageOnSignal(SignalType::VOLATILITY, SignalType::VOLATILITY_MA,
+                                     kVolatilityMaWindow);
+}
+
+// Fills a run of `bars` bars can record: one per bar, two with stop loss
+// or take profit (an exit inside the bar, then a BUY at its close)
+static size_t fillBound(const Strategy& strategy, size_t bars) {
+    bool exits = strategy.stop_loss > 0.0 || strategy.take_profit > 0.0;
+    return std::min<size_t>(exits ? 2 * bars : bars, 1 << 21);
+}
+
+static void clearBits(std::vector<uint8_t>& mask, size_t from, size_t to) {
+    for (size_t i = from; i < to; i++) mask[i >> 3] &= (uint8_t)~(1u << (i & 7));
+}
+
+// AND a rule on timeframe k into mask, for bars [from, from + n). Bar t
+// reads frame bar frameBar(t, k); the rule is compared once per frame
+// bar and each result covers the k bars that read it. Frame bars before
+// kFirstBar (indicator warm-up) never match.
+static void andFrameRule(const MarketSimulator& sim, const Condition& c, size_t from, int n,
+                         std::vector<uint8_t>& mask, std::vector<uint8_t>& scratch) {
+    const MarketSimulator& frames = *sim.timeframe(c.timeframe);
+    const size_t k = (size_t)c.timeframe;
+    const size_t to = from + n;
+    const long last = frameBar(to - 1, c.timeframe);
+    const long firstBar = std::max<long>(frameBar(from, c.timeframe), kFirstBar);
+    if (last < firstBar) {
+        clearBits(mask, 0, n);
+        return;
+    }
+    // bars before the first frame bar compared here read none
+    const size_t start = ((size_t)firstBar + 1) * k - 1;
+    if (start > from) clearBits(mask, 0, std::min(to, start) - from);
+
+    const int count = (int)(last - firstBar + 1);
+    const size_t at = (size_t)firstBar - frames.origin();
+    const SignalColumn& lhs = frames.getColumn(c.lhs);
+    const SignalColumn* rhs = c.rhs_type == OperandType::SIGNAL ? &frames.getColumn(c.rhs_signal)
+                                                                : nullptr;
+    scratch.assign((count + 7) / 8, 0xFF);
+    if (lhs.isSingle())
+        kernels().compareF32(lhs.f32() + at, rhs ? rhs->f32() + at : nullptr,
+                             (float)c.rhs_value, c.op, scratch.data(), count);
+    else
+        kernels().compareF64(lhs.f64() + at, rhs ? rhs->f64() + at : nullptr,
+                             c.rhs_value, c.op, scratch.data(), count);
+
+    for (int j = 0; j < count; j++) {
+        if ((scratch[j >> 3] >> (j & 7)) & 1) continue;
+        size_t a = ((size_t)firstBar + j + 1) * k - 1;    // first bar reading it
+        clearBits(mask, std::max(a, from) - from, std::min(a + k, to) - from);
+    }
+}
+
+// Evaluate every rule of one side for bars [from, from + n) into a
+// bitmask (bit i = bar from + i). Rules are ANDed; no rules = no signal.
+// Comparisons run in the storage width of the signal columns.
+static void evaluateRules(const MarketSimulator& sim, const std::vector<Condition>& rules,
+                          int from, int n, std::vector<uint8_t>& mask,
+                          std::vector<uint8_t>& scratch) {
+    mask.assign((n + 7) / 8, rules.empty() ? 0x00 : 0xFF);
+    const KernelTable& k = kernels();
+
+    for (const auto& c : rules) {
+        if (c.timeframe != 1) {
+            andFrameRule(sim, c, (size_t)from + sim.origin(), n, mask, scratch);
+            continue;
+        }
+        const SignalColumn& lhs = sim.getColumn(c.lhs);
+        const SignalColumn* rhs = nullptr;
+        if (c.rhs_type == OperandType::SIGNAL)
+            rhs = &sim.getColumn(c.rhs_signal);
+        double value = rhs ? 0.0 : c.rhs_value;
+
+        if (lhs.isSingle())
+            k.compareF32(lhs.f32() + from, rhs ? rhs->f32() + from : nullptr,
+                         (float)value, c.op, mask.data(), n);
+        else
+            k.compareF64(lhs.f64() + from, rhs ? rhs->f64() + from : nullptr,
+                         value, c.op, mask.data(), n);
+    }
+}
+
+static inline bool maskBit(const std::vector<uint8_t>& mask, int i) {
+    return (mask[i >> 3] >> (i & 7)) & 1;
+}
+
+// Bars of order flow before kFirstBar, so the book has depth at the first trade
+constexpr int kBookWarmup = 32;
+
+Backtester::Backtester(const MarketSimulator& sim, const Strategy& strategy)
+    : sim(sim), strategy(strategy) {
+    if (!strategy.isValid(sim))
+        throw std::invalid_argument("Strategy references a signal that is not computed");
+    for (const auto* side : {&strategy.buy, &strategy.sell})
+        for (const Condition& c : *side)
+            if (c.cross != CrossSection::NONE)
+                throw std::invalid_argument("Cross-sectional rules need a portfolio of assets");
+    if (!(strategy.stop_loss >= 0.0 && strategy.stop_loss < 1.0))
+        throw std::invalid_argument("stop_loss: a fraction of the entry price, 0 to below 1");
+    if (!(strategy.take_profit >= 0.0 && std::isfinite(strategy.take_profit)))
+        throw std::invalid_argument("take_profit: a fraction of the entry price, 0 or more");
+
+    if (strategy.execution == Execution::BOOK) {
+        book = std::make_unique<OrderBook>(0);     // the flow centers it on the prices
+        flow = std::make_unique<OrderFlow>(sim.dynamics(), (uint64_t)sim.getConfig().seed);
+        flow_next = std::max<size_t>(sim.origin(), kFirstBar - kBookWarmup);
+    }
+
+    int bars = std::max(0, sim.getConfig().timesteps - kFirstBar);
+    res.trades.reserve(fillBound(strategy, bars));
+    res.equity.reserve(bars);
+}
+
+void Backtester::advance(size_t to) {
+    // Series hold bars from sim.origin(); equity from res.first_bar
+    const auto& prices = sim.getPrices();
+    const int origin = (int)sim.origin();
+    to = std::min(to, sim.bars());
+    if (to <= next) return;
+
+    int from = (int)next;
+    int n = (int)(to - next);
+    res.equity.resize(to - res.first_bar);
+
+    // Evaluate BUY / SELL rules for every bar of the range (AND logic)
+    evaluateRules(sim, strategy.buy, from - origin, n, buy_mask, frame_mask);
+    evaluateRules(sim, strategy.sell, from - origin, n, sell_mask, frame_mask);
+
+    double equity = res.total_pnl;
+
+    const bool exits = strategy.stop_loss > 0.0 || strategy.take_profit > 0.0;
+
+    for (int t = from; t < (int)to; t++) {
+        int i = t - from;
+
+        // the book trades every bar, up to this one
+        for (; book && flow_next <= (size_t)t; flow_next++)
+            flow->bar(*book, flow_next, prices[flow_next - origin]);
+
+        // Stop loss / take profit inside the bar, before its close
+        double fill;
+        if (exits && in_pos && t > entry_t && exitInBar(t, fill)) {
+            in_pos = false;
+            double pnl = fill - entry_price;
+            equity += pnl;
+            res.num_trades++;
+            if (pnl > 0) res.win_count++;
+            res.trades.recordSell(t, fill, pnl, entry_t);
+        }
+
+        // State Machine
+        if (!in_pos && maskBit(buy_mask, i)) {
+            double price = prices[t - origin];
+            if (!book || fillAtBook(Side::BUY, price)) {
+                in_pos = true;
+                entry_price = price;
+                entry_t = t;
+                res.trades.recordBuy(t, entry_price);
+            }
+        }
+        else if (in_pos && maskBit(sell_mask, i)) {
+            double price = prices[t - origin];
+            if (book && !fillAtBook(Side::SELL, price)) {
+                res.equity[t - res.first_bar] = equity;
+                continue;
+            }
+            in_pos = false;
+            double pnl = price - entry_price;
+            equity += pnl;
+            res.num_trades++;
+            if (pnl > 0) res.win_count++;
+            res.trades.recordSell(t, price, pnl, entry_t);
+        }
+
+        res.equity[t - res.first_bar] = equity;
+    }
+
+    // Max drawdown of the realized equity curve, peak carried across calls
+    res.total_pnl = equity;
+    double dd = kernels().maxDrawdown(res.equity.data() + (from - res.first_bar), n, peak);
+    res.max_drawdown = std::max(res.max_drawdown, dd);
+    next = to;
+}
+
+// Bars whose open and close are this many bar volatilities clear of the
+// exit levels are not expanded: a Brownian bridge with ends a and b away
+// from a level crosses it with probability exp(-2ab / sd^2) < 1e-31
+constexpr double kNearBars = 6.0;
+
+bool Backtester::exitInBar(int t, double& fill) const {
+    const double stop = strategy.stop_loss > 0.0 ? entry_price * (1.0 - strategy.stop_loss)
+                                                 : -HUGE_VAL;
+    const double take = strategy.take_profit > 0.0 ? entry_price * (1.0 + strategy.take_profit)
+                                                   : HUGE_VAL;
+    const auto& prices = sim.getPrices();
+    const size_t origin = sim.origin();
+    double open = prices[t - 1 - origin];
+    double close = prices[t - origin];
+    double reach = kNearBars * sim.barVolatility();
+    if (std::min(open, close) - stop > reach && take - std::max(open, close) > reach)
+        return false;
+
+    // the first tick through a level: a stop fills at that tick, a
+    // take-profit limit at its price
+    IntrabarPaths::Path path = sim.ticks(t);
+    for (size_t i = 1; i < path->size(); i++) {
+        double p = (*path)[i];
+        if (p <= stop) {
+            fill = p;
+            return true;
+        }
+        if (p >= take) {
+            fill = take;
+            return true;
+        }
+    }
+    return false;
+}
+
+// The unit at market, after the bar's order flow
+bool Backtester::fillAtBook(Side side, double& fill) {
+    OrderBook::Execution e = book->market(side, 1);
+    if (e.qty == 0) return false;
+    fill = (double)e.notional / (double)e.qty * kBookTick;
+    return true;
+}
+
+// next | open trade | peak | metrics [| order flow | book]; the flow
+// has run up to next
+void Backtester::save(CheckpointWriter& out) const {
+    out.value((uint64_t)next);
+    out.value((uint8_t)in_pos);
+    out.value(entry_price);
+    out.value((int64_t)entry_t);
+    out.value(peak);
+    out.value(res.total_pnl);
+    out.value((int64_t)res.num_trades);
+    out.value((int64_t)res.win_count);
+    out.value(res.max_drawdown);
+    if (book) {
+        flow->save(out);
+        book->save(out);
+    }
+}
+
+void Backtester::restore(CheckpointReader& in) {
+    size_t at = (size_t)in.value<uint64_t>();
+    // a run checkpointed before kFirstBar has not evaluated a bar yet
+    if (at < (size_t)kFirstBar || at < sim.origin() ||
+        at > std::max<size_t>(kFirstBar, sim.bars()))
+        throw std::runtime_error("Corrupt checkpoint");
+    next = at;
+    in_pos = in.value<uint8_t>() != 0;
+    entry_price = in.value<double>();
+    entry_t = (int)in.value<int64_t>();
+    peak = in.value<double>();
+
+    res = BacktestResult();
+    res.first_bar = next;
+    res.total_pnl = in.value<double>();
+    res.num_trades = (int)in.value<int64_t>();
+    res.win_count = (int)in.value<int64_t>();
+    res.max_drawdown = in.value<double>();
+    if (book) {
+        flow_next = next;
+        flow->restore(in);
+        book->restore(in);
+    }
+
+    size_t bars = std::max<size_t>(next, sim.getConfig().timesteps) - next;
+    res.trades.reserve(fillBound(strategy, bars));
+    res.equity.reserve(bars);
+}
+
+BacktestResult runBacktest(const MarketSimulator& sim, const Strategy& strategy) {
+    Backtester bt(sim, strategy);
+    bt.advance(sim.bars());
+    return std::move(bt.result());
+}
+
+void appendMetricsJson(std::string& out, const BacktestResult& r) {
+    json metrics = {
+        {"total_pnl", std::round(r.total_pnl * 100.0) / 100.0},
+        {"num_trades", r.num_trades},
+        {"win_rate", r.num_trades > 0 ? (double)r.win_count / r.num_trades : 0.0},
+        {"max_drawdown", std::round(r.max_drawdown * 100.0) / 100.0}
+    };
+    out += metrics.dump();
+}
+
+void appendResultJson(std::string& out, PriceSpan prices,
+                      const BacktestResult& r, RunStatus status) {
+    appendResultJson(out, prices.data(), prices.size(), r, status);
+}
+
+void appendResultJson(std::string& out, const double* prices, size_t count,
+                      const BacktestResult& r, RunStatus status) {
+    // Large columns are written straight into the buffer, no json DOM
+    out += "{\"metrics\":";
+    appendMetricsJson(out, r);
+    out += ",\"prices\":";      // Frontend App.js expects "prices"
+    appendArray(out, prices, count);
+    out += ",\"status\":\"";
+    out += runStatusName(status);
+    out += "\",\"trades\":";      // Frontend App.js expects "trades"
+    r.trades.appendJson(out);
+    out += '}';
+}
@@ -0,0 +1,799 @@
+#include "../include/HttpServer.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+const std::string* HttpRequest::header(const std::string& name) const {
+    for (const auto& h : headers)
+        if (h.first == name) return &h.second;
+    return nullptr;
+}
+
+#if defined(_WIN32)
+
+struct HttpServer::Impl {};
+struct HttpReply::Channel {};
+
+void HttpReply::send(const HttpResponse&) {}
+bool HttpReply::begin(const HttpResponse&) { return false; }
+bool HttpReply::chunk(const std::string&) { return false; }
+void HttpReply::end() {}
+bool HttpReply::gone() const { return true; }
+
+HttpServer::HttpServer(HttpServerOptions, HttpHandler) : impl(new Impl) {}
+HttpServer::~HttpServer() = default;
+void HttpServer::setInline(std::function<bool(const HttpRequest&)>) {}
+void HttpServer::stop() {}
+
+bool HttpServer::run(std::string& error) {
+    error = "server mode is not supported on Windows";
+    return false;
+}
+
+#else
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <sys/epoll.h>
+#else
+#include <poll.h>
+#endif
+
+// ---------------------------------------------------------
+// 1. POLLER (epoll on Linux, poll elsewhere)
+// ---------------------------------------------------------
+
+namespace {
+
+struct PollEvent {
+    int fd;
+    bool readable;
+    bool writable;
+    bool error;
+};
+
+class Poller {
+public:
+    ~Poller() {
+#if defined(__linux__)
+        if (epfd >= 0) close(epfd);
+#endif
+    }
+
+    bool open() {
+#if defined(__linux__)
+        epfd = epoll_create1(EPOLL_CLOEXEC);
+        return epfd >= 0;
+#else
+        return true;
+#endif
+    }
+
+    // Add or update interest; read = write = false parks the fd
+    void watch(int fd, bool read, bool write) {
+#if defined(__linux__)
+        epoll_event ev{};
+        ev.events = (read ? (uint32_t)EPOLLIN : 0u) | (write ? (uint32_t)EPOLLOUT : 0u);
+        ev.data.fd = fd;
+        if (epoll_ctl(epfd, EPOLL_CTL_MOD, fd, &ev) != 0)
+            epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev);
+#else
+        interest[fd] = (short)((read ? POLLIN : 0) | (write ? POLLOUT : 0));
+#endif
+    }
+
+    void forget(int fd) {
+#if defined(__linux__)
+        epoll_ctl(epfd, EPOLL_CTL_DEL, fd, nullptr);
+#else
+        interest.erase(fd);
+#endif
+    }
+
+    void wait(std::vector<PollEvent>& out, int timeout_ms) {
+        out.clear();
+#if defined(__linux__)
+        epoll_event evs[256];
+        int n = epoll_wait(epfd, evs, 256, timeout_ms);
+        for (int i = 0; i < n; i++) {
+            out.push_back({evs[i].data.fd,
+                           (evs[i].events & EPOLLIN) != 0,
+                           (evs[i].events & EPOLLOUT) != 0,
+                           (evs[i].events & (EPOLLERR | EPOLLHUP)) != 0});
+        }
+#else
+        fds.clear();
+        for (const auto& kv : interest) fds.push_back({kv.first, kv.second, 0});
+        int n = poll(fds.data(), (nfds_t)fds.size(), timeout_ms);
+        for (int i = 0; n > 0 && i < (int)fds.size(); i++) {
+            short r = fds[i].revents;
+            if (!r) continue;
+            out.push_back({fds[i].fd, (r & POLLIN) != 0, (r & POLLOUT) != 0,
+                           (r & (POLLERR | POLLHUP | POLLNVAL)) != 0});
+        }
+#endif
+    }
+
+private:
+#if defined(__linux__)
+    int epfd = -1;
+#else
+    std::unordered_map<int, short> interest;
+    std::vector<pollfd> fds;
+#endif
+};
+
+// ---------------------------------------------------------
+// 2. HTTP/1.1 PARSING + FORMATTING
+// ---------------------------------------------------------
+
+enum class Parse { INCOMPLETE, OK, BAD, TOO_LARGE, NO_LENGTH };
+
+constexpr size_t kMaxHeaderBytes = 16 << 10;
+
+std::string lower(std::string s) {
+    for (char& c : s) c = (char)std::tolower((unsigned char)c);
+    return s;
+}
+
+std::string trim(const std::string& s) {
+    size_t b = s.find_first_not_of(" \t");
+    size_t e = s.find_last_not_of(" \t\r");
+    return b == std::string::npos ? std::string() : s.substr(b, e - b + 1);
+}
+
+// Parse one request from the front of buf. On OK, consumed is its size.
+Parse parseHttp(const std::string& buf, size_t max_body, HttpRequest& req,
+                size_t& consumed, bool& keep_alive) {
+    size_t head_end = buf.find("\r\n\r\n");
+    if (head_end == std::string::npos)
+        return buf.size() > kMaxHeaderBytes ? Parse::TOO_LARGE : Parse::INCOMPLETE;
+
+    size_t line_end = buf.find("\r\n");
+    std::string line = buf.substr(0, line_end);
+    size_t sp1 = line.find(' ');
+    size_t sp2 = line.rfind(' ');
+    if (sp1 == std::string::npos || sp2 == sp1) return Parse::BAD;
+
+    req = HttpRequest();
+    req.method = line.substr(0, sp1);
+    std::string target = line.substr(sp1 + 1, sp2 - sp1 - 1);
+    std::string version = line.substr(sp2 + 1);
+    if (version.compare(0, 5, "HTTP/") != 0) return Parse::BAD;
+
+    size_t q = target.find('?');
+    req.path = target.substr(0, q);
+    if (q != std::string::npos) req.query = target.substr(q + 1);
+
+    size_t pos = line_end + 2;
+    while (pos < head_end) {
+        size_t eol = buf.find("\r\n", pos);
+        std::string h = buf.substr(pos, eol - pos);
+        size_t colon = h.find(':');
+        if (colon == std::string::npos) return Parse::BAD;
+        req.headers.emplace_back(lower(trim(h.substr(0, colon))), trim(h.substr(colon + 1)));
+        pos = eol + 2;
+    }
+
+    const std::string* conn = req.header("connection");
+    std::string conn_l = conn ? lower(*conn) : "";
+    keep_alive = version == "HTTP/1.0" ? conn_l == "keep-alive" : conn_l != "close";
+
+    if (req.header("transfer-encoding")) return Parse::NO_LENGTH;
+
+    size_t length = 0;
+    if (const std::string* cl = req.header("content-length")) {
+        char* end = nullptr;
+        unsigned long long v = std::strtoull(cl->c_str(), &end, 10);
+        if (end == cl->c_str() || *end) return Parse::BAD;
+        if (v > max_body) return Parse::TOO_LARGE;
+        length = (size_t)v;
+    }
+
+    size_t body_start = head_end + 4;
+    if (buf.size() < body_start + length) return Parse::INCOMPLETE;
+
+    req.body = buf.substr(body_start, length);
+    consumed = body_start + length;
+    return Parse::OK;
+}
+
+const char* statusText(int status) {
+    switch (status) {
+        case 200: return "OK";
+        case 202: return "Accepted";
+        case 204: return "No Content";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 409: return "Conflict";
+        case 408: return "Request Timeout";
+        case 411: return "Length Required";
+        case 413: return "Payload Too Large";
+        case 429: return "Too Many Requests";
+        case 431: return "Request Header Fields Too Large";
+        case 500: return "Internal Server Error";
+        case 503: return "Service Unavailable";
+        case 504: return "Gateway Timeout";
+        default:  return "Unknown";
+    }
+}
+
+std::string formatResponse(const HttpResponse& r, bool keep_alive, bool chunked = false) {
+    std::string out;
+    out.reserve(r.body.size() + 256);
+    out += "HTTP/1.1 ";
+    out += std::to_string(r.status);
+    out += ' ';
+    out += statusText(r.status);
+    out += "\r\nAccess-Control-Allow-Origin: *"
+           "\r\nAccess-Control-Allow-Methods: GET, POST, DELETE, OPTIONS"
+           "\r\nAccess-Control-Allow-Headers: Content-Type"
+           "\r\nAccess-Control-Expose-Headers: X-Request-Id"
+           "\r\nContent-Type: ";
+    out += r.content_type;
+    for (const auto& h : r.headers) {
+        out += "\r\n";
+        out += h.first;
+        out += ": ";
+        out += h.second;
+    }
+    if (chunked) {
+        out += "\r\nTransfer-Encoding: chunked";
+    } else {
+        out += "\r\nContent-Length: ";
+        out += std::to_string(r.body.size());
+    }
+    out += keep_alive ? "\r\nConnection: keep-alive\r\n\r\n" : "\r\nConnection: close\r\n\r\n";
+    if (!chunked) out += r.body;
+    return out;
+}
+
+// One chunk of a chunked body; an empty payload is the terminator
+std::string formatChunk(const std::string& payload) {
+    char size[24];
+    snprintf(size, sizeof(size), "%zx\r\n", payload.size());
+    std::string out(size);
+    out += payload;
+    out += "\r\n";
+    return out;
+}
+
+HttpResponse errorResponse(int status) {
+    HttpResponse r;
+    r.status = status;
+    r.body = std::string("{\"error\":\"") + statusText(status) + "\"}";
+    return r;
+}
+
+void setNonBlocking(int fd) {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+}
+
+// Self-pipe used by signal handlers; one server per process
+std::atomic<int> signal_pipe{-1};
+
+extern "C" void onStopSignal(int) {
+    int fd = signal_pipe.load();
+    if (fd >= 0) {
+        char c = 'S';
+        ssize_t n = write(fd, &c, 1);
+        (void)n;
+    }
+}
+
+// Output for a connection; a streamed response arrives in several,
+// the last one frees the connection for its next request
+struct Done {
+    int fd;
+    uint64_t id;
+    bool keep_alive;
+    std::string bytes;
+    bool last;
+};
+
+// Where replies leave their output for the I/O thread. Shared with
+// outstanding replies, which may outlive the server: posts after
+// close() are dropped.
+class Outbox {
+public:
+    explicit Outbox(int wake_fd) : wake_fd(wake_fd) {}
+
+    void post(Done d) {
+        std::lock_guard<std::mutex> lock(mu);
+        if (wake_fd < 0) return;
+        done.push_back(std::move(d));
+        char c = 'C';
+        ssize_t n = write(wake_fd, &c, 1);
+        (void)n;
+    }
+
+    void take(std::vector<Done>& out) {
+        std::lock_guard<std::mutex> lock(mu);
+        out.swap(done);
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(mu);
+        wake_fd = -1;
+        done.clear();
+    }
+
+private:
+    std::mutex mu;
+    std::vector<Done> done;
+    int wake_fd;
+};
+
+} // namespace
+
+// ---------------------------------------------------------
+// 3. REPLIES
+// ---------------------------------------------------------
+
+struct HttpReply::Channel {
+    enum State { NEW, STREAMING, FINISHED };
+
+    std::shared_ptr<Outbox> outbox;
+    int fd;
+    uint64_t id;
+    bool keep_alive;
+    std::shared_ptr<std::atomic<bool>> gone;
+    std::atomic<int> state{NEW};
+
+    Channel(std::shared_ptr<Outbox> outbox, int fd, uint64_t id, bool keep_alive,
+            std::shared_ptr<std::atomic<bool>> gone)
+        : outbox(std::move(outbox)), fd(fd), id(id), keep_alive(keep_alive), gone(std::move(gone)) {}
+
+    ~Channel() {
+        switch (state.load()) {
+            case NEW:
+                post(formatResponse(errorResponse(500), keep_alive), true, keep_alive);
+                break;
+            case STREAMING:
+                // status line is already out; closing without the
+                // terminating chunk tells the client the body is cut short
+                post(std::string(), true, false);
+                break;
+            default:
+                break;
+        }
+    }
+
+    // Move from `from` to `to`; false if some other call got there first
+    bool transition(int from, int to) {
+        return state.compare_exchange_strong(from, to);
+    }
+
+    void post(std::string bytes, bool last, bool keep) {
+        outbox->post({fd, id, keep, std::move(bytes), last});
+    }
+};
+
+void HttpReply::send(const HttpResponse& r) {
+    if (!ch->transition(Channel::NEW, Channel::FINISHED)) return;
+    ch->post(formatResponse(r, ch->keep_alive), true, ch->keep_alive);
+}
+
+bool HttpReply::begin(const HttpResponse& head) {
+    if (!ch->transition(Channel::NEW, Channel::STREAMING)) return false;
+    ch->post(formatResponse(head, ch->keep_alive, true), false, ch->keep_alive);
+    return !gone();
+}
+
+bool HttpReply::chunk(const std::string& data) {
+    if (ch->state.load() != Channel::STREAMING || gone()) return false;
+    if (!data.empty()) ch->post(formatChunk(data), false, ch->keep_alive);
+    return !gone();
+}
+
+void HttpReply::end() {
+    if (!ch->transition(Channel::STREAMING, Channel::FINISHED)) return;
+    ch->post(formatChunk(std::string()), true, ch->keep_alive);
+}
+
+bool HttpReply::gone() const {
+    return ch->gone->load();
+}
+
+// ---------------------------------------------------------
+// 4. SERVER
+// ---------------------------------------------------------
+
+struct HttpServer::Impl {
+    HttpServerOptions opts;
+    HttpHandler handler;
+    std::function<bool(const HttpRequest&)> inline_predicate;
+
+    struct Connection {
+        int fd = -1;
+        uint64_t id = 0;
+        std::string in;
+        std::string out;
+        size_t out_off = 0;
+        bool busy = false;          // request is with a worker
+        bool close_after = false;
+        std::shared_ptr<std::atomic<bool>> gone;   // set on close, read by workers
+        std::chrono::steady_clock::time_point last_active;
+    };
+
+    struct Job {
+        int fd;
+        uint64_t id;
+        bool keep_alive;
+        HttpRequest request;
+        std::shared_ptr<std::atomic<bool>> gone;
+    };
+
+    Poller poller;
+    int listen_fd = -1;
+    int wake[2] = {-1, -1};
+    uint64_t next_id = 1;
+    std::unordered_map<int, Connection> conns;
+
+    // worker pool
+    std::vector<std::thread> workers;
+    std::mutex job_mu;
+    std::condition_variable job_cv;
+    std::deque<Job> jobs;
+    bool shutting_down = false;
+
+    std::shared_ptr<Outbox> outbox;
+
+    void workerLoop() {
+        for (;;) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(job_mu);
+                job_cv.wait(lock, [&] { return shutting_down || !jobs.empty(); });
+                if (shutting_down && jobs.empty()) return;
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+
+            handle(job);
+        }
+    }
+
+    // Hand a request to the handler with a reply bound to its connection;
+    // anything the handler throws before replying becomes a 500
+    void handle(Job& job) {
+        HttpReply reply(std::make_shared<HttpReply::Channel>(outbox, job.fd, job.id,
+                                                             job.keep_alive, job.gone));
+        try {
+            handler(job.request, reply);
+        } catch (...) {
+            reply.send(errorResponse(500));
+        }
+    }
+
+    void closeConnection(int fd) {
+        auto it = conns.find(fd);
+        if (it != conns.end() && it->second.gone) it->second.gone->store(true);
+        poller.forget(fd);
+        close(fd);
+        conns.erase(fd);
+    }
+
+    void acceptAll() {
+        for (;;) {
+            int fd = accept(listen_fd, nullptr, nullptr);
+            if (fd < 0) return;
+            setNonBlocking(fd);
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+#ifdef SO_NOSIGPIPE
+            setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+            Connection& c = conns[fd];
+            c = Connection();
+            c.fd = fd;
+            c.id = next_id++;
+            c.gone = std::make_shared<std::atomic<bool>>(false);
+            c.last_active = std::chrono::steady_clock::now();
+            poller.watch(fd, true, false);
+        }
+    }
+
+    void queueImmediate(Connection& c, const HttpResponse& r, bool keep_alive) {
+        c.out = formatResponse(r, keep_alive);
+        c.out_off = 0;
+        c.close_after = !keep_alive;
+    }
+
+    // Parse the next buffered request and hand it to a worker
+    void dispatch(Connection& c) {
+        if (c.busy || !c.out.empty()) return;
+
+        HttpRequest req;
+        size_t consumed = 0;
+        bool keep_alive = true;
+        Parse p = parseHttp(c.in, opts.max_body, req, consumed, keep_alive);
+
+        switch (p) {
+            case Parse::INCOMPLETE:
+                return;
+            case Parse::BAD:
+                queueImmediate(c, errorResponse(400), false);
+                return;
+            case Parse::TOO_LARGE:
+                queueImmediate(c, errorResponse(413), false);
+                return;
+            case Parse::NO_LENGTH:
+                queueImmediate(c, errorResponse(411), false);
+                return;
+            case Parse::OK:
+                break;
+        }
+        c.in.erase(0, consumed);
+
+        if (req.method == "OPTIONS") {      // CORS preflight
+            HttpResponse r;
+            r.status = 204;
+            r.content_type = "text/plain";
+            queueImmediate(c, r, keep_alive);
+            return;
+        }
+
+        // Until the response is ready, reads only buffer pipelined
+        // requests and notice a hangup, which stops the run
+        c.busy = true;
+
+        if (inline_predicate && inline_predicate(req)) {
+            Job job{c.fd, c.id, keep_alive, std::move(req), c.gone};
+            handle(job);                    // reply arrives through the outbox
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(job_mu);
+            jobs.push_back({c.fd, c.id, keep_alive, std::move(req), c.gone});
+        }
+        job_cv.notify_one();
+    }
+
+    // Write pending output; returns false if the connection was closed
+    bool flush(Connection& c) {
+        while (c.out_off < c.out.size()) {
+            ssize_t n = send(c.fd, c.out.data() + c.out_off, c.out.size() - c.out_off,
+#ifdef MSG_NOSIGNAL
+                             MSG_NOSIGNAL
+#else
+                             0
+#endif
+            );
+            if (n < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    poller.watch(c.fd, false, true);
+                    return true;
+                }
+                closeConnection(c.fd);
+                return false;
+            }
+            c.out_off += (size_t)n;
+        }
+
+        c.out.clear();
+        c.out_off = 0;
+        if (c.close_after) {
+            closeConnection(c.fd);
+            return false;
+        }
+        poller.watch(c.fd, true, false);
+        return true;
+    }
+
+    // Send whatever is ready, then look for a pipelined request
+    void pump(Connection& c) {
+        for (;;) {
+            if (!c.out.empty()) {
+                if (!flush(c)) return;          // closed
+                if (!c.out.empty()) return;     // waiting for EPOLLOUT
+            }
+            if (c.busy) return;
+            dispatch(c);
+            if (c.out.empty()) return;          // incomplete, or with a worker
+        }
+    }
+
+    void readFrom(Connection& c) {
+        char buf[16384];
+        for (;;) {
+            if (c.busy && c.in.size() > opts.max_body + kMaxHeaderBytes) {
+                poller.watch(c.fd, false, false);   // enough queued; park
+                break;
+            }
+            ssize_t n = recv(c.fd, buf, sizeof(buf), 0);
+            if (n > 0) {
+                c.in.append(buf, (size_t)n);
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+            closeConnection(c.fd);     // EOF or error
+            return;
+        }
+        c.last_active = std::chrono::steady_clock::now();
+        pump(c);
+    }
+
+    // Returns false when asked to stop
+    bool drainWake() {
+        bool keep_running = true;
+        char buf[256];
+        ssize_t n;
+        while ((n = read(wake[0], buf, sizeof(buf))) > 0)
+            for (ssize_t i = 0; i < n; i++)
+                if (buf[i] == 'S') keep_running = false;
+
+        std::vector<Done> ready;
+        outbox->take(ready);
+        for (auto& d : ready) {
+            auto it = conns.find(d.fd);
+            if (it == conns.end() || it->second.id != d.id) continue;  // peer left
+            Connection& c = it->second;
+            if (d.last) {
+                c.busy = false;
+                c.close_after = !d.keep_alive;
+            }
+            c.out += d.bytes;
+            if (c.out.empty() && c.close_after) {   // aborted stream
+                closeConnection(c.fd);
+                continue;
+            }
+            c.last_active = std::chrono::steady_clock::now();
+            pump(c);
+        }
+        return keep_running;
+    }
+
+    void closeIdle() {
+        auto now = std::chrono::steady_clock::now();
+        std::vector<int> idle;
+        for (const auto& kv : conns) {
+            const Connection& c = kv.second;
+            if (!c.busy && c.out.empty() &&
+                now - c.last_active > std::chrono::seconds(opts.idle_timeout_s))
+                idle.push_back(kv.first);
+        }
+        for (int fd : idle) closeConnection(fd);
+    }
+
+    bool listenOn(std::string& error) {
+        listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (listen_fd < 0) {
+            error = "socket() failed";
+            return false;
+        }
+        int one = 1;
+        setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons((uint16_t)opts.port);
+        if (inet_pton(AF_INET, opts.host.c_str(), &addr.sin_addr) != 1) {
+            error = "invalid host address";
+            return false;
+        }
+        if (bind(listen_fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+            error = "cannot bind port " + std::to_string(opts.port);
+            return false;
+        }
+        if (listen(listen_fd, 1024) != 0) {
+            error = "listen() failed";
+            return false;
+        }
+        setNonBlocking(listen_fd);
+        return true;
+    }
+
+    bool run(std::string& error) {
+        if (!poller.open() || pipe(wake) != 0) {
+            error = "cannot create event loop";
+            return false;
+        }
+        setNonBlocking(wake[0]);
+        setNonBlocking(wake[1]);
+        outbox = std::make_shared<Outbox>(wake[1]);
+        if (!listenOn(error)) return false;
+
+        signal(SIGPIPE, SIG_IGN);
+        signal_pipe.store(wake[1]);
+        signal(SIGINT, onStopSignal);
+        signal(SIGTERM, onStopSignal);
+
+        int n = opts.workers > 0 ? opts.workers
+                                 : (int)std::max(1u, std::thread::hardware_concurrency());
+        for (int i = 0; i < n; i++) workers.emplace_back([this] { workerLoop(); });
+
+        poller.watch(listen_fd, true, false);
+        poller.watch(wake[0], true, false);
+
+        std::vector<PollEvent> events;
+        bool running = true;
+        while (running) {
+            poller.wait(events, 1000);
+            for (const PollEvent& ev : events) {
+                if (ev.fd == listen_fd) {
+                    acceptAll();
+                } else if (ev.fd == wake[0]) {
+                    running = drainWake() && running;
+                } else {
+                    auto it = conns.find(ev.fd);
+                    if (it == conns.end()) continue;
+                    Connection& c = it->second;
+                    if (ev.error && !ev.readable) closeConnection(ev.fd);
+                    else if (ev.writable) pump(c);
+                    else if (ev.readable) readFrom(c);
+                }
+            }
+            closeIdle();
+        }
+
+        shutdown();
+        return true;
+    }
+
+    void shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(job_mu);
+            shutting_down = true;
+        }
+        job_cv.notify_all();
+        for (auto& t : workers) t.join();
+        workers.clear();
+
+        std::vector<int> fds;
+        for (const auto& kv : conns) fds.push_back(kv.first);
+        for (int fd : fds) closeConnection(fd);
+
+        outbox->close();        // replies still out there post into the void
+        signal_pipe.store(-1);
+        if (listen_fd >= 0) close(listen_fd);
+        close(wake[0]);
+        close(wake[1]);
+        listen_fd = wake[0] = wake[1] = -1;
+    }
+};
+
+HttpServer::HttpServer(HttpServerOptions opts, HttpHandler handler) : impl(new Impl) {
+    impl->opts = std::move(opts);
+    impl->handler = std::move(handler);
+}
+
+HttpServer::~HttpServer() = default;
+
+void HttpServer::setInline(std::function<bool(const HttpRequest&)> predicate) {
+    impl->inline_predicate = std::move(predicate);
+}
+
+bool HttpServer::run(std::string& error) {
+    return impl->run(error);
+}
+
+void HttpServer::stop() {
+    if (impl->wake[1] >= 0) {
+        char c = 'S';
+        ssize_t n = write(impl->wake[1], &c, 1);
+        (void)n;
+    }
+}
+
+#endif
@@ -0,0 +1,82 @@
+#include "../include/Intrabar.hpp"
+#include <cmath>
+#include <random>
+
+namespace {
+
+// Small counter-seeded generator: one per path, nothing to warm up
+struct SplitMix64 {
+    using result_type = uint64_t;
+    uint64_t state;
+
+    static constexpr uint64_t min() { return 0; }
+    static constexpr uint64_t max() { return UINT64_MAX; }
+    uint64_t operator()() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+};
+
+// Bridge from `open` to `close` in kTicksPerBar steps: each tick moves
+// toward the close by its share of the remaining distance, plus noise
+// scaled to the variance the bridge has left
+Series<double> bridge(uint64_t seed, size_t t, double open, double close, double sd) {
+    SplitMix64 mix{seed ^ (t * 0xD1B54A32D192ED03ull)};
+    SplitMix64 rng{mix()};
+    std::normal_distribution<double> noise(0.0, 1.0);
+
+    const int n = kTicksPerBar;
+    const double tick_sd = sd / std::sqrt((double)n);
+    Series<double> path(n + 1);
+    path[0] = open;
+    double x = open;
+    for (int i = 1; i < n; i++) {
+        double left = n - i + 1;
+        x += (close - x) / left + tick_sd * std::sqrt((left - 1) / left) * noise(rng);
+        if (x <= 0.0) x = 0.01;
+        path[i] = x;
+    }
+    path[n] = close;
+    return path;
+}
+
+} // namespace
+
+IntrabarPaths::Path IntrabarPaths::get(size_t t, double open, double close, double sd) {
+    {
+        std::lock_guard<std::mutex> lock(mu);
+        auto it = index.find(t);
+        if (it != index.end()) {
+            hits++;
+            lru.splice(lru.begin(), lru, it->second);
+            return it->second->path;
+        }
+        misses++;
+    }
+
+    // generated outside the lock; a racing thread makes the same path
+    Path path = std::make_shared<const Series<double>>(bridge(seed, t, open, close, sd));
+
+    std::lock_guard<std::mutex> lock(mu);
+    if (index.count(t)) return path;
+    while (!lru.empty() && lru.size() >= capacity) {
+        index.erase(lru.back().bar);
+        lru.pop_back();
+    }
+    if (capacity == 0) return path;
+    lru.push_front({t, path});
+    index.emplace(t, lru.begin());
+    return path;
+}
+
+IntrabarPaths::Stats IntrabarPaths::stats() const {
+    std::lock_guard<std::mutex> lock(mu);
+    Stats s;
+    s.entries = lru.size();
+    s.capacity = capacity;
+    s.hits = hits;
+    s.misses = misses;
+    return s;
+}
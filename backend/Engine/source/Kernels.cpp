@@ -0,0 +1,1669 @@
+#include "../include/Kernels.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define AXIOM_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+// ---------------------------------------------------------
+// 1. SCALAR (reference, every platform)
+// ---------------------------------------------------------
+
+static void rollingMeanScalar(const double* in, double* out,
+                              size_t from, size_t to, int w) {
+    for (size_t t = from; t < to; t++) {
+        double s = 0.0;
+        for (size_t i = t + 1 - w; i <= t; i++) s += in[i];
+        out[t - from] = s / w;
+    }
+}
+
+static void rollingStdScalar(const double* r, double* out,
+                             size_t from, size_t to, int w) {
+    for (size_t t = from; t < to; t++) {
+        double mean = 0.0;
+        for (size_t i = t + 1 - w; i <= t; i++) mean += r[i];
+        mean /= w;
+
+        double sq_sum = 0.0;
+        for (size_t i = t + 1 - w; i <= t; i++)
+            sq_sum += (r[i] - mean) * (r[i] - mean);
+
+        out[t - from] = std::sqrt(sq_sum / w);
+    }
+}
+
+template <typename T>
+static inline bool compareOne(T l, T r, char op) {
+    if (op == '>') return l > r;
+    if (op == '<') return l < r;
+    if (op == '=') return std::abs(l - r) < T(0.0001);
+    return false;
+}
+
+template <typename T>
+static void compareTail(const T* lhs, const T* rhs, T c, char op,
+                        uint8_t* mask, size_t from, size_t n) {
+    for (size_t i = from; i < n; i++) {
+        T r = rhs ? rhs[i] : c;
+        if (!compareOne(lhs[i], r, op))
+            mask[i >> 3] &= (uint8_t)~(1u << (i & 7));
+    }
+}
+
+static void compareF64Scalar(const double* lhs, const double* rhs, double c,
+                             char op, uint8_t* mask, size_t n) {
+    compareTail(lhs, rhs, c, op, mask, 0, n);
+}
+
+static void compareF32Scalar(const float* lhs, const float* rhs, float c,
+                             char op, uint8_t* mask, size_t n) {
+    compareTail(lhs, rhs, c, op, mask, 0, n);
+}
+
+static double maxDrawdownScalar(const double* e, size_t n, double& peak) {
+    double p = peak, dd = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        p = std::max(p, e[i]);
+        dd = std::max(dd, p - e[i]);
+    }
+    peak = p;
+    return dd;
+}
+
+// Agent demand: one agent's decision, shared by the scalar kernels and
+// the tails of the vector ones
+
+static inline float clampUnit(float x) {
+    x = x < -1.0f ? -1.0f : x;
+    return x > 1.0f ? 1.0f : x;
+}
+
+static inline uint32_t agentHash(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7FEB352Du;
+    x ^= x >> 15;
+    x *= 0x846CA68Bu;
+    return x ^ (x >> 16);
+}
+
+static inline float fundamentalOne(float value, float threshold, float weight, float inv_price) {
+    float x = value * inv_price - 1.0f;
+    return std::fabs(x) > threshold ? weight * x : 0.0f;
+}
+
+static inline float chartistOne(float sensitivity, float weight, float momentum) {
+    return weight * clampUnit(sensitivity * momentum);
+}
+
+static inline float noiseOne(float weight, float sentiment, uint32_t key, uint32_t agent) {
+    float u = (float)(int32_t)agentHash(agent * 0x9E3779B9u ^ key) * 0x1.0p-31f;
+    return weight * clampUnit(sentiment + u);
+}
+
+static void fundamentalDemandScalar(const float* value, const float* threshold,
+                                    const float* weight, float inv_price, size_t n,
+                                    float* lanes) {
+    for (size_t i = 0; i < n; i++)
+        lanes[i & 15] += fundamentalOne(value[i], threshold[i], weight[i], inv_price);
+}
+
+static void chartistDemandScalar(const float* sensitivity, const float* weight,
+                                 float momentum, size_t n, float* lanes) {
+    for (size_t i = 0; i < n; i++)
+        lanes[i & 15] += chartistOne(sensitivity[i], weight[i], momentum);
+}
+
+static void noiseDemandScalar(const float* weight, float sentiment, uint32_t key,
+                              uint32_t first, size_t n, float* lanes) {
+    for (size_t i = 0; i < n; i++)
+        lanes[i & 15] += noiseOne(weight[i], sentiment, key, first + (uint32_t)i);
+}
+
+// Stochastic models: the math of a path's bar is written once over the
+// lane type (double here, a vector of doubles in section 2), so every
+// variant runs the same operations on each path. It uses only + - * /,
+// compares and bit operations: libm's log and exp are not the same on
+// every platform, let alone vectorized.
+
+#if defined(__GNUC__)
+#define AXIOM_INLINE inline __attribute__((always_inline))
+#else
+#define AXIOM_INLINE inline
+#endif
+
+constexpr double kLn2Hi = 0x1.62e42feep-1;     // ln 2 in two parts: k * hi is exact
+constexpr double kLn2Lo = 0x1.a39ef35793c76p-33;
+
+template <typename U>
+AXIOM_INLINE void mixLanes(U& z) {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    z = z ^ (z >> 31);
+}
+
+// Counter of draw k of bar b, the same for every path
+static inline uint64_t drawCounter(uint64_t bar, int k) {
+    uint64_t c = bar * 4 + (uint64_t)k;
+    mixLanes(c);
+    return c;
+}
+
+// Uniform in (0, 1), 53 bits, from the paths' keys and a draw's counter
+template <typename F, typename U>
+AXIOM_INLINE void uniformDraw(const U& key, uint64_t counter, F& u) {
+    U h = key ^ counter;
+    mixLanes(h);
+    h = (h >> 12) | 0x3FF0000000000000ull;     // [1, 2)
+    std::memcpy(&u, &h, sizeof(F));
+    u = (u - 1.0) + 0x1.0p-53;
+}
+
+// log x for x in (0, 1]: x = m 2^e with m in [sqrt(1/2), sqrt(2)), and
+// log m = 2 atanh(s), s = (m - 1) / (m + 1), by its series to s^23
+template <typename F, typename U>
+AXIOM_INLINE void logIn(F& x) {
+    U b, eb;
+    F e, m;
+    std::memcpy(&b, &x, sizeof(F));
+    eb = (b >> 52) | 0x4330000000000000ull;    // 2^52 + biased exponent
+    std::memcpy(&e, &eb, sizeof(F));
+    e = e - (0x1.0p52 + 1023.0);
+    b = (b & 0x000FFFFFFFFFFFFFull) | 0x3FF0000000000000ull;
+    std::memcpy(&m, &b, sizeof(F));
+    auto big = m > 1.4142135623730951;
+    m = big ? m * 0.5 : m;
+    e = big ? e + 1.0 : e;
+
+    F s = (m - 1.0) / (m + 1.0);
+    F z = s * s;
+    F r = z * (1.0 / 23) + 1.0 / 21;
+    r = r * z + 1.0 / 19;
+    r = r * z + 1.0 / 17;
+    r = r * z + 1.0 / 15;
+    r = r * z + 1.0 / 13;
+    r = r * z + 1.0 / 11;
+    r = r * z + 1.0 / 9;
+    r = r * z + 1.0 / 7;
+    r = r * z + 1.0 / 5;
+    r = r * z + 1.0 / 3;
+    F s2 = s * 2.0;
+    F lm = s2 + s2 * (z * r);
+    x = e * kLn2Hi + (lm + e * kLn2Lo);
+}
+
+// e^x, x clamped to [-708, 709]: x = k ln 2 + r with |r| <= ln 2 / 2,
+// e^r by its series to r^13 and 2^k written into the exponent
+template <typename F, typename U>
+AXIOM_INLINE void expIn(F& x) {
+    x = x < -708.0 ? x - x - 708.0 : x;
+    x = x > 709.0 ? x - x + 709.0 : x;
+    F k = x * 1.4426950408889634 + 0x1.8p52;   // rounded, k in the low bits
+    U kb;
+    std::memcpy(&kb, &k, sizeof(F));
+    k = k - 0x1.8p52;
+    F r = (x - k * kLn2Hi) - k * kLn2Lo;
+
+    F p = r * (1.0 / 6227020800.0) + 1.0 / 479001600.0;
+    p = p * r + 1.0 / 39916800.0;
+    p = p * r + 1.0 / 3628800.0;
+    p = p * r + 1.0 / 362880.0;
+    p = p * r + 1.0 / 40320.0;
+    p = p * r + 1.0 / 5040.0;
+    p = p * r + 1.0 / 720.0;
+    p = p * r + 1.0 / 120.0;
+    p = p * r + 1.0 / 24.0;
+    p = p * r + 1.0 / 6.0;
+    p = p * r + 0.5;
+    p = p * r + 1.0;
+    p = p * r + 1.0;
+
+    F scale;
+    kb = (kb + 1023) << 52;
+    std::memcpy(&scale, &kb, sizeof(F));
+    x = p * scale;
+}
+
+// sqrt x for x >= 0: Newton steps on 1 / sqrt(x) from the bit-trick
+// estimate (3.5% off, then 1.8e-3, 4.6e-6, 3e-11, exact); 0 gives 0
+template <typename F, typename U>
+AXIOM_INLINE void sqrtIn(F& x) {
+    U b;
+    F y;
+    std::memcpy(&b, &x, sizeof(F));
+    b = 0x5FE6EB50C7B537A9ull - (b >> 1);
+    std::memcpy(&y, &b, sizeof(F));
+    F h = x * 0.5;
+    for (int i = 0; i < 4; i++) y = y * (1.5 - h * y * y);
+    x = x * y;
+}
+
+// Standard normal quantile by Acklam's rational approximations
+// (relative error < 1.2e-9), in two parts: the central one for p with
+// |p - 1/2| <= kTailFrom, and the tails, in sqrt(-2 log p)
+constexpr double kTailFrom = 0.47575;
+
+template <typename F>
+AXIOM_INLINE void normalCentral(F& p) {
+    F q = p - 0.5;
+    F r = q * q;
+    F num = r * -3.969683028665376e+01 + 2.209460984245205e+02;
+    num = num * r - 2.759285104469687e+02;
+    num = num * r + 1.383577518672690e+02;
+    num = num * r - 3.066479806614716e+01;
+    num = num * r + 2.506628277459239e+00;
+    F den = r * -5.447609879822406e+01 + 1.615858368580409e+02;
+    den = den * r - 1.556989798598866e+02;
+    den = den * r + 6.680131188771972e+01;
+    den = den * r - 1.328068155288572e+01;
+    den = den * r + 1.0;
+    p = num * q / den;
+}
+
+template <typename F, typename U>
+AXIOM_INLINE void normalTail(F& p) {
+    auto upper = p > 0.5;
+    F t = upper ? 1.0 - p : p;
+    logIn<F, U>(t);
+    t = t * -2.0;
+    sqrtIn<F, U>(t);
+    F num = t * -7.784894002430293e-03 - 3.223964580411365e-01;
+    num = num * t - 2.400758277161838e+00;
+    num = num * t - 2.549732539343734e+00;
+    num = num * t + 4.374664141464968e+00;
+    num = num * t + 2.938163982698783e+00;
+    F den = t * 7.784695709041462e-03 + 3.224671290700398e-01;
+    den = den * t + 2.445134137142996e+00;
+    den = den * t + 3.754408661907416e+00;
+    den = den * t + 1.0;
+    F x = num / den;
+    p = upper ? -x : x;
+}
+
+// Model paths advance kModelChunk bars at a time: first every draw of
+// the chunk, then the recursion over them. Draws are stored lane by
+// lane, bar i of lane j at i * W + j, W = sizeof(F) / 8.
+constexpr size_t kModelChunk = 32;
+
+template <typename F, typename U>
+AXIOM_INLINE void drawUniforms(const U& key, uint64_t bar, int d, size_t m, double* u) {
+    for (size_t i = 0; i < m; i++) {
+        F x;
+        uniformDraw(key, drawCounter(bar + i, d), x);
+        std::memcpy(u + i * (sizeof(F) / sizeof(double)), &x, sizeof(F));
+    }
+}
+
+// Normals of draw d of bars bar .. bar + m - 1. The 1 in 20 draws in
+// the tails are packed into full vectors after the central pass, so a
+// tail costs a lane instead of a vector.
+template <typename F, typename U>
+AXIOM_INLINE void drawNormals(const U& key, uint64_t bar, int d, size_t m, double* z) {
+    constexpr size_t W = sizeof(F) / sizeof(double);
+    double u[kModelChunk * W];
+    drawUniforms<F, U>(key, bar, d, m, u);
+    for (size_t i = 0; i < m; i++) {
+        F x;
+        std::memcpy(&x, u + i * W, sizeof(F));
+        normalCentral(x);
+        std::memcpy(z + i * W, &x, sizeof(F));
+    }
+
+    uint32_t tail[kModelChunk * W];
+    size_t tails = 0;
+    for (size_t j = 0; j < m * W; j++)
+        if (u[j] > 0.5 + kTailFrom || u[j] < 0.5 - kTailFrom) tail[tails++] = (uint32_t)j;
+    for (size_t j = 0; j < tails; j += W) {
+        double lanes[W];
+        for (size_t l = 0; l < W; l++) lanes[l] = u[tail[j + l < tails ? j + l : j]];
+        F x;
+        std::memcpy(&x, lanes, sizeof(F));
+        normalTail<F, U>(x);
+        std::memcpy(lanes, &x, sizeof(F));
+        for (size_t l = 0; l < W && j + l < tails; l++) z[tail[j + l]] = lanes[l];
+    }
+}
+
+// The multiplicative models keep their prices within [kModelFloor,
+// kModelCeiling], as the regime walks keep theirs above 0.01: a drift
+// compounds past the range of a double within the bars a run may have.
+// A price that overflowed is caught too (inf < ceiling is false).
+constexpr double kModelFloor = 0.01;
+constexpr double kModelCeiling = 1e12;
+
+template <typename F>
+AXIOM_INLINE void clampPrice(F& s) {
+    const F zero = F{};
+    s = s < kModelCeiling ? s : zero + kModelCeiling;
+    s = s > kModelFloor ? s : zero + kModelFloor;
+}
+
+// One path block per model: F holds the prices of W consecutive paths
+
+struct GbmPath {
+    template <typename F, typename U>
+    static AXIOM_INLINE void block(const ModelCoefficients& c, const uint64_t* key, double* price,
+                                   double*, size_t p, uint64_t t, size_t steps, double* out,
+                                   size_t stride) {
+        constexpr size_t W = sizeof(F) / sizeof(double);
+        double z[kModelChunk * W];
+        U k;
+        F s;
+        std::memcpy(&k, key + p, sizeof(U));
+        std::memcpy(&s, price + p, sizeof(F));
+        for (size_t i0 = 0; i0 < steps; i0 += kModelChunk) {
+            size_t m = std::min(kModelChunk, steps - i0);
+            drawNormals<F, U>(k, t + 1 + i0, 0, m, z);
+            for (size_t i = 0; i < m; i++) {
+                F g;
+                std::memcpy(&g, z + i * W, sizeof(F));
+                g = g * c.sigma + c.drift;
+                expIn<F, U>(g);
+                s = s * g;
+                clampPrice(s);
+                std::memcpy(out + (i0 + i) * stride + p, &s, sizeof(F));
+            }
+        }
+        std::memcpy(price + p, &s, sizeof(F));
+    }
+};
+
+// state: the variance of the next bar's return
+struct GarchPath {
+    template <typename F, typename U>
+    static AXIOM_INLINE void block(const ModelCoefficients& c, const uint64_t* key, double* price,
+                                   double* state, size_t p, uint64_t t, size_t steps,
+                                   double* out, size_t stride) {
+        constexpr size_t W = sizeof(F) / sizeof(double);
+        double z[kModelChunk * W];
+        U k;
+        F s, h;
+        std::memcpy(&k, key + p, sizeof(U));
+        std::memcpy(&s, price + p, sizeof(F));
+        std::memcpy(&h, state + p, sizeof(F));
+        for (size_t i0 = 0; i0 < steps; i0 += kModelChunk) {
+            size_t m = std::min(kModelChunk, steps - i0);
+            drawNormals<F, U>(k, t + 1 + i0, 0, m, z);
+            for (size_t i = 0; i < m; i++) {
+                F r, sd = h;
+                std::memcpy(&r, z + i * W, sizeof(F));
+                sqrtIn<F, U>(sd);
+                r = sd * r;
+                F g = (c.drift - h * 0.5) + r;
+                F next = (r * r) * c.alpha + c.omega;
+                h = next + h * c.beta;
+                expIn<F, U>(g);
+                s = s * g;
+                clampPrice(s);
+                std::memcpy(out + (i0 + i) * stride + p, &s, sizeof(F));
+            }
+        }
+        std::memcpy(price + p, &s, sizeof(F));
+        std::memcpy(state + p, &h, sizeof(F));
+    }
+};
+
+struct JumpPath {
+    template <typename F, typename U>
+    static AXIOM_INLINE void block(const ModelCoefficients& c, const uint64_t* key, double* price,
+                                   double*, size_t p, uint64_t t, size_t steps, double* out,
+                                   size_t stride) {
+        constexpr size_t W = sizeof(F) / sizeof(double);
+        double z[kModelChunk * W], u[kModelChunk * W], zj[kModelChunk * W];
+        U k;
+        F s;
+        std::memcpy(&k, key + p, sizeof(U));
+        std::memcpy(&s, price + p, sizeof(F));
+        for (size_t i0 = 0; i0 < steps; i0 += kModelChunk) {
+            size_t m = std::min(kModelChunk, steps - i0);
+            drawNormals<F, U>(k, t + 1 + i0, 0, m, z);
+            drawUniforms<F, U>(k, t + 1 + i0, 1, m, u);
+            drawNormals<F, U>(k, t + 1 + i0, 2, m, zj);
+            for (size_t i = 0; i < m; i++) {
+                F g, jumps, size, n;
+                std::memcpy(&g, z + i * W, sizeof(F));
+                std::memcpy(&jumps, u + i * W, sizeof(F));
+                std::memcpy(&size, zj + i * W, sizeof(F));
+                n = jumps - jumps;
+                for (int j = 0; j < kMaxJumps; j++) n = jumps > c.jump_cdf[j] ? n + 1.0 : n;
+                F sn = n;
+                sqrtIn<F, U>(sn);
+                g = g * c.sigma + c.drift;
+                g = g + n * c.jump_mean;
+                g = g + (sn * size) * c.jump_sd;
+                expIn<F, U>(g);
+                s = s * g;
+                clampPrice(s);
+                std::memcpy(out + (i0 + i) * stride + p, &s, sizeof(F));
+            }
+        }
+        std::memcpy(price + p, &s, sizeof(F));
+    }
+};
+
+// state: the regime, 0 / 1 / 2
+struct SwitchingPath {
+    template <typename F>
+    static AXIOM_INLINE void pick(const F& regime, const double* v, F& out) {
+        F zero = regime - regime;
+        out = regime < 0.5 ? zero + v[0] : (regime < 1.5 ? zero + v[1] : zero + v[2]);
+    }
+
+    template <typename F, typename U>
+    static AXIOM_INLINE void block(const ModelCoefficients& c, const uint64_t* key, double* price,
+                                   double* state, size_t p, uint64_t t, size_t steps,
+                                   double* out, size_t stride) {
+        constexpr size_t W = sizeof(F) / sizeof(double);
+        double u[kModelChunk * W], z[kModelChunk * W];
+        U k;
+        F s, regime;
+        std::memcpy(&k, key + p, sizeof(U));
+        std::memcpy(&s, price + p, sizeof(F));
+        std::memcpy(&regime, state + p, sizeof(F));
+        for (size_t i0 = 0; i0 < steps; i0 += kModelChunk) {
+            size_t m = std::min(kModelChunk, steps - i0);
+            drawUniforms<F, U>(k, t + 1 + i0, 0, m, u);
+            drawNormals<F, U>(k, t + 1 + i0, 1, m, z);
+            for (size_t i = 0; i < m; i++) {
+                F move, noise_z;
+                std::memcpy(&move, u + i * W, sizeof(F));
+                std::memcpy(&noise_z, z + i * W, sizeof(F));
+                regime = move >= c.switch_at[0] ? regime + 1.0 : regime;
+                regime = move >= c.switch_at[1] ? regime + 1.0 : regime;
+                regime = regime > 2.5 ? regime - 3.0 : regime;
+
+                F drift, reversion, mean, noise;
+                pick(regime, c.regime_drift, drift);
+                pick(regime, c.regime_reversion, reversion);
+                pick(regime, c.regime_mean, mean);
+                pick(regime, c.regime_noise, noise);
+                F next = s + drift;
+                next = next + reversion * (mean - s);
+                next = next + noise * noise_z;
+                s = next > 0.0 ? next : next - next + 0.01;
+                std::memcpy(out + (i0 + i) * stride + p, &s, sizeof(F));
+            }
+        }
+        std::memcpy(price + p, &s, sizeof(F));
+        std::memcpy(state + p, &regime, sizeof(F));
+    }
+};
+
+// Whole blocks of sizeof(F) / 8 paths, then the rest one by one
+template <typename M, typename F, typename U>
+AXIOM_INLINE void modelPaths(const ModelCoefficients& c, const uint64_t* key, double* price,
+                             double* state, size_t n, uint64_t t, size_t steps, double* out,
+                             size_t stride) {
+    constexpr size_t W = sizeof(F) / sizeof(double);
+    size_t p = 0;
+    for (; p + W <= n; p += W)
+        M::template block<F, U>(c, key, price, state, p, t, steps, out, stride);
+    for (; p < n; p++)
+        M::template block<double, uint64_t>(c, key, price, state, p, t, steps, out, stride);
+}
+
+static void gbmPathsScalar(const ModelCoefficients& c, const uint64_t* key, double* price,
+                           double* state, size_t n, uint64_t t, size_t steps, double* out,
+                           size_t stride) {
+    modelPaths<GbmPath, double, uint64_t>(c, key, price, state, n, t, steps, out, stride);
+}
+static void garchPathsScalar(const ModelCoefficients& c, const uint64_t* key, double* price,
+                             double* state, size_t n, uint64_t t, size_t steps, double* out,
+                             size_t stride) {
+    modelPaths<GarchPath, double, uint64_t>(c, key, price, state, n, t, steps, out, stride);
+}
+static void jumpPathsScalar(const ModelCoefficients& c, const uint64_t* key, double* price,
+                            double* state, size_t n, uint64_t t, size_t steps, double* out,
+                            size_t stride) {
+    modelPaths<JumpPath, double, uint64_t>(c, key, price, state, n, t, steps, out, stride);
+}
+static void switchingPathsScalar(const ModelCoefficients& c, const uint64_t* key, double* price,
+                                 double* state, size_t n, uint64_t t, size_t steps, double* out,
+                                 size_t stride) {
+    modelPaths<SwitchingPath, double, uint64_t>(c, key, price, state, n, t, steps, out, stride);
+}
+
+// Lane blocks (kPathLanes interleaved paths). The scalar window kernels
+// run each path's loop as rollingMean / rollingStd do; the RSI and the
+// backtest are written over the lane type like the models, for lanes
+// [first, first + W) of the block.
+
+static void laneMeanScalar(const double* in, double* out, size_t from, size_t to, int w) {
+    constexpr size_t L = kPathLanes;
+    for (size_t t = from; t < to; t++)
+        for (size_t l = 0; l < L; l++) {
+            double s = 0.0;
+            for (size_t i = t + 1 - w; i <= t; i++) s += in[i * L + l];
+            out[(t - from) * L + l] = s / w;
+        }
+}
+
+static void laneStdScalar(const double* r, double* out, size_t from, size_t to, int w) {
+    constexpr size_t L = kPathLanes;
+    for (size_t t = from; t < to; t++)
+        for (size_t l = 0; l < L; l++) {
+            double mean = 0.0;
+            for (size_t i = t + 1 - w; i <= t; i++) mean += r[i * L + l];
+            mean /= w;
+
+            double sq_sum = 0.0;
+            for (size_t i = t + 1 - w; i <= t; i++)
+                sq_sum += (r[i * L + l] - mean) * (r[i * L + l] - mean);
+
+            out[(t - from) * L + l] = std::sqrt(sq_sum / w);
+        }
+}
+
+template <typename F>
+AXIOM_INLINE void rsiLanes(const double* prices, double* out, double* gain, double* loss,
+                           size_t from, size_t to, int w, size_t first) {
+    constexpr size_t L = kPathLanes;
+    const F zero = F{};
+    F g, lo;
+    std::memcpy(&g, gain + first, sizeof(F));
+    std::memcpy(&lo, loss + first, sizeof(F));
+    for (size_t t = from; t < to; t++) {
+        F now, before;
+        std::memcpy(&now, prices + t * L + first, sizeof(F));
+        std::memcpy(&before, prices + (t - 1) * L + first, sizeof(F));
+        F diff = now - before;
+        F up = diff > 0.0 ? diff : zero;
+        F down = diff < 0.0 ? -diff : zero;
+
+        g = (g * (double)(w - 1) + up) / (double)w;
+        lo = (lo * (double)(w - 1) + down) / (double)w;
+
+        F rs = lo == 0.0 ? zero : g / lo;
+        F rsi = 100.0 - (100.0 / (1.0 + rs));
+        std::memcpy(out + (t - from) * L + first, &rsi, sizeof(F));
+    }
+    std::memcpy(gain + first, &g, sizeof(F));
+    std::memcpy(loss + first, &lo, sizeof(F));
+}
+
+// Lanes of a mask byte as 0.0 / 1.0, lane l = bit l
+struct LaneBitTable {
+    double lanes[256][kPathLanes];
+    constexpr LaneBitTable() : lanes() {
+        for (int b = 0; b < 256; b++)
+            for (size_t l = 0; l < kPathLanes; l++) lanes[b][l] = (b >> l) & 1 ? 1.0 : 0.0;
+    }
+};
+static constexpr LaneBitTable kLaneBits;
+
+// Backtester::advance without stops or the book: enter on a buy while
+// flat, else exit on a sell while open; then the drawdown of the equity.
+// Prices are interleaved by lane (S = kPathLanes) or one a bar for every
+// lane (S = 0).
+template <typename F, size_t S>
+AXIOM_INLINE void backtestLanes(const double* prices, const uint8_t* buy, const uint8_t* sell,
+                                size_t n, LaneBook& book, size_t first) {
+    const F zero = F{};
+    const F one = zero + 1.0;
+    F open, entry, equity, trades, wins, peak, drawdown;
+    std::memcpy(&open, book.open + first, sizeof(F));
+    std::memcpy(&entry, book.entry + first, sizeof(F));
+    std::memcpy(&equity, book.equity + first, sizeof(F));
+    std::memcpy(&trades, book.trades + first, sizeof(F));
+    std::memcpy(&wins, book.wins + first, sizeof(F));
+    std::memcpy(&peak, book.peak + first, sizeof(F));
+    std::memcpy(&drawdown, book.drawdown + first, sizeof(F));
+    for (size_t i = 0; i < n; i++) {
+        F price, b, s;
+        if constexpr (S == 0)
+            price = prices[i] - zero;       // x - 0 is x, -0 included
+        else
+            std::memcpy(&price, prices + i * S + first, sizeof(F));
+        std::memcpy(&b, kLaneBits.lanes[buy[i]] + first, sizeof(F));
+        std::memcpy(&s, kLaneBits.lanes[sell[i]] + first, sizeof(F));
+        F enter = open < 0.5 ? b : zero;
+        F exit = open > 0.5 ? s : zero;
+
+        F pnl = price - entry;
+        F won = pnl > 0.0 ? exit : zero;
+        equity = exit > 0.5 ? equity + pnl : equity;
+        trades = trades + exit;
+        wins = wins + won;
+        entry = enter > 0.5 ? price : entry;
+        open = open < 0.5 ? b : one - s;        // (open + enter) - exit, off exit's chain
+
+        peak = peak < equity ? equity : peak;
+        F down = peak - equity;
+        drawdown = drawdown < down ? down : drawdown;
+    }
+    std::memcpy(book.open + first, &open, sizeof(F));
+    std::memcpy(book.entry + first, &entry, sizeof(F));
+    std::memcpy(book.equity + first, &equity, sizeof(F));
+    std::memcpy(book.trades + first, &trades, sizeof(F));
+    std::memcpy(book.wins + first, &wins, sizeof(F));
+    std::memcpy(book.peak + first, &peak, sizeof(F));
+    std::memcpy(book.drawdown + first, &drawdown, sizeof(F));
+}
+
+static void laneRsiScalar(const double* prices, double* out, double* gain, double* loss,
+                          size_t from, size_t to, int w) {
+    for (size_t l = 0; l < kPathLanes; l++)
+        rsiLanes<double>(prices, out, gain, loss, from, to, w, l);
+}
+
+static void laneBacktestScalar(const double* prices, const uint8_t* buy, const uint8_t* sell,
+                               size_t n, LaneBook& book) {
+    for (size_t l = 0; l < kPathLanes; l++)
+        backtestLanes<double, kPathLanes>(prices, buy, sell, n, book, l);
+}
+
+// Strategy variants: bit l of a bar's byte = variant l's threshold
+template <typename T>
+static void thresholdLanes(const T* signal, const T* threshold, char op, uint8_t* mask,
+                           size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        unsigned bits = 0;
+        for (size_t l = 0; l < kPathLanes; l++)
+            bits |= (unsigned)compareOne(signal[i], threshold[l], op) << l;
+        mask[i] &= (uint8_t)bits;
+    }
+}
+
+static void thresholdF64Scalar(const double* signal, const double* threshold, char op,
+                               uint8_t* mask, size_t n) {
+    thresholdLanes(signal, threshold, op, mask, n);
+}
+
+static void thresholdF32Scalar(const float* signal, const float* threshold, char op,
+                               uint8_t* mask, size_t n) {
+    thresholdLanes(signal, threshold, op, mask, n);
+}
+
+static void variantBacktestScalar(const double* prices, const uint8_t* buy, const uint8_t* sell,
+                                  size_t n, LaneBook& book) {
+    for (size_t l = 0; l < kPathLanes; l++)
+        backtestLanes<double, 0>(prices, buy, sell, n, book, l);
+}
+
+static const KernelTable kScalar = {
+    Isa::SCALAR,
+    rollingMeanScalar,
+    rollingStdScalar,
+    compareF64Scalar,
+    compareF32Scalar,
+    maxDrawdownScalar,
+    fundamentalDemandScalar,
+    chartistDemandScalar,
+    noiseDemandScalar,
+    gbmPathsScalar,
+    garchPathsScalar,
+    jumpPathsScalar,
+    switchingPathsScalar,
+    laneMeanScalar,
+    laneStdScalar,
+    laneRsiScalar,
+    laneBacktestScalar,
+    thresholdF64Scalar,
+    thresholdF32Scalar,
+    variantBacktestScalar
+};
+
+#ifdef AXIOM_X86_KERNELS
+
+// ---------------------------------------------------------
+// 2. WINDOW KERNELS (generic vectors, one build per ISA)
+// ---------------------------------------------------------
+// Written once with GCC/Clang vector extensions and inlined into
+// target-specific wrappers, so the same source compiles to SSE2, AVX2 or
+// AVX-512 registers. Outputs are processed in L1-sized tiles; for each
+// lag the tile is updated with one vector add, which keeps the summation
+// order of the scalar loop (and therefore its exact result).
+
+#if defined(__clang__)
+// Clang only contracts within one expression, and the bodies below never
+// put a multiply and an add in the same expression.
+#define AXIOM_NO_CONTRACT
+#else
+#define AXIOM_NO_CONTRACT , optimize("fp-contract=off")
+#endif
+
+#define AXIOM_SSE2   __attribute__((target("sse2") AXIOM_NO_CONTRACT))
+#define AXIOM_AVX2   __attribute__((target("avx2") AXIOM_NO_CONTRACT))
+#define AXIOM_AVX512 __attribute__((target("avx512f,avx512bw") AXIOM_NO_CONTRACT))
+
+namespace {
+
+constexpr size_t kTile = 256;
+
+template <int N>
+struct Lanes {
+    typedef double type __attribute__((vector_size(sizeof(double) * N)));
+    typedef uint64_t bits __attribute__((vector_size(sizeof(double) * N)));
+};
+
+// acc[k] += src[k] for k < n
+template <int N>
+AXIOM_INLINE void addInto(double* acc, const double* src, size_t n) {
+    using V = typename Lanes<N>::type;
+    size_t k = 0;
+    for (; k + N <= n; k += N) {
+        V a, b;
+        std::memcpy(&a, acc + k, sizeof(V));
+        std::memcpy(&b, src + k, sizeof(V));
+        a += b;
+        std::memcpy(acc + k, &a, sizeof(V));
+    }
+    for (; k < n; k++) acc[k] += src[k];
+}
+
+// acc[k] += (src[k] - m[k])^2 for k < n
+template <int N>
+AXIOM_INLINE void addSquaredDev(double* acc, const double* src,
+                                const double* m, size_t n) {
+    using V = typename Lanes<N>::type;
+    size_t k = 0;
+    for (; k + N <= n; k += N) {
+        V a, x, mu;
+        std::memcpy(&a, acc + k, sizeof(V));
+        std::memcpy(&x, src + k, sizeof(V));
+        std::memcpy(&mu, m + k, sizeof(V));
+        V d = x - mu;
+        V sq = d * d;
+        a += sq;
+        std::memcpy(acc + k, &a, sizeof(V));
+    }
+    for (; k < n; k++) {
+        double d = src[k] - m[k];
+        double sq = d * d;
+        acc[k] += sq;
+    }
+}
+
+// acc[k] = 0 + src[0][k] + src[1][k] + ... + src[w-1][k]
+template <int N>
+AXIOM_INLINE void windowSum(double* acc, const double* base, size_t n, int w) {
+    std::fill(acc, acc + n, 0.0);
+    for (int j = 0; j < w; j++) addInto<N>(acc, base + j, n);
+}
+
+template <int N>
+AXIOM_INLINE void rollingMeanBody(const double* in, double* out,
+                                  size_t from, size_t to, int w) {
+    alignas(64) double acc[kTile];
+    for (size_t t0 = from; t0 < to; t0 += kTile) {
+        size_t n = std::min(kTile, to - t0);
+        windowSum<N>(acc, in + t0 + 1 - w, n, w);
+        double* o = out + (t0 - from);
+        for (size_t k = 0; k < n; k++) o[k] = acc[k] / w;
+    }
+}
+
+template <int N>
+AXIOM_INLINE void rollingStdBody(const double* r, double* out,
+                                 size_t from, size_t to, int w) {
+    alignas(64) double mean[kTile];
+    alignas(64) double sq[kTile];
+    for (size_t t0 = from; t0 < to; t0 += kTile) {
+        size_t n = std::min(kTile, to - t0);
+        const double* base = r + t0 + 1 - w;
+
+        windowSum<N>(mean, base, n, w);
+        for (size_t k = 0; k < n; k++) mean[k] /= w;
+
+        std::fill(sq, sq + n, 0.0);
+        for (int j = 0; j < w; j++) addSquaredDev<N>(sq, base + j, mean, n);
+
+        double* o = out + (t0 - from);
+        for (size_t k = 0; k < n; k++) o[k] = std::sqrt(sq[k] / w);
+    }
+}
+
+// Lane blocks: N bars of the block at a time, their 8 vectors of sums
+// held in registers over the window. A window's rows are whole bars, so
+// each sum adds the rows in the order of the scalar loops. The bars past
+// the last group run as in the scalar kernels.
+template <int N>
+AXIOM_INLINE void laneMeanBody(const double* in, double* out, size_t from, size_t to, int w) {
+    using V = typename Lanes<N>::type;
+    constexpr size_t L = kPathLanes, R = 8, G = R * N / L;
+    size_t t = from;
+    for (; t + G <= to; t += G) {
+        V acc[R] = {};
+        const double* base = in + (t + 1 - w) * L;
+        for (int j = 0; j < w; j++)
+#pragma GCC unroll 8
+            for (size_t r = 0; r < R; r++) {
+                V x;
+                std::memcpy(&x, base + j * L + r * N, sizeof(V));
+                acc[r] += x;
+            }
+        for (size_t r = 0; r < R; r++) {
+            acc[r] = acc[r] / (double)w;
+            std::memcpy(out + (t - from) * L + r * N, &acc[r], sizeof(V));
+        }
+    }
+    if (t < to) laneMeanScalar(in, out + (t - from) * L, t, to, w);
+}
+
+template <int N>
+AXIOM_INLINE void laneStdBody(const double* r, double* out, size_t from, size_t to, int w) {
+    using V = typename Lanes<N>::type;
+    constexpr size_t L = kPathLanes, R = 8, G = R * N / L;
+    size_t t = from;
+    for (; t + G <= to; t += G) {
+        V mean[R] = {}, sq[R] = {};
+        const double* base = r + (t + 1 - w) * L;
+        for (int j = 0; j < w; j++)
+#pragma GCC unroll 8
+            for (size_t k = 0; k < R; k++) {
+                V x;
+                std::memcpy(&x, base + j * L + k * N, sizeof(V));
+                mean[k] += x;
+            }
+        for (size_t k = 0; k < R; k++) mean[k] = mean[k] / (double)w;
+        for (int j = 0; j < w; j++)
+#pragma GCC unroll 8
+            for (size_t k = 0; k < R; k++) {
+                V x;
+                std::memcpy(&x, base + j * L + k * N, sizeof(V));
+                V d = x - mean[k];
+                sq[k] += d * d;
+            }
+        double* o = out + (t - from) * L;
+        for (size_t k = 0; k < R; k++) {
+            sq[k] = sq[k] / (double)w;
+            std::memcpy(o + k * N, &sq[k], sizeof(V));
+        }
+        for (size_t k = 0; k < G * L; k++) o[k] = std::sqrt(o[k]);
+    }
+    if (t < to) laneStdScalar(r, out + (t - from) * L, t, to, w);
+}
+
+// Agent demand: 16 lanes held in 16 / N registers; agent i of a step
+// of 16 goes to register i / N, lane i % N, as in the scalar kernels
+
+template <int N>
+struct FloatLanes {
+    typedef float type __attribute__((vector_size(sizeof(float) * N)));
+    typedef int32_t ints __attribute__((vector_size(sizeof(float) * N)));
+    typedef uint32_t bits __attribute__((vector_size(sizeof(float) * N)));
+};
+
+// In place: vector arguments and returns would change the ABI per target
+template <typename F>
+AXIOM_INLINE void clampUnit(F& x) {
+    const F lo = F{} - 1.0f, hi = F{} + 1.0f;
+    x = x < lo ? lo : x;
+    x = x > hi ? hi : x;
+}
+
+template <int N>
+AXIOM_INLINE void fundamentalDemandBody(const float* value, const float* threshold,
+                                        const float* weight, float inv_price, size_t n,
+                                        float* lanes) {
+    using F = typename FloatLanes<N>::type;
+    using I = typename FloatLanes<N>::ints;
+    F acc[16 / N];
+    std::memcpy(acc, lanes, sizeof(acc));
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+        for (int r = 0; r < 16 / N; r++) {
+            size_t at = i + r * N;
+            F x, th, w;
+            std::memcpy(&x, value + at, sizeof(F));
+            std::memcpy(&th, threshold + at, sizeof(F));
+            std::memcpy(&w, weight + at, sizeof(F));
+            x = x * inv_price - 1.0f;
+            F d = w * x;
+            F ax = (F)((I)x & 0x7FFFFFFF);
+            acc[r] += ax > th ? d : F{};
+        }
+    std::memcpy(lanes, acc, sizeof(acc));
+    for (; i < n; i++)
+        lanes[i & 15] += fundamentalOne(value[i], threshold[i], weight[i], inv_price);
+}
+
+template <int N>
+AXIOM_INLINE void chartistDemandBody(const float* sensitivity, const float* weight,
+                                     float momentum, size_t n, float* lanes) {
+    using F = typename FloatLanes<N>::type;
+    F acc[16 / N];
+    std::memcpy(acc, lanes, sizeof(acc));
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+        for (int r = 0; r < 16 / N; r++) {
+            size_t at = i + r * N;
+            F x, w;
+            std::memcpy(&x, sensitivity + at, sizeof(F));
+            std::memcpy(&w, weight + at, sizeof(F));
+            x *= momentum;
+            clampUnit(x);
+            acc[r] += w * x;
+        }
+    std::memcpy(lanes, acc, sizeof(acc));
+    for (; i < n; i++) lanes[i & 15] += chartistOne(sensitivity[i], weight[i], momentum);
+}
+
+template <int N>
+AXIOM_INLINE void noiseDemandBody(const float* weight, float sentiment, uint32_t key,
+                                  uint32_t first, size_t n, float* lanes) {
+    using F = typename FloatLanes<N>::type;
+    using I = typename FloatLanes<N>::ints;
+    using U = typename FloatLanes<N>::bits;
+    U lane;
+    for (int k = 0; k < N; k++) lane[k] = (uint32_t)k;
+    F acc[16 / N];
+    std::memcpy(acc, lanes, sizeof(acc));
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+        for (int r = 0; r < 16 / N; r++) {
+            size_t at = i + r * N;
+            U h = (lane + (first + (uint32_t)at)) * 0x9E3779B9u ^ key;
+            h ^= h >> 16;
+            h *= 0x7FEB352Du;
+            h ^= h >> 15;
+            h *= 0x846CA68Bu;
+            h ^= h >> 16;
+            F x = __builtin_convertvector((I)h, F) * 0x1.0p-31f + sentiment, w;
+            clampUnit(x);
+            std::memcpy(&w, weight + at, sizeof(F));
+            acc[r] += w * x;
+        }
+    std::memcpy(lanes, acc, sizeof(acc));
+    for (; i < n; i++)
+        lanes[i & 15] += noiseOne(weight[i], sentiment, key, first + (uint32_t)i);
+}
+
+// ---------------------------------------------------------
+// 3. COMPARE + DRAWDOWN (intrinsics per ISA)
+// ---------------------------------------------------------
+
+// '=' is |l - r| < 1e-4, same as the scalar rule
+
+AXIOM_SSE2 inline __m128d cmpPd(__m128d l, __m128d r, char op) {
+    if (op == '<') return _mm_cmplt_pd(l, r);
+    if (op == '>') return _mm_cmpgt_pd(l, r);
+    __m128d d = _mm_andnot_pd(_mm_set1_pd(-0.0), _mm_sub_pd(l, r));
+    return _mm_cmplt_pd(d, _mm_set1_pd(0.0001));
+}
+
+AXIOM_SSE2 inline __m128 cmpPs(__m128 l, __m128 r, char op) {
+    if (op == '<') return _mm_cmplt_ps(l, r);
+    if (op == '>') return _mm_cmpgt_ps(l, r);
+    __m128 d = _mm_andnot_ps(_mm_set1_ps(-0.0f), _mm_sub_ps(l, r));
+    return _mm_cmplt_ps(d, _mm_set1_ps(0.0001f));
+}
+
+AXIOM_AVX2 inline __m256d cmpPd(__m256d l, __m256d r, char op) {
+    if (op == '<') return _mm256_cmp_pd(l, r, _CMP_LT_OQ);
+    if (op == '>') return _mm256_cmp_pd(l, r, _CMP_GT_OQ);
+    __m256d d = _mm256_andnot_pd(_mm256_set1_pd(-0.0), _mm256_sub_pd(l, r));
+    return _mm256_cmp_pd(d, _mm256_set1_pd(0.0001), _CMP_LT_OQ);
+}
+
+AXIOM_AVX2 inline __m256 cmpPs(__m256 l, __m256 r, char op) {
+    if (op == '<') return _mm256_cmp_ps(l, r, _CMP_LT_OQ);
+    if (op == '>') return _mm256_cmp_ps(l, r, _CMP_GT_OQ);
+    __m256 d = _mm256_andnot_ps(_mm256_set1_ps(-0.0f), _mm256_sub_ps(l, r));
+    return _mm256_cmp_ps(d, _mm256_set1_ps(0.0001f), _CMP_LT_OQ);
+}
+
+AXIOM_AVX512 inline __mmask8 cmpPd(__m512d l, __m512d r, char op) {
+    if (op == '<') return _mm512_cmp_pd_mask(l, r, _CMP_LT_OQ);
+    if (op == '>') return _mm512_cmp_pd_mask(l, r, _CMP_GT_OQ);
+    __m512d d = _mm512_abs_pd(_mm512_sub_pd(l, r));
+    return _mm512_cmp_pd_mask(d, _mm512_set1_pd(0.0001), _CMP_LT_OQ);
+}
+
+AXIOM_AVX512 inline __mmask16 cmpPs(__m512 l, __m512 r, char op) {
+    if (op == '<') return _mm512_cmp_ps_mask(l, r, _CMP_LT_OQ);
+    if (op == '>') return _mm512_cmp_ps_mask(l, r, _CMP_GT_OQ);
+    __m512 d = _mm512_abs_ps(_mm512_sub_ps(l, r));
+    return _mm512_cmp_ps_mask(d, _mm512_set1_ps(0.0001f), _CMP_LT_OQ);
+}
+
+// Each loop step produces 8 lanes = one mask byte.
+// AVX variants clear the upper register state before their scalar tail:
+// GCC does not always emit vzeroupper for target() functions, and dirty
+// upper halves slow down every SSE instruction that runs afterwards.
+
+AXIOM_SSE2 void compareF64Sse2(const double* lhs, const double* rhs, double c,
+                               char op, uint8_t* mask, size_t n) {
+    if (op != '<' && op != '>' && op != '=') { std::memset(mask, 0, (n + 7) / 8); return; }
+    const __m128d cv = _mm_set1_pd(c);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        unsigned bits = 0;
+        for (int k = 0; k < 8; k += 2) {
+            __m128d r = rhs ? _mm_loadu_pd(rhs + i + k) : cv;
+            bits |= (unsigned)_mm_movemask_pd(cmpPd(_mm_loadu_pd(lhs + i + k), r, op)) << k;
+        }
+        mask[i >> 3] &= (uint8_t)bits;
+    }
+    compareTail(lhs, rhs, c, op, mask, i, n);
+}
+
+AXIOM_SSE2 void compareF32Sse2(const float* lhs, const float* rhs, float c,
+                               char op, uint8_t* mask, size_t n) {
+    if (op != '<' && op != '>' && op != '=') { std::memset(mask, 0, (n + 7) / 8); return; }
+    const __m128 cv = _mm_set1_ps(c);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        unsigned bits = 0;
+        for (int k = 0; k < 8; k += 4) {
+            __m128 r = rhs ? _mm_loadu_ps(rhs + i + k) : cv;
+            bits |= (unsigned)_mm_movemask_ps(cmpPs(_mm_loadu_ps(lhs + i + k), r, op)) << k;
+        }
+        mask[i >> 3] &= (uint8_t)bits;
+    }
+    compareTail(lhs, rhs, c, op, mask, i, n);
+}
+
+AXIOM_AVX2 void compareF64Avx2(const double* lhs, const double* rhs, double c,
+                               char op, uint8_t* mask, size_t n) {
+    if (op != '<' && op != '>' && op != '=') { std::memset(mask, 0, (n + 7) / 8); return; }
+    const __m256d cv = _mm256_set1_pd(c);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256d r0 = rhs ? _mm256_loadu_pd(rhs + i) : cv;
+        __m256d r1 = rhs ? _mm256_loadu_pd(rhs + i + 4) : cv;
+        unsigned lo = (unsigned)_mm256_movemask_pd(cmpPd(_mm256_loadu_pd(lhs + i), r0, op));
+        unsigned hi = (unsigned)_mm256_movemask_pd(cmpPd(_mm256_loadu_pd(lhs + i + 4), r1, op));
+        mask[i >> 3] &= (uint8_t)(lo | (hi << 4));
+    }
+    _mm256_zeroupper();
+    compareTail(lhs, rhs, c, op, mask, i, n);
+}
+
+AXIOM_AVX2 void compareF32Avx2(const float* lhs, const float* rhs, float c,
+                               char op, uint8_t* mask, size_t n) {
+    if (op != '<' && op != '>' && op != '=') { std::memset(mask, 0, (n + 7) / 8); return; }
+    const __m256 cv = _mm256_set1_ps(c);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 r = rhs ? _mm256_loadu_ps(rhs + i) : cv;
+        mask[i >> 3] &= (uint8_t)_mm256_movemask_ps(cmpPs(_mm256_loadu_ps(lhs + i), r, op));
+    }
+    _mm256_zeroupper();
+    compareTail(lhs, rhs, c, op, mask, i, n);
+}
+
+AXIOM_AVX512 void compareF64Avx512(const double* lhs, const double* rhs, double c,
+                                   char op, uint8_t* mask, size_t n) {
+    if (op != '<' && op != '>' && op != '=') { std::memset(mask, 0, (n + 7) / 8); return; }
+    const __m512d cv = _mm512_set1_pd(c);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512d r = rhs ? _mm512_loadu_pd(rhs + i) : cv;
+        mask[i >> 3] &= (uint8_t)cmpPd(_mm512_loadu_pd(lhs + i), r, op);
+    }
+    _mm256_zeroupper();
+    compareTail(lhs, rhs, c, op, mask, i, n);
+}
+
+AXIOM_AVX512 void compareF32Avx512(const float* lhs, const float* rhs, float c,
+                                   char op, uint8_t* mask, size_t n) {
+    if (op != '<' && op != '>' && op != '=') { std::memset(mask, 0, (n + 7) / 8); return; }
+    const __m512 cv = _mm512_set1_ps(c);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512 r = rhs ? _mm512_loadu_ps(rhs + i) : cv;
+        unsigned bits = cmpPs(_mm512_loadu_ps(lhs + i), r, op);
+        mask[i >> 3] &= (uint8_t)bits;
+        mask[(i >> 3) + 1] &= (uint8_t)(bits >> 8);
+    }
+    _mm256_zeroupper();
+    compareTail(lhs, rhs, c, op, mask, i, n);
+}
+
+// Strategy variants: the kPathLanes thresholds stay in registers and
+// each bar's signal value is broadcast against them. AVX-512 compares
+// two float32 bars, 16 lanes, per instruction.
+
+AXIOM_SSE2 void thresholdF64Sse2(const double* signal, const double* threshold, char op,
+                                 uint8_t* mask, size_t n) {
+    if (op != '<' && op != '>' && op != '=') { std::memset(mask, 0, n); return; }
+    __m128d t[4];
+    for (int k = 0; k < 4; k++) t[k] = _mm_loadu_pd(threshold + 2 * k);
+    for (size_t i = 0; i < n; i++) {
+        const __m128d v = _mm_set1_pd(signal[i]);
+        unsigned bits = 0;
+        for (int k = 0; k < 4; k++)
+            bits |= (unsigned)_mm_movemask_pd(cmpPd(v, t[k], op)) << (2 * k);
+        mask[i] &= (uint8_t)bits;
+    }
+}
+
+AXIOM_SSE2 void thresholdF32Sse2(const float* signal, const float* threshold, char op,
+                                 uint8_t* mask, size_t n) {
+    if (op != '<' && op != '>' && op != '=') { std::memset(mask, 0, n); return; }
+    const __m128 t0 = _mm_loadu_ps(threshold), t1 = _mm_loadu_ps(threshold + 4);
+    for (size_t i = 0; i < n; i++) {
+        const __m128 v = _mm_set1_ps(signal[i]);
+        unsigned lo = (unsigned)_mm_movemask_ps(cmpPs(v, t0, op));
+        unsigned hi = (unsigned)_mm_movemask_ps(cmpPs(v, t1, op));
+        mask[i] &= (uint8_t)(lo | (hi << 4));
+    }
+}
+
+AXIOM_AVX2 void thresholdF64Avx2(const double* signal, const double* threshold, char op,
+                                 uint8_t* mask, size_t n) {
+    if (op != '<' && op != '>' && op != '=') { std::memset(mask, 0, n); return; }
+    const __m256d t0 = _mm256_loadu_pd(threshold), t1 = _mm256_loadu_pd(threshold + 4);
+    for (size_t i = 0; i < n; i++) {
+        const __m256d v = _mm256_set1_pd(signal[i]);
+        unsigned lo = (unsigned)_mm256_movemask_pd(cmpPd(v, t0, op));
+        unsigned hi = (unsigned)_mm256_movemask_pd(cmpPd(v, t1, op));
+        mask[i] &= (uint8_t)(lo | (hi << 4));
+    }
+    _mm256_zeroupper();
+}
+
+AXIOM_AVX2 void thresholdF32Avx2(const float* signal, const float* threshold, char op,
+                                 uint8_t* mask, size_t n) {
+    if (op != '<' && op != '>' && op != '=') { std::memset(mask, 0, n); return; }
+    const __m256 t = _mm256_loadu_ps(threshold);
+    for (size_t i = 0; i < n; i++)
+        mask[i] &= (uint8_t)_mm256_movemask_ps(cmpPs(_mm256_set1_ps(signal[i]), t, op));
+    _mm256_zeroupper();
+}
+
+AXIOM_AVX512 void thresholdF64Avx512(const double* signal, const double* threshold, char op,
+                                     uint8_t* mask, size_t n) {
+    if (op != '<' && op != '>' && op != '=') { std::memset(mask, 0, n); return; }
+    const __m512d t = _mm512_loadu_pd(threshold);
+    for (size_t i = 0; i < n; i++)
+        mask[i] &= (uint8_t)cmpPd(_mm512_set1_pd(signal[i]), t, op);
+    _mm256_zeroupper();
+}
+
+#if !defined(__clang__)
+// as in maxDrawdownAvx512: the broadcast and permute intrinsics pass
+// GCC 12 an _mm512_undefined_ps()
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+AXIOM_AVX512 void thresholdF32Avx512(const float* signal, const float* threshold, char op,
+                                     uint8_t* mask, size_t n) {
+    if (op != '<' && op != '>' && op != '=') { std::memset(mask, 0, n); return; }
+    // lanes 0-7: bar i, lanes 8-15: bar i + 1, each against the 8 thresholds
+    const __m512 t = _mm512_castpd_ps(
+        _mm512_broadcast_f64x4(_mm256_castps_pd(_mm256_loadu_ps(threshold))));
+    const __m512i pair = _mm512_set_epi32(1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        double two;
+        std::memcpy(&two, signal + i, sizeof(two));
+        __m512 v = _mm512_permutexvar_ps(pair, _mm512_castpd_ps(_mm512_set1_pd(two)));
+        unsigned bits = cmpPs(v, t, op);
+        mask[i] &= (uint8_t)bits;
+        mask[i + 1] &= (uint8_t)(bits >> 8);
+    }
+    _mm256_zeroupper();
+    thresholdLanes(signal + i, threshold, op, mask + i, n - i);
+}
+
+#if !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+// Drawdown: in-register prefix max (log2(lanes) shift+max steps), then
+// combine with the peak carried from the previous vector.
+
+AXIOM_SSE2 double maxDrawdownSse2(const double* e, size_t n, double& peak) {
+    const __m128d ninf = _mm_set1_pd(-HUGE_VAL);
+    __m128d carry = _mm_set1_pd(peak);
+    __m128d dd = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128d x = _mm_loadu_pd(e + i);
+        __m128d m = _mm_max_pd(x, _mm_unpacklo_pd(ninf, x));   // [x0, max(x0,x1)]
+        m = _mm_max_pd(m, carry);
+        dd = _mm_max_pd(dd, _mm_sub_pd(m, x));
+        carry = _mm_unpackhi_pd(m, m);
+    }
+    alignas(16) double lanes[2];
+    _mm_store_pd(lanes, dd);
+    double p = _mm_cvtsd_f64(carry);
+    double best = std::max(lanes[0], lanes[1]);
+    best = std::max(best, maxDrawdownScalar(e + i, n - i, p));
+    peak = p;
+    return best;
+}
+
+AXIOM_AVX2 double maxDrawdownAvx2(const double* e, size_t n, double& peak) {
+    const __m256d ninf = _mm256_set1_pd(-HUGE_VAL);
+    __m256d carry = _mm256_set1_pd(peak);
+    __m256d dd = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d x = _mm256_loadu_pd(e + i);
+        // shift up one lane: [-inf, x0, x1, x2]
+        __m256d s1 = _mm256_blend_pd(_mm256_permute4x64_pd(x, 0x90), ninf, 0x1);
+        __m256d m = _mm256_max_pd(x, s1);
+        // shift up two lanes: [-inf, -inf, m0, m1]
+        __m256d s2 = _mm256_blend_pd(_mm256_permute4x64_pd(m, 0x40), ninf, 0x3);
+        m = _mm256_max_pd(m, s2);
+        m = _mm256_max_pd(m, carry);
+        dd = _mm256_max_pd(dd, _mm256_sub_pd(m, x));
+        carry = _mm256_permute4x64_pd(m, 0xFF);
+    }
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, dd);
+    double p = _mm256_cvtsd_f64(carry);
+    double best = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+    _mm256_zeroupper();
+    best = std::max(best, maxDrawdownScalar(e + i, n - i, p));
+    peak = p;
+    return best;
+}
+
+#if !defined(__clang__)
+// GCC 12 flags _mm512_undefined_pd() inside the max intrinsic
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+AXIOM_AVX512 double maxDrawdownAvx512(const double* e, size_t n, double& peak) {
+    const __m512d ninf = _mm512_set1_pd(-HUGE_VAL);
+    const __m512i sh1 = _mm512_set_epi64(6, 5, 4, 3, 2, 1, 0, 0);
+    const __m512i sh2 = _mm512_set_epi64(5, 4, 3, 2, 1, 0, 0, 0);
+    const __m512i sh4 = _mm512_set_epi64(3, 2, 1, 0, 0, 0, 0, 0);
+    const __m512i top = _mm512_set1_epi64(7);
+    __m512d carry = _mm512_set1_pd(peak);
+    __m512d dd = _mm512_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512d x = _mm512_loadu_pd(e + i);
+        __m512d m = _mm512_max_pd(x, _mm512_mask_permutexvar_pd(ninf, 0xFE, sh1, x));
+        m = _mm512_max_pd(m, _mm512_mask_permutexvar_pd(ninf, 0xFC, sh2, m));
+        m = _mm512_max_pd(m, _mm512_mask_permutexvar_pd(ninf, 0xF0, sh4, m));
+        m = _mm512_max_pd(m, carry);
+        dd = _mm512_max_pd(dd, _mm512_sub_pd(m, x));
+        carry = _mm512_permutexvar_pd(top, m);
+    }
+    double p = _mm512_cvtsd_f64(carry);
+    alignas(64) double lanes[8];
+    _mm512_store_pd(lanes, dd);
+    double best = *std::max_element(lanes, lanes + 8);
+    _mm256_zeroupper();
+    best = std::max(best, maxDrawdownScalar(e + i, n - i, p));
+    peak = p;
+    return best;
+}
+
+#if !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+// Window wrappers: the generic bodies compiled per target
+
+AXIOM_SSE2 void rollingMeanSse2(const double* in, double* out, size_t from, size_t to, int w) {
+    rollingMeanBody<2>(in, out, from, to, w);
+}
+AXIOM_SSE2 void rollingStdSse2(const double* r, double* out, size_t from, size_t to, int w) {
+    rollingStdBody<2>(r, out, from, to, w);
+}
+AXIOM_AVX2 void rollingMeanAvx2(const double* in, double* out, size_t from, size_t to, int w) {
+    rollingMeanBody<4>(in, out, from, to, w);
+}
+AXIOM_AVX2 void rollingStdAvx2(const double* r, double* out, size_t from, size_t to, int w) {
+    rollingStdBody<4>(r, out, from, to, w);
+}
+AXIOM_AVX512 void rollingMeanAvx512(const double* in, double* out, size_t from, size_t to, int w) {
+    rollingMeanBody<8>(in, out, from, to, w);
+}
+AXIOM_AVX512 void rollingStdAvx512(const double* r, double* out, size_t from, size_t to, int w) {
+    rollingStdBody<8>(r, out, from, to, w);
+}
+
+// Agent demand wrappers
+
+AXIOM_SSE2 void fundamentalDemandSse2(const float* value, const float* threshold,
+                                      const float* weight, float inv_price, size_t n,
+                                      float* lanes) {
+    fundamentalDemandBody<4>(value, threshold, weight, inv_price, n, lanes);
+}
+AXIOM_SSE2 void chartistDemandSse2(const float* sensitivity, const float* weight,
+                                   float momentum, size_t n, float* lanes) {
+    chartistDemandBody<4>(sensitivity, weight, momentum, n, lanes);
+}
+AXIOM_SSE2 void noiseDemandSse2(const float* weight, float sentiment, uint32_t key,
+                                uint32_t first, size_t n, float* lanes) {
+    noiseDemandBody<4>(weight, sentiment, key, first, n, lanes);
+}
+AXIOM_AVX2 void fundamentalDemandAvx2(const float* value, const float* threshold,
+                                      const float* weight, float inv_price, size_t n,
+                                      float* lanes) {
+    fundamentalDemandBody<8>(value, threshold, weight, inv_price, n, lanes);
+    _mm256_zeroupper();
+}
+AXIOM_AVX2 void chartistDemandAvx2(const float* sensitivity, const float* weight,
+                                   float momentum, size_t n, float* lanes) {
+    chartistDemandBody<8>(sensitivity, weight, momentum, n, lanes);
+    _mm256_zeroupper();
+}
+AXIOM_AVX2 void noiseDemandAvx2(const float* weight, float sentiment, uint32_t key,
+                                uint32_t first, size_t n, float* lanes) {
+    noiseDemandBody<8>(weight, sentiment, key, first, n, lanes);
+    _mm256_zeroupper();
+}
+AXIOM_AVX512 void fundamentalDemandAvx512(const float* value, const float* threshold,
+                                          const float* weight, float inv_price, size_t n,
+                                          float* lanes) {
+    fundamentalDemandBody<16>(value, threshold, weight, inv_price, n, lanes);
+    _mm256_zeroupper();
+}
+AXIOM_AVX512 void chartistDemandAvx512(const float* sensitivity, const float* weight,
+                                       float momentum, size_t n, float* lanes) {
+    chartistDemandBody<16>(sensitivity, weight, momentum, n, lanes);
+    _mm256_zeroupper();
+}
+AXIOM_AVX512 void noiseDemandAvx512(const float* weight, float sentiment, uint32_t key,
+                                    uint32_t first, size_t n, float* lanes) {
+    noiseDemandBody<16>(weight, sentiment, key, first, n, lanes);
+    _mm256_zeroupper();
+}
+
+// Model wrappers: one path per lane
+
+AXIOM_SSE2 void gbmPathsSse2(const ModelCoefficients& c, const uint64_t* key, double* price,
+                             double* state, size_t n, uint64_t t, size_t steps, double* out,
+                             size_t stride) {
+    modelPaths<GbmPath, Lanes<2>::type, Lanes<2>::bits>(c, key, price, state, n, t, steps, out,
+                                                        stride);
+}
+AXIOM_SSE2 void garchPathsSse2(const ModelCoefficients& c, const uint64_t* key, double* price,
+                               double* state, size_t n, uint64_t t, size_t steps, double* out,
+                               size_t stride) {
+    modelPaths<GarchPath, Lanes<2>::type, Lanes<2>::bits>(c, key, price, state, n, t, steps, out,
+                                                          stride);
+}
+AXIOM_SSE2 void jumpPathsSse2(const ModelCoefficients& c, const uint64_t* key, double* price,
+                              double* state, size_t n, uint64_t t, size_t steps, double* out,
+                              size_t stride) {
+    modelPaths<JumpPath, Lanes<2>::type, Lanes<2>::bits>(c, key, price, state, n, t, steps, out,
+                                                         stride);
+}
+AXIOM_SSE2 void switchingPathsSse2(const ModelCoefficients& c, const uint64_t* key, double* price,
+                                   double* state, size_t n, uint64_t t, size_t steps, double* out,
+                                   size_t stride) {
+    modelPaths<SwitchingPath, Lanes<2>::type, Lanes<2>::bits>(c, key, price, state, n, t, steps,
+                                                              out, stride);
+}
+AXIOM_AVX2 void gbmPathsAvx2(const ModelCoefficients& c, const uint64_t* key, double* price,
+                             double* state, size_t n, uint64_t t, size_t steps, double* out,
+                             size_t stride) {
+    modelPaths<GbmPath, Lanes<4>::type, Lanes<4>::bits>(c, key, price, state, n, t, steps, out,
+                                                        stride);
+    _mm256_zeroupper();
+}
+AXIOM_AVX2 void garchPathsAvx2(const ModelCoefficients& c, const uint64_t* key, double* price,
+                               double* state, size_t n, uint64_t t, size_t steps, double* out,
+                               size_t stride) {
+    modelPaths<GarchPath, Lanes<4>::type, Lanes<4>::bits>(c, key, price, state, n, t, steps, out,
+                                                          stride);
+    _mm256_zeroupper();
+}
+AXIOM_AVX2 void jumpPathsAvx2(const ModelCoefficients& c, const uint64_t* key, double* price,
+                              double* state, size_t n, uint64_t t, size_t steps, double* out,
+                              size_t stride) {
+    modelPaths<JumpPath, Lanes<4>::type, Lanes<4>::bits>(c, key, price, state, n, t, steps, out,
+                                                         stride);
+    _mm256_zeroupper();
+}
+AXIOM_AVX2 void switchingPathsAvx2(const ModelCoefficients& c, const uint64_t* key, double* price,
+                                   double* state, size_t n, uint64_t t, size_t steps, double* out,
+                                   size_t stride) {
+    modelPaths<SwitchingPath, Lanes<4>::type, Lanes<4>::bits>(c, key, price, state, n, t, steps,
+                                                              out, stride);
+    _mm256_zeroupper();
+}
+AXIOM_AVX512 void gbmPathsAvx512(const ModelCoefficients& c, const uint64_t* key, double* price,
+                                 double* state, size_t n, uint64_t t, size_t steps, double* out,
+                                 size_t stride) {
+    modelPaths<GbmPath, Lanes<8>::type, Lanes<8>::bits>(c, key, price, state, n, t, steps, out,
+                                                        stride);
+    _mm256_zeroupper();
+}
+AXIOM_AVX512 void garchPathsAvx512(const ModelCoefficients& c, const uint64_t* key, double* price,
+                                   double* state, size_t n, uint64_t t, size_t steps, double* out,
+                                   size_t stride) {
+    modelPaths<GarchPath, Lanes<8>::type, Lanes<8>::bits>(c, key, price, state, n, t, steps, out,
+                                                          stride);
+    _mm256_zeroupper();
+}
+AXIOM_AVX512 void jumpPathsAvx512(const ModelCoefficients& c, const uint64_t* key, double* price,
+                                  double* state, size_t n, uint64_t t, size_t steps, double* out,
+                                  size_t stride) {
+    modelPaths<JumpPath, Lanes<8>::type, Lanes<8>::bits>(c, key, price, state, n, t, steps, out,
+                                                         stride);
+    _mm256_zeroupper();
+}
+AXIOM_AVX512 void switchingPathsAvx512(const ModelCoefficients& c, const uint64_t* key,
+                                       double* price, double* state, size_t n, uint64_t t,
+                                       size_t steps, double* out, size_t stride) {
+    modelPaths<SwitchingPath, Lanes<8>::type, Lanes<8>::bits>(c, key, price, state, n, t, steps,
+                                                              out, stride);
+    _mm256_zeroupper();
+}
+
+// Lane block wrappers
+
+AXIOM_SSE2 void laneMeanSse2(const double* in, double* out, size_t from, size_t to, int w) {
+    laneMeanBody<2>(in, out, from, to, w);
+}
+AXIOM_SSE2 void laneStdSse2(const double* r, double* out, size_t from, size_t to, int w) {
+    laneStdBody<2>(r, out, from, to, w);
+}
+AXIOM_SSE2 void laneRsiSse2(const double* prices, double* out, double* gain, double* loss,
+                            size_t from, size_t to, int w) {
+    for (size_t j = 0; j < kPathLanes; j += 2)
+        rsiLanes<Lanes<2>::type>(prices, out, gain, loss, from, to, w, j);
+}
+AXIOM_SSE2 void laneBacktestSse2(const double* prices, const uint8_t* buy, const uint8_t* sell,
+                                 size_t n, LaneBook& book) {
+    for (size_t j = 0; j < kPathLanes; j += 2)
+        backtestLanes<Lanes<2>::type, kPathLanes>(prices, buy, sell, n, book, j);
+}
+AXIOM_SSE2 void variantBacktestSse2(const double* prices, const uint8_t* buy,
+                                    const uint8_t* sell, size_t n, LaneBook& book) {
+    for (size_t j = 0; j < kPathLanes; j += 2)
+        backtestLanes<Lanes<2>::type, 0>(prices, buy, sell, n, book, j);
+}
+
+AXIOM_AVX2 void laneMeanAvx2(const double* in, double* out, size_t from, size_t to, int w) {
+    laneMeanBody<4>(in, out, from, to, w);
+    _mm256_zeroupper();
+}
+AXIOM_AVX2 void laneStdAvx2(const double* r, double* out, size_t from, size_t to, int w) {
+    laneStdBody<4>(r, out, from, to, w);
+    _mm256_zeroupper();
+}
+AXIOM_AVX2 void laneRsiAvx2(const double* prices, double* out, double* gain, double* loss,
+                            size_t from, size_t to, int w) {
+    for (size_t j = 0; j < kPathLanes; j += 4)
+        rsiLanes<Lanes<4>::type>(prices, out, gain, loss, from, to, w, j);
+    _mm256_zeroupper();
+}
+AXIOM_AVX2 void laneBacktestAvx2(const double* prices, const uint8_t* buy, const uint8_t* sell,
+                                 size_t n, LaneBook& book) {
+    for (size_t j = 0; j < kPathLanes; j += 4)
+        backtestLanes<Lanes<4>::type, kPathLanes>(prices, buy, sell, n, book, j);
+    _mm256_zeroupper();
+}
+AXIOM_AVX2 void variantBacktestAvx2(const double* prices, const uint8_t* buy,
+                                    const uint8_t* sell, size_t n, LaneBook& book) {
+    for (size_t j = 0; j < kPathLanes; j += 4)
+        backtestLanes<Lanes<4>::type, 0>(prices, buy, sell, n, book, j);
+    _mm256_zeroupper();
+}
+
+AXIOM_AVX512 void laneMeanAvx512(const double* in, double* out, size_t from, size_t to, int w) {
+    laneMeanBody<8>(in, out, from, to, w);
+    _mm256_zeroupper();
+}
+AXIOM_AVX512 void laneStdAvx512(const double* r, double* out, size_t from, size_t to, int w) {
+    laneStdBody<8>(r, out, from, to, w);
+    _mm256_zeroupper();
+}
+AXIOM_AVX512 void laneRsiAvx512(const double* prices, double* out, double* gain, double* loss,
+                                size_t from, size_t to, int w) {
+    rsiLanes<Lanes<8>::type>(prices, out, gain, loss, from, to, w, 0);
+    _mm256_zeroupper();
+}
+AXIOM_AVX512 void laneBacktestAvx512(const double* prices, const uint8_t* buy,
+                                     const uint8_t* sell, size_t n, LaneBook& book) {
+    backtestLanes<Lanes<8>::type, kPathLanes>(prices, buy, sell, n, book, 0);
+    _mm256_zeroupper();
+}
+AXIOM_AVX512 void variantBacktestAvx512(const double* prices, const uint8_t* buy,
+                                        const uint8_t* sell, size_t n, LaneBook& book) {
+    backtestLanes<Lanes<8>::type, 0>(prices, buy, sell, n, book, 0);
+    _mm256_zeroupper();
+}
+
+} // namespace
+
+static const KernelTable kSse2 = {
+    Isa::SSE2,
+    rollingMeanSse2,
+    rollingStdSse2,
+    compareF64Sse2,
+    compareF32Sse2,
+    maxDrawdownSse2,
+    fundamentalDemandSse2,
+    chartistDemandSse2,
+    noiseDemandSse2,
+    gbmPathsSse2,
+    garchPathsSse2,
+    jumpPathsSse2,
+    switchingPathsSse2,
+    laneMeanSse2,
+    laneStdSse2,
+    laneRsiSse2,
+    laneBacktestSse2,
+    thresholdF64Sse2,
+    thresholdF32Sse2,
+    variantBacktestSse2
+};
+
+static const KernelTable kAvx2 = {
+    Isa::AVX2,
+    rollingMeanAvx2,
+    rollingStdAvx2,
+    compareF64Avx2,
+    compareF32Avx2,
+    maxDrawdownAvx2,
+    fundamentalDemandAvx2,
+    chartistDemandAvx2,
+    noiseDemandAvx2,
+    gbmPathsAvx2,
+    garchPathsAvx2,
+    jumpPathsAvx2,
+    switchingPathsAvx2,
+    laneMeanAvx2,
+    laneStdAvx2,
+    laneRsiAvx2,
+    laneBacktestAvx2,
+    thresholdF64Avx2,
+    thresholdF32Avx2,
+    variantBacktestAvx2
+};
+
+static const KernelTable kAvx512 = {
+    Isa::AVX512,
+    rollingMeanAvx512,
+    rollingStdAvx512,
+    compareF64Avx512,
+    compareF32Avx512,
+    maxDrawdownAvx512,
+    fundamentalDemandAvx512,
+    chartistDemandAvx512,
+    noiseDemandAvx512,
+    gbmPathsAvx512,
+    garchPathsAvx512,
+    jumpPathsAvx512,
+    switchingPathsAvx512,
+    laneMeanAvx512,
+    laneStdAvx512,
+    laneRsiAvx512,
+    laneBacktestAvx512,
+    thresholdF64Avx512,
+    thresholdF32Avx512,
+    variantBacktestAvx512
+};
+
+#endif // AXIOM_X86_KERNELS
+
+// ---------------------------------------------------------
+// 4. DISPATCH
+// ---------------------------------------------------------
+
+static bool isaSupported(Isa isa) {
+    switch (isa) {
+        case Isa::SCALAR: return true;
+#ifdef AXIOM_X86_KERNELS
+        case Isa::SSE2:   return __builtin_cpu_supports("sse2");
+        case Isa::AVX2:   return __builtin_cpu_supports("avx2");
+        case Isa::AVX512: return __builtin_cpu_supports("avx512f") &&
+                                 __builtin_cpu_supports("avx512bw");
+#endif
+        default: return false;
+    }
+}
+
+static const KernelTable* tableFor(Isa isa) {
+    switch (isa) {
+#ifdef AXIOM_X86_KERNELS
+        case Isa::SSE2:   return &kSse2;
+        case Isa::AVX2:   return &kAvx2;
+        case Isa::AVX512: return &kAvx512;
+#endif
+        default: return &kScalar;
+    }
+}
+
+Isa detectIsa() {
+    for (Isa isa : {Isa::AVX512, Isa::AVX2, Isa::SSE2})
+        if (isaSupported(isa)) return isa;
+    return Isa::SCALAR;
+}
+
+// Shared by every thread of the process (library and server mode)
+static std::atomic<const KernelTable*> active{nullptr};
+
+const KernelTable& kernels() {
+    const KernelTable* table = active.load(std::memory_order_acquire);
+    if (!table) {
+        table = tableFor(detectIsa());
+        active.store(table, std::memory_order_release);
+    }
+    return *table;
+}
+
+bool selectIsa(Isa isa) {
+    if (!isaSupported(isa)) return false;
+    active.store(tableFor(isa), std::memory_order_release);
+    return true;
+}
+
+const char* isaName(Isa isa) {
+    switch (isa) {
+        case Isa::SCALAR: return "scalar";
+        case Isa::SSE2:   return "sse2";
+        case Isa::AVX2:   return "avx2";
+        case Isa::AVX512: return "avx512";
+        default: return "unknown";
+    }
+}
+
+bool parseIsa(const std::string& name, Isa& out) {
+    for (Isa isa : {Isa::SCALAR, Isa::SSE2, Isa::AVX2, Isa::AVX512}) {
+        if (name == isaName(isa)) {
+            out = isa;
+            return true;
+        }
+    }
+    return false;
+}
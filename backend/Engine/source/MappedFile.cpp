@@ -0,0 +1,54 @@
+#include "../include/MappedFile.hpp"
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#endif
+
+#ifndef _WIN32
+
+MappedFile::MappedFile(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("Cannot open " + path);
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Cannot read " + path);
+    }
+    length = (size_t)st.st_size;
+    if (length > 0) {
+        void* p = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("Cannot map " + path);
+        }
+        base = static_cast<const char*>(p);
+    }
+    ::close(fd);        // the mapping keeps the file
+}
+
+MappedFile::~MappedFile() {
+    if (base && length) munmap(const_cast<char*>(base), length);
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) throw std::runtime_error("Cannot open " + path);
+    copy.resize((size_t)in.tellg());
+    in.seekg(0);
+    if (!in.read(copy.data(), (std::streamsize)copy.size()))
+        throw std::runtime_error("Cannot read " + path);
+    base = copy.data();
+    length = copy.size();
+}
+
+MappedFile::~MappedFile() {}
+
+#endif
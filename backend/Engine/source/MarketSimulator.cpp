@@ -1,16 +1,121 @@
 #include "../include/MarketSimulator.hpp"
+#include "../include/Kernels.hpp"
+#include <algorithm>
 #include <cmath>
+#include <sstream>
 #include <stdexcept>
 
+constexpr MarketDynamics kTrending = {0.05, 0.0, 100.0, 0.2};
+constexpr MarketDynamics kSideways = {0.0, 0.0, 100.0, 0.2};
+constexpr MarketDynamics kMeanReverting = {0.0, 0.05, 100.0, 0.3};
+// Bar std-dev of the default agent population, measured
+constexpr MarketDynamics kAgents = {0.0, 0.0, 100.0, 0.19};
+
+MarketDynamics marketDynamics(const std::string& market) {
+    if (market == "Trending") return kTrending;
+    if (market == "Sideways") return kSideways;
+    if (market == "Agents") return kAgents;
+    if (StochasticModel::isModel(market)) {
+        auto model = StochasticModel::create(market, ModelParams());
+        return {model->drift(), 0.0, 100.0, model->volatility()};
+    }
+    return kMeanReverting;
+}
+
+// Intrabar paths kept per simulator
+constexpr size_t kIntrabarPaths = 4096;
+// Bars that set recorded prices' bar volatility
+constexpr size_t kVolatilitySample = 4096;
+
 MarketSimulator::MarketSimulator(const Config& cfg)
-    : config(cfg), rng(cfg.seed) {}
+    : config(cfg), rng(cfg.seed),
+      intrabar(std::make_unique<IntrabarPaths>(cfg.seed, kIntrabarPaths)),
+      model(StochasticModel::create(cfg.market, cfg.model)) {
+    if (model) model_state = model->initialState();
+}
 
 void MarketSimulator::runMarket() {
     prices.clear();
-    double price = 100.0;
-    prices.push_back(price);
+    first = 0;
+    price_count = 0;
+    if (model) model_state = model->initialState();
+    intrabar = std::make_unique<IntrabarPaths>(config.seed, kIntrabarPaths);
+    resetTimeframes();
+    extendMarket(config.timesteps > 0 ? config.timesteps : 1);
+}
 
-    for (int t = 1; t < config.timesteps; t++) {
+void MarketSimulator::usePrices(std::shared_ptr<const PriceSource> src) {
+    PriceSpan span = src ? src->prices() : PriceSpan{};
+    if (span.empty()) throw std::invalid_argument("No prices to use");
+    source = std::move(src);
+    source_data = span.data();
+    source_bars = span.size();
+    if (config.timesteps > 0 && (size_t)config.timesteps > source_bars)
+        config.timesteps = (int)source_bars;
+    Series<double>().swap(prices);
+    first = 0;
+    price_data = source_data;
+    price_count = 0;
+    intrabar = std::make_unique<IntrabarPaths>(config.seed, kIntrabarPaths);
+    resetTimeframes();
+
+    recorded_sd = 0.0;
+    if (!source->simulated() && source_bars > 1) {
+        size_t n = std::min(source_bars - 1, kVolatilitySample);
+        double sum = 0.0, sq = 0.0;
+        for (size_t t = 1; t <= n; t++) {
+            double d = source_data[t] - source_data[t - 1];
+            sum += d;
+            sq += d * d;
+        }
+        double mean = sum / n;
+        recorded_sd = std::sqrt(std::max(0.0, sq / n - mean * mean));
+    }
+}
+
+void MarketSimulator::extendMarket(size_t bars) {
+    if (source) {
+        // borrowed: expose the next bars, there is nothing to generate
+        price_count = std::min(bars, source_bars) - first;
+        resample();
+        return;
+    }
+
+    if (prices.empty()) {
+        prices.reserve(config.timesteps > 0 ? config.timesteps : 1);
+        prices.push_back(100.0);
+    }
+    if (config.market == "Agents") {
+        if (!agents) {
+            AgentMarketConfig population;
+            population.seed = config.seed;
+            agents = std::make_unique<AgentMarket>(population);
+        }
+        agents->extend(prices, first, bars);
+        price_data = prices.data();
+        price_count = prices.size();
+        resample();
+        return;
+    }
+
+    if (model) {
+        // one lane of the model kernels, drawing from (seed, bar)
+        const size_t have = prices.size();
+        if (first + have < bars) {
+            const uint64_t key = StochasticModel::pathKey(config.seed);
+            double price = prices.back();
+            prices.resize(bars - first);
+            model->advance(&key, &price, &model_state, 1, first + have - 1, bars - first - have,
+                           prices.data() + have, 1);
+        }
+        price_data = prices.data();
+        price_count = prices.size();
+        resample();
+        return;
+    }
+
+    double price = prices.back();
+    while (first + prices.size() < bars) {
         if (config.market == "Trending")
             price = stepTrending(price);
         else if(config.market == "Sideways")
@@ -20,142 +125,202 @@ void MarketSimulator::runMarket() {
 
         prices.push_back(price);
     }
+    price_data = prices.data();
+    price_count = prices.size();
+    resample();
 }
 
 double MarketSimulator::stepTrending(double price) {
-    std::normal_distribution<double> noise(0.0, 0.2);
-    double drift = 0.05;
+    std::normal_distribution<double> noise(0.0, kTrending.noise);
+    double drift = kTrending.drift;
     double next = price + drift + noise(rng);
     return next > 0.0 ? next : 0.01;
 }
 
 double MarketSimulator::stepSideways(double price) {
-    std::normal_distribution<double> noise(0.0, 0.2);
+    std::normal_distribution<double> noise(0.0, kSideways.noise);
     double next = price + noise(rng);
     return next > 0.0 ? next : 0.01;
 }
 
 double MarketSimulator::stepMeanReverting(double price) {
-    std::normal_distribution<double> noise(0.0, 0.3);
-    double mean = 100.0;
-    double k = 0.05;  // reversion strength
+    std::normal_distribution<double> noise(0.0, kMeanReverting.noise);
+    double mean = kMeanReverting.mean;
+    double k = kMeanReverting.reversion;  // reversion strength
     
     double next = price + k * (mean - price) + noise(rng);
     return next > 0.0 ? next : 0.01;
 }
 
 
-static double mean(const std::vector<double>& v, int l, int r) {
-    double s = 0.0;
-    for (int i = l; i <= r; i++) s += v[i];
-    return s / (r - l + 1);
+SignalColumn& MarketSimulator::newColumn(SignalType type) {
+    SignalColumn& col = signals[type];
+    col.reset(price_count, config.precision);
+    col.reserve(std::max<size_t>(bars(), config.timesteps > 0 ? config.timesteps : 1) - first);
+    return col;
 }
 
-void MarketSimulator::computeMovingAverage(int sw, int lw) {
-    std::vector<double> short_ma(prices.size(), 0.0);
-    std::vector<double> long_ma(prices.size(), 0.0);
-
-    for (int t = 0; t < (int)prices.size(); t++) {
-        if (t >= sw - 1)
-            short_ma[t] = mean(prices, t - sw + 1, t);
-        if (t >= lw - 1)
-            long_ma[t] = mean(prices, t - lw + 1, t);
+// Run a double-output kernel over positions [from, to) of a column.
+// float32 columns go through a small block that is narrowed on store.
+template <typename Kernel>
+static void fillColumn(SignalColumn& col, size_t from, size_t to, Kernel kernel) {
+    if (from >= to) return;
+    if (!col.isSingle()) {
+        kernel(col.f64() + from, from, to);
+        return;
+    }
+    const size_t block = 1024;
+    double buf[block];
+    for (size_t b = from; b < to; b += block) {
+        size_t e = std::min(to, b + block);
+        kernel(buf, b, e);
+        for (size_t t = b; t < e; t++) col.set(t, buf[t - b]);
     }
+}
 
-    signals[SignalType::MA_SHORT] = short_ma;
-    signals[SignalType::MA_LONG]  = long_ma;
+void MarketSimulator::computeMovingAverage(int sw, int lw) {
+    addIndicator({Indicator::MOVING_AVERAGE, SignalType::MA_SHORT, SignalType::PRICE, sw});
+    addIndicator({Indicator::MOVING_AVERAGE, SignalType::MA_LONG, SignalType::PRICE, lw});
 }
 
 void MarketSimulator::computeRSI(int period) {
+    addIndicator({Indicator::RSI, SignalType::RSI, SignalType::PRICE, period});
+}
 
-    std::vector<double> rsi(prices.size(), 0.0);
-
-    double gain = 0.0;
-    double loss = 0.0;
-
-    // initial average gain/loss
-    for (int i = 1; i <= period; i++) {
-        double diff = prices[i] - prices[i - 1];
-        if (diff >= 0)
-            gain += diff;
-        else
-            loss -= diff;
-    }
-
-    gain /= period;
-    loss /= period;
-
-    // first RSI value
-    double rs = (loss == 0) ? 0 : gain / loss;
-    rsi[period] = 100.0 - (100.0 / (1.0 + rs));
-
-    // remaining RSI values (Wilder smoothing)
-    for (int i = period + 1; i < (int)prices.size(); i++) {
-        double diff = prices[i] - prices[i - 1];
-
-        double g = diff > 0 ? diff : 0;
-        double l = diff < 0 ? -diff : 0;
-
-        gain = (gain * (period - 1) + g) / period;
-        loss = (loss * (period - 1) + l) / period;
+void MarketSimulator::computeVolatility(int window) {
+    addIndicator({Indicator::VOLATILITY, SignalType::VOLATILITY, SignalType::PRICE, window});
+}
 
-        rs = (loss == 0) ? 0 : gain / loss;
-        rsi[i] = 100.0 - (100.0 / (1.0 + rs));
-    }
+void MarketSimulator::computeMovingAverageOnSignal(
+    SignalType src,
+    SignalType dst,
+    int window
+) {
+    if (signals.find(src) == signals.end())
+        throw std::runtime_error("Source signal not computed");
+    addIndicator({Indicator::SIGNAL_AVERAGE, dst, src, window});
+}
 
-    signals[SignalType::RSI] = rsi;
+void MarketSimulator::extendSignals() {
+    for (Indicator& ind : indicators) fill(ind);
+    for (auto& frame : frames) frame->extendSignals();
 }
 
+// (Re)compute an indicator from bar 0 and keep it for extendSignals()
+void MarketSimulator::addIndicator(Indicator ind) {
+    indicators.erase(std::remove_if(indicators.begin(), indicators.end(),
+                                    [&](const Indicator& i) { return i.dst == ind.dst; }),
+                     indicators.end());
+    for (auto& frame : frames) frame->addIndicator(ind);
+    newColumn(ind.dst);
+    indicators.push_back(ind);
+    fill(indicators.back());
+}
 
+// Fill bars [ind.done, bars()). Every value depends only on earlier
+// prices, so filling in chunks gives the same column as one pass.
+// Bar t is at t - first in the series; after a restore the held tail
+// covers every window that reaches back before ind.done.
+void MarketSimulator::fill(Indicator& ind) {
+    SignalColumn& col = signals[ind.dst];
+    const size_t o = first;
+    const size_t n = bars();
+    const int w = ind.window;
+    const KernelTable& k = kernels();
+    col.resize(n - o);
+
+    switch (ind.kind) {
+    case Indicator::MOVING_AVERAGE: {
+        size_t from = std::max(ind.done, (size_t)w - 1);
+        if (from >= n) break;
+        fillColumn(col, from - o, n - o, [&](double* out, size_t a, size_t b) {
+            k.rollingMean(price_data, out, a, b, w);
+        });
+        break;
+    }
 
-void MarketSimulator::computeVolatility(int window) {
+    case Indicator::RSI: {
+        size_t i = ind.done;
+        if (i == 0) {
+            if (n <= (size_t)w) return;     // not enough bars yet
+
+            // initial average gain/loss
+            double gain = 0.0;
+            double loss = 0.0;
+            for (int j = 1; j <= w; j++) {
+                double diff = price_data[j - o] - price_data[j - 1 - o];
+                if (diff >= 0)
+                    gain += diff;
+                else
+                    loss -= diff;
+            }
+            ind.gain = gain / w;
+            ind.loss = loss / w;
+
+            // first RSI value
+            double rs = (ind.loss == 0) ? 0 : ind.gain / ind.loss;
+            col.set(w - o, 100.0 - (100.0 / (1.0 + rs)));
+            i = w + 1;
+        }
 
-    std::vector<double> vol(prices.size(), 0.0);
+        // remaining RSI values (Wilder smoothing)
+        for (; i < n; i++) {
+            double diff = price_data[i - o] - price_data[i - 1 - o];
 
-    for (int t = window; t < (int)prices.size(); t++) {
+            double g = diff > 0 ? diff : 0;
+            double l = diff < 0 ? -diff : 0;
 
-        double mean = 0.0;
-        double sq_sum = 0.0;
+            ind.gain = (ind.gain * (w - 1) + g) / w;
+            ind.loss = (ind.loss * (w - 1) + l) / w;
 
-        // compute log returns
-        std::vector<double> rets;
-        for (int i = t - window + 1; i <= t; i++) {
-            double r = std::log(prices[i] / prices[i - 1]);
-            rets.push_back(r);
-            mean += r;
+            double rs = (ind.loss == 0) ? 0 : ind.gain / ind.loss;
+            col.set(i - o, 100.0 - (100.0 / (1.0 + rs)));
         }
-
-        mean /= window;
-
-        for (double r : rets)
-            sq_sum += (r - mean) * (r - mean);
-
-        vol[t] = std::sqrt(sq_sum / window);
+        break;
     }
 
-    signals[SignalType::VOLATILITY] = vol;
-}
-
-void MarketSimulator::computeMovingAverageOnSignal(
-    SignalType src,
-    SignalType dst,
-    int window
-) {
-    auto it = signals.find(src);
-    if (it == signals.end())
-        throw std::runtime_error("Source signal not computed");
+    case Indicator::VOLATILITY: {
+        // std-dev of the last `w` log returns, from the first full window
+        size_t from = std::max(ind.done, (size_t)w);
+        if (from >= n) break;
+
+        // returns for bars [base, n) only; rets[j] is bar base + j
+        size_t base = from + 1 - w;
+        Series<double> rets(n - base);
+        for (size_t t = base; t < n; t++)
+            rets[t - base] = std::log(price_data[t - o] / price_data[t - 1 - o]);
+
+        fillColumn(col, from - o, n - o, [&](double* out, size_t a, size_t b) {
+            k.rollingStd(rets.data(), out, a + o - base, b + o - base, w);
+        });
+        break;
+    }
 
-    const auto& v = it->second;
-    std::vector<double> ma(v.size(), 0.0);
+    case Indicator::SIGNAL_AVERAGE: {
+        size_t from = std::max(ind.done, (size_t)w - 1);
+        if (from >= n) break;
+
+        const SignalColumn& v = signals[ind.src];
+
+        // the kernel reads double; widen float32 sources first
+        size_t base = o;
+        Series<double> widened;
+        const double* values = v.f64();
+        if (v.isSingle()) {
+            base = from + 1 - w;
+            widened.resize(n - base);
+            for (size_t t = base; t < n; t++) widened[t - base] = v.get(t - o);
+            values = widened.data();
+        }
 
-    for (int t = window - 1; t < (int)v.size(); t++) {
-        double sum = 0.0;
-        for (int i = t - window + 1; i <= t; i++)
-            sum += v[i];
-        ma[t] = sum / window;
+        fillColumn(col, from - o, n - o, [&](double* out, size_t a, size_t b) {
+            k.rollingMean(values, out, a + o - base, b + o - base, w);
+        });
+        break;
+    }
     }
 
-    signals[dst] = ma;
+    ind.done = n;
 }
 
 std::vector<SignalType> MarketSimulator::getAvailableSignals() const {
@@ -166,11 +331,6 @@ std::vector<SignalType> MarketSimulator::getAvailableSignals() const {
 }
 
 
-const std::vector<double>& MarketSimulator::getPrices() const {
-    return prices;
-}
-
-
 std::string MarketSimulator::signalName(SignalType s) {
     switch (s) {
         case SignalType::PRICE: return "Price";
@@ -184,8 +344,237 @@ std::string MarketSimulator::signalName(SignalType s) {
 }
 
 double MarketSimulator::getSignal(SignalType type, int t) const {
+    return getColumn(type).get(t - first);
+}
+
+const SignalColumn& MarketSimulator::getColumn(SignalType type) const {
     auto it = signals.find(type);
     if (it == signals.end())
         throw std::runtime_error("Signal not computed");
-    return it->second[t];
+    return it->second;
+}
+
+IntrabarPaths::Path MarketSimulator::ticks(size_t t) const {
+    if (t <= first || t >= bars()) throw std::out_of_range("Bar outside the held prices");
+    return intrabar->get(t, price_data[t - 1 - first], price_data[t - first], barVolatility());
+}
+
+double MarketSimulator::barVolatility() const {
+    return dynamics().noise;
+}
+
+MarketDynamics MarketSimulator::dynamics() const {
+    if (source && !source->simulated()) return {0.0, 0.0, 0.0, recorded_sd};
+    if (model) return {model->drift(), 0.0, 100.0, model->volatility()};
+    return marketDynamics(config.market);
+}
+
+// ---------------------------------------------------------
+// TIMEFRAMES
+// ---------------------------------------------------------
+// Frame simulators are fed the closes of completed frame bars, so their
+// indicators see exactly the bars a run over the frame closes would.
+
+std::unique_ptr<MarketSimulator> MarketSimulator::frameSimulator(int k) const {
+    Config cfg = config;
+    cfg.timesteps = std::max(1, config.timesteps / k);
+    cfg.prices_file.clear();
+    return std::make_unique<MarketSimulator>(cfg);
+}
+
+void MarketSimulator::addTimeframe(int k) {
+    if (k < 1 || k > kMaxTimeframe)
+        throw std::invalid_argument("timeframe: 1 to " + std::to_string(kMaxTimeframe) + " bars");
+    if (k == 1 || timeframe(k)) return;     // 1 is the simulator itself
+    if (first != 0) throw std::invalid_argument("A resumed run cannot add a timeframe");
+    if (frames.size() == kMaxTimeframes)
+        throw std::invalid_argument("At most " + std::to_string(kMaxTimeframes) + " timeframes");
+
+    auto sim = frameSimulator(k);
+    const PriceSeries& bars = resampler.frame(resampler.add(k, price_data, price_count));
+    sim->appendPrices(bars.close.data(), bars.size());
+    for (const Indicator& ind : indicators)
+        sim->addIndicator({ind.kind, ind.dst, ind.src, ind.window});
+    frames.push_back(std::move(sim));
+}
+
+const MarketSimulator* MarketSimulator::timeframe(int k) const {
+    for (size_t i = 0; i < frames.size(); i++)
+        if (resampler.frameSize(i) == k) return frames[i].get();
+    return nullptr;
+}
+
+void MarketSimulator::appendPrices(const double* data, size_t count) {
+    prices.insert(prices.end(), data, data + count);
+    price_data = prices.data();
+    price_count = prices.size();
+    resample();
+}
+
+// Aggregate the bars added since the last call into every timeframe
+void MarketSimulator::resample() {
+    const size_t n = bars();
+    const size_t done = resampler.bars();
+    if (done >= n) return;
+    resampler.extend(price_data + (done - first), n - done);
+    for (size_t i = 0; i < frames.size(); i++) {
+        const PriceSeries& f = resampler.frame(i);
+        MarketSimulator& sim = *frames[i];
+        size_t from = sim.bars() - resampler.origin(i);
+        sim.appendPrices(f.close.data() + from, f.size() - from);
+    }
+}
+
+// Start the timeframes over, for prices from bar 0
+void MarketSimulator::resetTimeframes() {
+    std::vector<int> sizes;
+    for (size_t i = 0; i < resampler.frames(); i++) sizes.push_back(resampler.frameSize(i));
+    resampler.clear();
+    frames.clear();
+    for (int k : sizes) addTimeframe(k);
+}
+
+// ---------------------------------------------------------
+// CHECKPOINTS
+// ---------------------------------------------------------
+// bars | borrowed | rng state | tail: origin, prices
+//   | indicators: state, column tail | resampler | frame simulators
+// The tail is as long as the widest window plus one (the return before
+// it), or an agent market's lookback, so every value after the
+// checkpoint can be computed from it.
+// The rng of a simulator on borrowed prices never ran: its checkpoints
+// only resume on the same prices.
+
+constexpr uint32_t kMaxRngWords = 1024;
+constexpr uint32_t kMaxIndicators = 16;
+
+void MarketSimulator::save(CheckpointWriter& out) const {
+    const size_t n = bars();
+    out.value((uint64_t)n);
+    out.value((uint8_t)(source != nullptr));
+
+    // std::mt19937 only exposes its state as text: the words, in order
+    std::vector<uint32_t> words;
+    std::stringstream state;
+    state << rng;
+    for (unsigned long word; state >> word;) words.push_back((uint32_t)word);
+    out.values(words.data(), words.size());
+    if (model) out.value(model_state);
+
+    size_t lookback = 1;
+    for (const Indicator& ind : indicators) lookback = std::max(lookback, (size_t)ind.window + 1);
+    if (config.market == "Agents") lookback = std::max(lookback, AgentMarket::kLookback + 1);
+    size_t from = n > lookback ? std::max(n - lookback, first) : first;
+    out.value((uint64_t)from);
+    out.values(price_data + (from - first), n - from);
+
+    out.value((uint32_t)indicators.size());
+    for (const Indicator& ind : indicators) {
+        out.value((int32_t)ind.kind);
+        out.value((int32_t)ind.dst);
+        out.value((int32_t)ind.src);
+        out.value((int32_t)ind.window);
+        out.value((uint64_t)ind.done);
+        out.value(ind.gain);
+        out.value(ind.loss);
+
+        const SignalColumn& col = signals.at(ind.dst);
+        if (col.isSingle()) out.values(col.f32() + (from - first), n - from);
+        else out.values(col.f64() + (from - first), n - from);
+    }
+
+    resampler.save(out);
+    for (const auto& frame : frames) frame->save(out);
+}
+
+void MarketSimulator::restore(CheckpointReader& in) {
+    const size_t n = (size_t)in.value<uint64_t>();
+    const bool borrowed = in.value<uint8_t>() != 0;
+    if (borrowed && !source)
+        throw std::invalid_argument("Checkpoint needs the prices it was taken on");
+
+    std::vector<uint32_t> words(in.count(kMaxRngWords));
+    in.values(words.data(), words.size());
+    std::stringstream state;
+    for (uint32_t word : words) state << word << ' ';
+    std::mt19937 saved;
+    if (!(state >> saved)) throw std::runtime_error("Corrupt checkpoint");
+    const double saved_model = model ? in.value<double>() : 0.0;
+    if (!std::isfinite(saved_model)) throw std::runtime_error("Corrupt checkpoint");
+
+    const size_t from = (size_t)in.value<uint64_t>();
+    if (from > n) throw std::runtime_error("Corrupt checkpoint");
+    Series<double> tail(in.count(n - from));
+    if (tail.size() != n - from) throw std::runtime_error("Corrupt checkpoint");
+    in.values(tail.data(), tail.size());
+    if (source && (n > source_bars ||
+                   !std::equal(tail.begin(), tail.end(), source_data + from)))
+        throw std::invalid_argument("Checkpoint does not match the borrowed prices");
+
+    const size_t total = std::max<size_t>(n, config.timesteps > 0 ? config.timesteps : 1);
+
+    const uint32_t count = in.value<uint32_t>();
+    if (count > kMaxIndicators) throw std::runtime_error("Corrupt checkpoint");
+    std::vector<Indicator> restored;
+    std::unordered_map<SignalType, SignalColumn> columns;
+    for (uint32_t i = 0; i < count; i++) {
+        Indicator ind;
+        int32_t kind = in.value<int32_t>();
+        int32_t dst = in.value<int32_t>();
+        int32_t src = in.value<int32_t>();
+        ind.window = in.value<int32_t>();
+        ind.done = (size_t)in.value<uint64_t>();
+        ind.gain = in.value<double>();
+        ind.loss = in.value<double>();
+        bool valid = kind >= Indicator::MOVING_AVERAGE && kind <= Indicator::SIGNAL_AVERAGE &&
+                     dst >= 0 && dst <= (int32_t)SignalType::VOLATILITY_MA &&
+                     src >= 0 && src <= (int32_t)SignalType::VOLATILITY_MA &&
+                     ind.window >= 1 && ind.done <= n &&
+                     (from == 0 || n - from > (size_t)ind.window);
+        if (!valid) throw std::runtime_error("Corrupt checkpoint");
+        ind.kind = (Indicator::Kind)kind;
+        ind.dst = (SignalType)dst;
+        ind.src = (SignalType)src;
+
+        SignalColumn& col = columns[ind.dst];
+        col.reset(in.count(n - from), config.precision);
+        if (col.size() != n - from) throw std::runtime_error("Corrupt checkpoint");
+        col.reserve(total - from);
+        if (col.isSingle()) in.values(col.f32(), col.size());
+        else in.values(col.f64(), col.size());
+        restored.push_back(ind);
+    }
+
+    Resampler resampled;
+    resampled.restore(in);
+    if (resampled.bars() != n || resampled.frames() > kMaxTimeframes)
+        throw std::runtime_error("Corrupt checkpoint");
+    std::vector<std::unique_ptr<MarketSimulator>> children;
+    for (size_t i = 0; i < resampled.frames(); i++) {
+        int k = resampled.frameSize(i);
+        if (k < 2 || k > kMaxTimeframe) throw std::runtime_error("Corrupt checkpoint");
+        auto child = frameSimulator(k);
+        child->restore(in);
+        if (child->bars() != resampled.origin(i) || !child->frames.empty())
+            throw std::runtime_error("Corrupt checkpoint");
+        children.push_back(std::move(child));
+    }
+
+    rng = saved;
+    model_state = saved_model;
+    first = from;
+    if (source) {
+        price_data = source_data + from;
+        price_count = n - from;
+    } else {
+        prices = std::move(tail);
+        prices.reserve(total - from);
+        price_data = prices.data();
+        price_count = prices.size();
+    }
+    indicators = std::move(restored);
+    signals = std::move(columns);
+    resampler = std::move(resampled);
+    frames = std::move(children);
+    intrabar = std::make_unique<IntrabarPaths>(config.seed, kIntrabarPaths);
 }
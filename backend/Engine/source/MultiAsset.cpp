@@ -0,0 +1,194 @@
+#include "../include/MultiAsset.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+constexpr size_t kMaxAssets = 1 << 16;
+constexpr size_t kBarBlock = 256;       // bars per noise chunk
+constexpr size_t kRowBlock = 64;        // rows of L per pass over a chunk
+
+uint64_t mix(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Standard normals n of bar t, Box-Muller on counter-hashed uniforms
+void normals(uint64_t seed, size_t t, double* out, size_t n) {
+    const double two_pi = 6.283185307179586;
+    const uint64_t base = mix(seed ^ mix((uint64_t)t * 0x9E3779B97F4A7C15ull));
+    for (size_t i = 0; i < n; i += 2) {
+        double u = ((mix(base + i) >> 11) + 1) * 0x1.0p-53;     // (0, 1]
+        double v = (mix(base + i + 1) >> 11) * 0x1.0p-53;
+        double r = std::sqrt(-2.0 * std::log(u));
+        out[i] = r * std::cos(two_pi * v);
+        if (i + 1 < n) out[i + 1] = r * std::sin(two_pi * v);
+    }
+}
+
+// Four running sums, so the loop pipelines; fixed order, same result
+// on every thread
+double dot(const double* a, const double* b, size_t n) {
+    double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        s0 += a[i] * b[i];
+        s1 += a[i + 1] * b[i + 1];
+        s2 += a[i + 2] * b[i + 2];
+        s3 += a[i + 3] * b[i + 3];
+    }
+    for (; i < n; i++) s0 += a[i] * b[i];
+    return (s0 + s1) + (s2 + s3);
+}
+
+size_t packed(size_t i) { return i * (i + 1) / 2; }
+
+int threadCount(int threads) {
+    return threads > 0 ? threads : (int)std::max(1u, std::thread::hardware_concurrency());
+}
+
+} // namespace
+
+MultiAssetMarket::MultiAssetMarket(MultiAssetConfig cfg) : config(std::move(cfg)), bars_(0) {
+    const size_t n = config.assets;
+    if (n < 1 || n > kMaxAssets)
+        throw std::invalid_argument("assets: 1 to " + std::to_string(kMaxAssets));
+    if (config.timesteps < 1) throw std::invalid_argument("timesteps: at least 1");
+    if (config.market == "Agents")
+        throw std::invalid_argument("An agent-based market has one asset");
+    if (StochasticModel::isModel(config.market))
+        throw std::invalid_argument("Model markets are single-asset");
+
+    if (config.correlation.empty()) {
+        if (!(config.rho >= 0.0 && config.rho < 1.0))
+            throw std::invalid_argument("rho: 0 to below 1");
+        return;
+    }
+    if (config.correlation.size() != n * n)
+        throw std::invalid_argument("correlation: assets x assets values");
+
+    // Cholesky into the packed lower triangle
+    const std::vector<double>& c = config.correlation;
+    chol.assign(packed(n), 0.0);
+    for (size_t i = 0; i < n; i++) {
+        double* li = chol.data() + packed(i);
+        for (size_t j = 0; j <= i; j++) {
+            if (std::fabs(c[i * n + j] - c[j * n + i]) > 1e-12)
+                throw std::invalid_argument("correlation is not symmetric");
+            const double* lj = chol.data() + packed(j);
+            double s = c[i * n + j] - dot(li, lj, j);
+            if (i == j) {
+                if (!(s > 0.0)) throw std::invalid_argument("correlation is not positive definite");
+                li[i] = std::sqrt(s);
+            } else {
+                li[j] = s / lj[j];
+            }
+        }
+    }
+}
+
+void MultiAssetMarket::generate() {
+    const size_t n = config.assets;
+    bars_ = (size_t)config.timesteps;
+    Series<double>().swap(data);
+    data.resize(n * bars_);
+
+    // Noise: chunks of bars are independent
+    const int workers = threadCount(config.threads);
+    const size_t chunks = (bars_ + kBarBlock - 1) / kBarBlock;
+    std::atomic<size_t> next{0};
+    auto noise = [&] {
+        Series<double> z, e;
+        for (size_t c; (c = next++) < chunks;)
+            noiseChunk(c * kBarBlock, std::min(bars_, (c + 1) * kBarBlock), z, e);
+    };
+    std::vector<std::thread> pool;
+    for (int w = 1; w < std::min<int>(workers, (int)chunks); w++) pool.emplace_back(noise);
+    noise();
+    for (auto& t : pool) t.join();
+    pool.clear();
+
+    // Prices: each asset's recursion runs along its bars
+    const size_t groups = std::max<size_t>(1, std::min<size_t>(workers, n / kRowBlock));
+    for (size_t g = 1; g < groups; g++)
+        pool.emplace_back([=] { recurse(n * g / groups, n * (g + 1) / groups); });
+    recurse(0, n / groups);
+    for (auto& t : pool) t.join();
+}
+
+// Scaled noise of bars [from, to) into their price slots
+void MultiAssetMarket::noiseChunk(size_t from, size_t to, Series<double>& z, Series<double>& e) {
+    const size_t n = config.assets;
+    const size_t count = to - from;
+    const double scale = marketDynamics(config.market).noise;
+    z.resize(count * (n + 1));
+    e.resize(count * n);
+    for (size_t b = 0; b < count; b++)
+        normals(config.seed, from + b, z.data() + b * (n + 1), n + 1);
+
+    if (!chol.empty()) {
+        // e_b = L z_b, a block of L rows against every bar of the chunk
+        for (size_t r = 0; r < n; r += kRowBlock) {
+            size_t r_end = std::min(n, r + kRowBlock);
+            for (size_t b = 0; b < count; b++) {
+                const double* zb = z.data() + b * (n + 1);
+                for (size_t i = r; i < r_end; i++)
+                    e[b * n + i] = dot(chol.data() + packed(i), zb, i + 1);
+            }
+        }
+    } else {
+        // one factor: the extra normal of each bar is shared
+        const double common = std::sqrt(config.rho), own = std::sqrt(1.0 - config.rho);
+        for (size_t b = 0; b < count; b++) {
+            const double* zb = z.data() + b * (n + 1);
+            for (size_t i = 0; i < n; i++) e[b * n + i] = common * zb[n] + own * zb[i];
+        }
+    }
+
+    for (size_t b = 0; b < count; b++) {
+        size_t t = from + b;
+        for (size_t i = 0; i < n; i++) {
+            size_t at = config.layout == AssetLayout::TIME_MAJOR ? t * n + i : i * bars_ + t;
+            data[at] = scale * e[b * n + i];
+        }
+    }
+}
+
+// Replace the noise of assets [first_asset, last_asset) by their prices
+void MultiAssetMarket::recurse(size_t first_asset, size_t last_asset) {
+    const MarketDynamics d = marketDynamics(config.market);
+    const size_t n = config.assets;
+    auto step = [&](double price, double noise) {
+        double next = price + d.drift + d.reversion * (d.mean - price) + noise;
+        return next > 0.0 ? next : 0.01;
+    };
+
+    if (config.layout == AssetLayout::TIME_MAJOR) {
+        for (size_t a = first_asset; a < last_asset; a++) data[a] = 100.0;
+        for (size_t t = 1; t < bars_; t++) {
+            double* row = data.data() + t * n;
+            const double* prev = row - n;
+            for (size_t a = first_asset; a < last_asset; a++) row[a] = step(prev[a], row[a]);
+        }
+    } else {
+        for (size_t a = first_asset; a < last_asset; a++) {
+            double* p = data.data() + a * bars_;
+            p[0] = 100.0;
+            for (size_t t = 1; t < bars_; t++) p[t] = step(p[t - 1], p[t]);
+        }
+    }
+}
+
+const double* MultiAssetMarket::crossSection(size_t t) const {
+    if (config.layout != AssetLayout::TIME_MAJOR || t >= bars_) return nullptr;
+    return data.data() + t * config.assets;
+}
+
+const double* MultiAssetMarket::series(size_t asset) const {
+    if (config.layout != AssetLayout::ASSET_MAJOR || asset >= config.assets) return nullptr;
+    return data.data() + asset * bars_;
+}
@@ -0,0 +1,343 @@
+#include "../include/OrderBook.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+constexpr size_t kMinWindow = 128;
+constexpr size_t kMaxWindow = size_t(1) << 26;
+constexpr size_t kMaxOrders = size_t(1) << 31;
+
+uint64_t mix(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Window start for a center: a multiple of 64, so bitmap words cover
+// whole words of ticks (also for negative ticks)
+int64_t windowStart(int64_t center, size_t size) {
+    return (center - (int64_t)(size / 2)) & ~int64_t(63);
+}
+
+}
+
+// ---------------------------------------------------------
+// Book
+// ---------------------------------------------------------
+
+OrderBook::OrderBook(int64_t center_tick, size_t window_ticks) {
+    if (window_ticks > kMaxWindow)
+        throw std::invalid_argument("Order book window: at most 2^26 ticks");
+    size = kMinWindow;
+    while (size < window_ticks) size <<= 1;
+    mask = size - 1;
+    lo = windowStart(center_tick, size);
+    levels.resize(size);
+    occupied.assign(size / 64, 0);
+}
+
+uint32_t OrderBook::allocate() {
+    if (free_head != kNil) {
+        uint32_t slot = free_head;
+        free_head = nodes[slot].next;
+        return slot;
+    }
+    if (nodes.size() >= kMaxOrders) throw std::runtime_error("Order book is full");
+    nodes.push_back(Node{0, 0, kNil, kNil, 1, Side::BUY});
+    return (uint32_t)(nodes.size() - 1);
+}
+
+// The slot's id goes stale: generations never repeat 0, the "no order" id
+void OrderBook::release(uint32_t slot) {
+    Node& n = nodes[slot];
+    n.qty = 0;
+    if (++n.generation == 0) n.generation = 1;
+    n.next = free_head;
+    free_head = slot;
+    live--;
+}
+
+int64_t OrderBook::scanDown(int64_t tick) const {
+    while (tick >= lo) {
+        size_t i = (size_t)tick & mask;
+        unsigned bit = (unsigned)(i & 63);
+        uint64_t w = occupied[i >> 6] & (~0ull >> (63 - bit));
+        if (w) return tick - bit + (63 - __builtin_clzll(w));
+        tick -= bit + 1;
+    }
+    return kNoPrice;
+}
+
+int64_t OrderBook::scanUp(int64_t tick) const {
+    const int64_t hi = lo + (int64_t)size;
+    while (tick < hi) {
+        size_t i = (size_t)tick & mask;
+        unsigned bit = (unsigned)(i & 63);
+        uint64_t w = occupied[i >> 6] & (~0ull << bit);
+        if (w) return tick - bit + __builtin_ctzll(w);
+        tick += 64 - bit;
+    }
+    return kNoPrice;
+}
+
+// The book is never crossed, so below the best bid there are only bids
+// and above the best ask only asks
+void OrderBook::unlink(uint32_t slot) {
+    Node& n = nodes[slot];
+    Level& l = level(n.tick);
+    if (n.prev != kNil) nodes[n.prev].next = n.next;
+    else l.head = n.next;
+    if (n.next != kNil) nodes[n.next].prev = n.prev;
+    else l.tail = n.prev;
+    l.qty -= n.qty;
+    if (l.head != kNil) return;
+
+    size_t i = (size_t)n.tick & mask;
+    occupied[i >> 6] &= ~(1ull << (i & 63));
+    if (n.tick == bid) bid = scanDown(n.tick - 1);
+    else if (n.tick == ask) ask = scanUp(n.tick + 1);
+}
+
+// Fill qty against the other side, best level first, oldest order first
+void OrderBook::take(Side side, int64_t limit_tick, int64_t& qty, Execution& e) {
+    const bool buy = side == Side::BUY;
+    while (qty > 0) {
+        int64_t best = buy ? ask : bid;
+        if (best == kNoPrice || (buy ? best > limit_tick : best < limit_tick)) return;
+        Level& l = level(best);
+        while (qty > 0 && l.head != kNil) {
+            uint32_t slot = l.head;
+            Node& n = nodes[slot];
+            int64_t f = std::min(qty, n.qty);
+            n.qty -= f;
+            l.qty -= f;
+            qty -= f;
+            e.qty += f;
+            e.notional += best * f;
+            e.fills++;
+            counts.fills++;
+            counts.volume += (uint64_t)f;
+            if (n.qty > 0) break;
+            l.head = n.next;
+            if (l.head != kNil) nodes[l.head].prev = kNil;
+            else l.tail = kNil;
+            release(slot);
+        }
+        if (l.head != kNil) return;
+        size_t i = (size_t)best & mask;
+        occupied[i >> 6] &= ~(1ull << (i & 63));
+        if (buy) ask = scanUp(best + 1);
+        else bid = scanDown(best - 1);
+    }
+}
+
+OrderBook::OrderId OrderBook::limit(Side side, int64_t tick, int64_t qty, Execution* taken) {
+    if (qty <= 0 || !inWindow(tick)) {
+        counts.rejects++;
+        return kNoOrder;
+    }
+    Execution e;
+    take(side, tick, qty, e);
+    if (taken) *taken = e;
+    if (qty == 0) return kNoOrder;
+
+    uint32_t slot = allocate();
+    Node& n = nodes[slot];
+    Level& l = level(tick);
+    n.tick = tick;
+    n.qty = qty;
+    n.side = side;
+    n.prev = l.tail;
+    n.next = kNil;
+    if (l.tail != kNil) nodes[l.tail].next = slot;
+    else l.head = slot;
+    l.tail = slot;
+    l.qty += qty;
+    size_t i = (size_t)tick & mask;
+    occupied[i >> 6] |= 1ull << (i & 63);
+    if (side == Side::BUY) {
+        if (bid == kNoPrice || tick > bid) bid = tick;
+    } else {
+        if (ask == kNoPrice || tick < ask) ask = tick;
+    }
+    live++;
+    counts.adds++;
+    return ((OrderId)n.generation << 32) | slot;
+}
+
+OrderBook::Execution OrderBook::market(Side side, int64_t qty) {
+    Execution e;
+    if (qty > 0) take(side, side == Side::BUY ? INT64_MAX : INT64_MIN + 1, qty, e);
+    return e;
+}
+
+OrderBook::Execution OrderBook::ioc(Side side, int64_t tick, int64_t qty) {
+    Execution e;
+    if (qty > 0) take(side, tick, qty, e);
+    return e;
+}
+
+bool OrderBook::cancel(OrderId id) {
+    uint32_t slot = (uint32_t)id;
+    if (slot >= nodes.size() || nodes[slot].generation != (uint32_t)(id >> 32) ||
+        nodes[slot].qty == 0)
+        return false;
+    unlink(slot);
+    release(slot);
+    counts.cancels++;
+    return true;
+}
+
+int64_t OrderBook::depth(int64_t tick) const {
+    return inWindow(tick) ? level(tick).qty : 0;
+}
+
+void OrderBook::evict(int64_t from, int64_t to) {
+    for (int64_t t = scanUp(from); t != kNoPrice && t < to; t = scanUp(t + 1)) {
+        Level& l = level(t);
+        for (uint32_t slot = l.head; slot != kNil;) {
+            uint32_t next = nodes[slot].next;
+            release(slot);
+            counts.evicted++;
+            slot = next;
+        }
+        l = Level();
+        size_t i = (size_t)t & mask;
+        occupied[i >> 6] &= ~(1ull << (i & 63));
+    }
+}
+
+void OrderBook::recenter(int64_t tick) {
+    const int64_t to = windowStart(tick, size);
+    if (to == lo) return;
+    const int64_t end = lo + (int64_t)size;
+    if (to > lo) evict(lo, std::min(to, end));
+    else evict(std::max(to + (int64_t)size, lo), end);
+    lo = to;
+    // what is left of each side is its part of the old window inside the new one
+    const int64_t hi = lo + (int64_t)size;
+    if (bid != kNoPrice) bid = bid < lo ? kNoPrice : scanDown(std::min(bid, hi - 1));
+    if (ask != kNoPrice) ask = ask >= hi ? kNoPrice : scanUp(std::max(ask, lo));
+}
+
+// window | pool | free list. Levels, bitmap and best prices follow from
+// the resting orders and their links.
+void OrderBook::save(CheckpointWriter& out) const {
+    out.value((uint64_t)size);
+    out.value(lo);
+    out.values(nodes.data(), nodes.size());
+    out.value(free_head);
+    out.value(counts);
+}
+
+void OrderBook::restore(CheckpointReader& in) {
+    size_t window = (size_t)in.value<uint64_t>();
+    if (window < kMinWindow || window > kMaxWindow || (window & (window - 1)))
+        throw std::runtime_error("Corrupt checkpoint");
+    size = window;
+    mask = size - 1;
+    lo = in.value<int64_t>();
+    nodes.resize(in.count(kMaxOrders));
+    in.values(nodes.data(), nodes.size());
+    free_head = in.value<uint32_t>();
+    counts = in.value<Stats>();
+    if ((lo & 63) != 0 || (free_head != kNil && free_head >= nodes.size()))
+        throw std::runtime_error("Corrupt checkpoint");
+    rebuild();
+}
+
+void OrderBook::rebuild() {
+    levels.assign(size, Level());
+    occupied.assign(size / 64, 0);
+    live = 0;
+    bid = ask = kNoPrice;
+    const uint32_t count = (uint32_t)nodes.size();
+    for (uint32_t slot = 0; slot < count; slot++) {
+        const Node& n = nodes[slot];
+        if (n.qty == 0) continue;
+        if (n.qty < 0 || !inWindow(n.tick) || n.generation == 0 ||
+            (n.prev != kNil && n.prev >= count) || (n.next != kNil && n.next >= count))
+            throw std::runtime_error("Corrupt checkpoint");
+        Level& l = level(n.tick);
+        if (n.prev == kNil) l.head = slot;
+        if (n.next == kNil) l.tail = slot;
+        l.qty += n.qty;
+        size_t i = (size_t)n.tick & mask;
+        occupied[i >> 6] |= 1ull << (i & 63);
+        if (n.side == Side::BUY) bid = std::max(bid, n.tick);
+        else if (ask == kNoPrice || n.tick < ask) ask = n.tick;
+        live++;
+    }
+    if (bid != kNoPrice && ask != kNoPrice && bid >= ask)
+        throw std::runtime_error("Corrupt checkpoint");
+}
+
+// ---------------------------------------------------------
+// Order flow
+// ---------------------------------------------------------
+
+OrderFlow::OrderFlow(const MarketDynamics& dynamics, uint64_t seed, OrderFlowOptions options)
+    : dynamics(dynamics), seed(seed), options(options) {
+    if (options.events_per_bar < 1 || options.max_qty < 1 || options.depth < 1 ||
+        !(options.market_share >= 0.0 && options.market_share <= 1.0))
+        throw std::invalid_argument("Order flow: events_per_bar, max_qty and depth at least 1, "
+                                    "market_share in [0, 1]");
+    resting.reserve(options.depth * 2);
+}
+
+void OrderFlow::bar(OrderBook& book, size_t t, double price) {
+    const int64_t center = std::llround(price / kBookTick);
+    book.recenter(center);
+    book.ioc(Side::SELL, center + 1, INT64_MAX);
+    book.ioc(Side::BUY, center - 1, INT64_MAX);
+
+    // Quotes spread over two bar sigmas each side; market orders lean
+    // with the expected move of the bar
+    const double noise = std::max(dynamics.noise, kBookTick);
+    const uint64_t width = (uint64_t)std::max(2.0, 2.0 * noise / kBookTick);
+    const double move = dynamics.drift + dynamics.reversion * (dynamics.mean - price);
+    const double buy_share = 0.5 + 0.4 * std::tanh(move / noise);
+    const uint64_t market_below = (uint64_t)(options.market_share * 0x1.0p53);
+    const uint64_t buy_below = (uint64_t)(buy_share * 0x1.0p53);
+    const uint64_t qty_range = (uint64_t)options.max_qty;
+
+    const uint64_t base = mix(seed ^ mix((uint64_t)t * 0x9E3779B97F4A7C15ull));
+    for (int e = 0; e < options.events_per_bar; e++) {
+        const uint64_t r = mix(base + (uint64_t)e);
+        const uint64_t s = mix(r);
+        const int64_t qty = 1 + (int64_t)((s & 0xFFFF) % qty_range);
+        if ((r >> 11) < market_below) {
+            book.market((s >> 11) < buy_below ? Side::BUY : Side::SELL, qty);
+            continue;
+        }
+        // cancels take over as the resting orders reach the depth
+        uint64_t fill = std::min<uint64_t>(resting.size(), options.depth);
+        if (((r >> 16) & 0xFFFF) * options.depth < fill * 0x8000) {
+            size_t i = (size_t)((s >> 20) % resting.size());
+            book.cancel(resting[i]);
+            resting[i] = resting.back();
+            resting.pop_back();
+            continue;
+        }
+        const Side side = (r & 1) ? Side::BUY : Side::SELL;
+        const int64_t offset = (int64_t)((s >> 32) % width);
+        OrderBook::OrderId id =
+            book.limit(side, side == Side::BUY ? center - offset : center + offset, qty);
+        if (id != OrderBook::kNoOrder) resting.push_back(id);
+    }
+    count += (uint64_t)options.events_per_bar;
+}
+
+// events | ids placed
+void OrderFlow::save(CheckpointWriter& out) const {
+    out.value(count);
+    out.values(resting.data(), resting.size());
+}
+
+void OrderFlow::restore(CheckpointReader& in) {
+    count = in.value<uint64_t>();
+    resting.resize(in.count(kMaxOrders));
+    in.values(resting.data(), resting.size());
+}
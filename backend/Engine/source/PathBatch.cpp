@@ -0,0 +1,237 @@
+#include "../include/PathBatch.hpp"
+#include "../include/Backtest.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+constexpr size_t L = kPathLanes;
+
+// Run a double-output lane kernel over bars [from, to) of a column.
+// float32 columns go through a small block narrowed on store, as in
+// MarketSimulator's fillColumn.
+template <typename Kernel>
+void fillRows(SignalColumn& col, size_t from, size_t to, Kernel kernel) {
+    if (from >= to) return;
+    if (!col.isSingle()) {
+        kernel(col.f64() + from * L, from, to);
+        return;
+    }
+    const size_t block = 128;
+    double buf[block * L];
+    for (size_t b = from; b < to; b += block) {
+        size_t e = std::min(to, b + block);
+        kernel(buf, b, e);
+        for (size_t i = 0; i < (e - b) * L; i++) col.set(b * L + i, buf[i]);
+    }
+}
+
+void checkStrategy(const Strategy& strategy) {
+    if (strategy.stop_loss != 0.0 || strategy.take_profit != 0.0 ||
+        strategy.execution != Execution::CLOSE)
+        throw std::invalid_argument("Path blocks run close fills without stop loss or take profit");
+    for (const auto* side : {&strategy.buy, &strategy.sell})
+        for (const Condition& c : *side) {
+            if (c.timeframe != 1)
+                throw std::invalid_argument("Path blocks run rules on the base bars only");
+            if (c.cross != CrossSection::NONE)
+                throw std::invalid_argument("Cross-sectional rules need a portfolio of assets");
+            if (c.lhs == SignalType::PRICE ||
+                (c.rhs_type == OperandType::SIGNAL && c.rhs_signal == SignalType::PRICE))
+                throw std::invalid_argument("Strategy references a signal that is not computed");
+        }
+}
+
+} // namespace
+
+PathBlock::PathBlock(const Config& cfg) : config(cfg) {
+    if (config.market == "Agents" || !config.prices_file.empty())
+        throw std::invalid_argument("Path blocks need generated paths: not Agents or a file");
+    model = StochasticModel::create(config.market, config.model);
+    count = config.timesteps > 0 ? (size_t)config.timesteps : 1;
+}
+
+void PathBlock::generate(const uint32_t* seeds, size_t n) {
+    if (n < 1 || n > L) throw std::invalid_argument("A path block holds 1 to 8 paths");
+    lanes = n;
+    price_rows.assign(count * L, 0.0);
+
+    if (model) {
+        uint64_t keys[L];
+        double price[L], state[L];
+        for (size_t l = 0; l < L; l++) {
+            keys[l] = StochasticModel::pathKey(seeds[std::min(l, n - 1)]);
+            price[l] = price_rows[l] = 100.0;
+            state[l] = model->initialState();
+        }
+        if (count > 1)
+            model->advance(keys, price, state, L, 0, count - 1, price_rows.data() + L, L);
+    } else {
+        for (size_t l = 0; l < L; l++) {
+            if (l >= n) {
+                for (size_t t = 0; t < count; t++)
+                    price_rows[t * L + l] = price_rows[t * L + n - 1];
+                continue;
+            }
+            Config cfg = config;
+            cfg.seed = seeds[l];
+            MarketSimulator sim(cfg);
+            sim.runMarket();
+            PriceSpan prices = sim.getPrices();
+            for (size_t t = 0; t < count; t++) price_rows[t * L + l] = prices[t];
+        }
+    }
+    indicate();
+}
+
+// computeAllSignals over the block, as MarketSimulator::fill computes
+// each indicator
+void PathBlock::indicate() {
+    const KernelTable& k = kernels();
+    const double* prices = price_rows.data();
+    const size_t n = count;
+    auto newColumn = [&](SignalType type) -> SignalColumn& {
+        SignalColumn& col = signals[type];
+        col.reset(n * L, config.precision);
+        return col;
+    };
+
+    const std::pair<SignalType, int> averages[] = {{SignalType::MA_SHORT, kMaShort},
+                                                   {SignalType::MA_LONG, kMaLong}};
+    for (const auto& ma : averages) {
+        const int w = ma.second;
+        fillRows(newColumn(ma.first), (size_t)w - 1, n, [&](double* out, size_t a, size_t b) {
+            k.laneMean(prices, out, a, b, w);
+        });
+    }
+
+    SignalColumn& rsi = newColumn(SignalType::RSI);
+    const int rw = kRsiPeriod;
+    if (n > (size_t)rw) {
+        // initial average gain/loss, then Wilder smoothing
+        double gain[L], loss[L];
+        for (size_t l = 0; l < L; l++) {
+            double g = 0.0, lo = 0.0;
+            for (int j = 1; j <= rw; j++) {
+                double diff = prices[j * L + l] - prices[(j - 1) * L + l];
+                if (diff >= 0)
+                    g += diff;
+                else
+                    lo -= diff;
+            }
+            gain[l] = g / rw;
+            loss[l] = lo / rw;
+            double rs = (loss[l] == 0) ? 0 : gain[l] / loss[l];
+            rsi.set(rw * L + l, 100.0 - (100.0 / (1.0 + rs)));
+        }
+        fillRows(rsi, (size_t)rw + 1, n, [&](double* out, size_t a, size_t b) {
+            k.laneRsi(prices, out, gain, loss, a, b, rw);
+        });
+    }
+
+    SignalColumn& vol = newColumn(SignalType::VOLATILITY);
+    const int vw = kVolatilityWindow;
+    if (n > (size_t)vw) {
+        Series<double> rets(n * L);
+        for (size_t i = L; i < n * L; i++) rets[i] = std::log(prices[i] / prices[i - L]);
+        fillRows(vol, (size_t)vw, n, [&](double* out, size_t a, size_t b) {
+            k.laneStd(rets.data(), out, a, b, vw);
+        });
+    }
+
+    // the kernel reads double; widen float32 volatility first
+    const int mw = kVolatilityMaWindow;
+    Series<double> widened;
+    const double* values = vol.f64();
+    if (vol.isSingle()) {
+        widened.resize(n * L);
+        for (size_t i = 0; i < n * L; i++) widened[i] = vol.get(i);
+        values = widened.data();
+    }
+    fillRows(newColumn(SignalType::VOLATILITY_MA), (size_t)mw - 1, n,
+             [&](double* out, size_t a, size_t b) { k.laneMean(values, out, a, b, mw); });
+}
+
+const SignalColumn& PathBlock::column(SignalType type) const {
+    auto it = signals.find(type);
+    if (it == signals.end()) throw std::runtime_error("Signal not computed");
+    return it->second;
+}
+
+// AND every rule of one side into one byte per bar from kFirstBar: bit l
+// = path l. The interleaved columns put bar t, path l at bit t * 8 + l of
+// the compare kernels' masks.
+void PathBlock::ruleMask(const std::vector<Condition>& rules, std::vector<uint8_t>& mask) const {
+    const size_t n = count > (size_t)kFirstBar ? count - kFirstBar : 0;
+    mask.assign(n, rules.empty() ? 0x00 : 0xFF);
+    if (n == 0) return;
+    const KernelTable& k = kernels();
+    const size_t at = (size_t)kFirstBar * L;
+    for (const Condition& c : rules) {
+        const SignalColumn& lhs = column(c.lhs);
+        const SignalColumn* rhs = c.rhs_type == OperandType::SIGNAL ? &column(c.rhs_signal)
+                                                                    : nullptr;
+        double value = rhs ? 0.0 : c.rhs_value;
+        if (lhs.isSingle())
+            k.compareF32(lhs.f32() + at, rhs ? rhs->f32() + at : nullptr, (float)value, c.op,
+                         mask.data(), n * L);
+        else
+            k.compareF64(lhs.f64() + at, rhs ? rhs->f64() + at : nullptr, value, c.op,
+                         mask.data(), n * L);
+    }
+}
+
+void PathBlock::backtest(const Strategy& strategy, PathMetrics* out) const {
+    checkStrategy(strategy);
+    std::vector<uint8_t> buy, sell;
+    ruleMask(strategy.buy, buy);
+    ruleMask(strategy.sell, sell);
+    LaneBook book;
+    if (!buy.empty())
+        kernels().laneBacktest(price_rows.data() + (size_t)kFirstBar * L, buy.data(), sell.data(),
+                               buy.size(), book);
+    for (size_t l = 0; l < lanes; l++) {
+        out[l].total_pnl = book.equity[l];
+        out[l].num_trades = (int)book.trades[l];
+        out[l].win_count = (int)book.wins[l];
+        out[l].max_drawdown = book.drawdown[l];
+    }
+}
+
+std::vector<PathMetrics> runPaths(const Config& cfg, const std::vector<Strategy>& strategies,
+                                  const std::vector<uint32_t>& seeds, int threads) {
+    PathBlock first(cfg);           // throws for the markets it cannot run
+    for (const Strategy& s : strategies) checkStrategy(s);
+    const size_t ns = strategies.size();
+    std::vector<PathMetrics> out(seeds.size() * ns);
+    const size_t blocks = (seeds.size() + L - 1) / L;
+    if (blocks == 0 || ns == 0) return out;
+
+    // Blocks are independent: each worker takes the next one
+    int n = threads > 0 ? threads : (int)std::max(1u, std::thread::hardware_concurrency());
+    n = (int)std::min<size_t>((size_t)n, blocks);
+    std::atomic<size_t> next{0};
+    auto work = [&](PathBlock& block) {
+        PathMetrics lanes[L];
+        for (size_t b; (b = next++) < blocks;) {
+            const size_t p = b * L;
+            block.generate(seeds.data() + p, std::min(L, seeds.size() - p));
+            for (size_t s = 0; s < ns; s++) {
+                block.backtest(strategies[s], lanes);
+                for (size_t l = 0; l < block.paths(); l++) out[(p + l) * ns + s] = lanes[l];
+            }
+        }
+    };
+    std::vector<std::thread> workers;
+    for (int w = 1; w < n; w++)
+        workers.emplace_back([&] {
+            PathBlock block(cfg);
+            work(block);
+        });
+    work(first);
+    for (auto& t : workers) t.join();
+    return out;
+}
@@ -0,0 +1,166 @@
+#include "../include/PathLibrary.hpp"
+#include "../include/Request.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+constexpr uint32_t kLibraryVersion = 1;
+constexpr uint64_t kPathAlignment = 4096;
+
+struct Header {
+    char magic[4];
+    uint32_t version;
+    uint32_t paths;
+    uint32_t reserved;
+};
+
+struct Entry {
+    char market[16];
+    uint32_t seed;
+    uint32_t reserved;
+    uint64_t bars;
+    uint64_t offset;
+};
+
+std::string pathKey(const std::string& market, uint32_t seed) {
+    return market + '|' + std::to_string(seed);
+}
+
+std::mutex installed_mu;
+std::shared_ptr<const PathLibrary> installed_library;
+
+// A path of a library, which it keeps mapped
+class LibraryPath : public PriceSource {
+public:
+    LibraryPath(std::shared_ptr<const PathLibrary> library, PathLibrary::Path path)
+        : library(std::move(library)) {
+        span = {path.prices, path.bars};
+    }
+    bool simulated() const override { return true; }
+
+private:
+    std::shared_ptr<const PathLibrary> library;
+};
+
+} // namespace
+
+PathLibrary::PathLibrary(const std::string& path) : file(path) {
+    Header h;
+    if (file.size() < sizeof(h)) throw std::runtime_error("Not a path library: " + path);
+    std::memcpy(&h, file.data(), sizeof(h));
+    if (std::memcmp(h.magic, "AXPL", 4) != 0 || h.version != kLibraryVersion)
+        throw std::runtime_error("Not a path library: " + path);
+    if ((file.size() - sizeof(h)) / sizeof(Entry) < h.paths)
+        throw std::runtime_error("Truncated path library: " + path);
+
+    for (uint32_t i = 0; i < h.paths; i++) {
+        Entry e;
+        std::memcpy(&e, file.data() + sizeof(h) + i * sizeof(Entry), sizeof(e));
+        if (e.offset % kPathAlignment != 0 || e.offset > file.size() ||
+            e.bars > (file.size() - e.offset) / sizeof(double))
+            throw std::runtime_error("Truncated path library: " + path);
+        std::string market(e.market, std::find(e.market, e.market + sizeof(e.market), '\0'));
+        index[pathKey(market, e.seed)] = {
+            reinterpret_cast<const double*>(file.data() + e.offset), (size_t)e.bars};
+    }
+}
+
+PathLibrary::Path PathLibrary::find(const std::string& market, uint32_t seed, size_t bars) const {
+    auto it = index.find(pathKey(market, seed));
+    if (it == index.end() || it->second.bars < bars) return {};
+    return it->second;
+}
+
+uint64_t PathLibrary::generate(const std::string& path, const std::vector<std::string>& markets,
+                               const std::vector<uint32_t>& seeds, int timesteps, int threads) {
+    if (markets.empty() || seeds.empty() || timesteps < 1)
+        throw std::invalid_argument("A library needs markets, seeds and timesteps");
+
+    // Layout first: header, index, then one aligned column per path
+    std::vector<Config> configs;
+    std::vector<Entry> entries;
+    uint64_t table = sizeof(Header) + markets.size() * seeds.size() * sizeof(Entry);
+    uint64_t offset = (table + kPathAlignment - 1) / kPathAlignment * kPathAlignment;
+    uint64_t column = (uint64_t)timesteps * sizeof(double);
+    for (const std::string& name : markets) {
+        for (uint32_t seed : seeds) {
+            Config cfg;
+            cfg.market = marketFromString(name);
+            cfg.timesteps = timesteps;
+            cfg.seed = seed;
+            configs.push_back(cfg);
+
+            Entry e = {};
+            std::strncpy(e.market, cfg.market.c_str(), sizeof(e.market) - 1);
+            e.seed = seed;
+            e.bars = (uint64_t)timesteps;
+            e.offset = offset;
+            entries.push_back(e);
+            offset += (column + kPathAlignment - 1) / kPathAlignment * kPathAlignment;
+        }
+    }
+
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        Header h = {{'A', 'X', 'P', 'L'}, kLibraryVersion, (uint32_t)entries.size(), 0};
+        out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        out.write(reinterpret_cast<const char*>(entries.data()),
+                  (std::streamsize)(entries.size() * sizeof(Entry)));
+        if (!out) throw std::runtime_error("Cannot write " + path);
+    }
+
+    // Paths are independent: each worker generates whole paths and writes
+    // them at their offsets through its own stream
+    int n = threads > 0 ? threads : (int)std::max(1u, std::thread::hardware_concurrency());
+    n = std::min<int>(n, (int)configs.size());
+    std::atomic<size_t> next{0};
+    std::atomic<bool> failed{false};
+    std::vector<std::thread> workers;
+    for (int w = 0; w < n; w++) {
+        workers.emplace_back([&] {
+            std::fstream out(path, std::ios::in | std::ios::out | std::ios::binary);
+            for (size_t i; !failed && (i = next++) < configs.size();) {
+                MarketSimulator sim(configs[i]);
+                sim.runMarket();
+                PriceSpan prices = sim.getPrices();
+                out.seekp((std::streamoff)entries[i].offset);
+                out.write(reinterpret_cast<const char*>(prices.data()),
+                          (std::streamsize)(prices.size() * sizeof(double)));
+                if (!out) failed = true;
+            }
+        });
+    }
+    for (auto& t : workers) t.join();
+    if (failed) throw std::runtime_error("Cannot write " + path);
+    return entries.back().offset + column;
+}
+
+void PathLibrary::install(std::shared_ptr<const PathLibrary> library) {
+    std::lock_guard<std::mutex> lock(installed_mu);
+    installed_library = std::move(library);
+}
+
+std::shared_ptr<const PathLibrary> PathLibrary::installed() {
+    std::lock_guard<std::mutex> lock(installed_mu);
+    return installed_library;
+}
+
+bool useLibraryPrices(MarketSimulator& sim) {
+    auto library = PathLibrary::installed();
+    if (!library) return false;
+    const Config& cfg = sim.getConfig();
+    Config generated = cfg;     // libraries hold the default model parameters
+    generated.model = ModelParams();
+    if (modelKey(cfg) != modelKey(generated)) return false;
+    PathLibrary::Path p = library->find(cfg.market, cfg.seed,
+                                        cfg.timesteps > 0 ? (size_t)cfg.timesteps : 1);
+    if (!p.prices) return false;
+    sim.usePrices(std::make_shared<LibraryPath>(std::move(library), p));
+    return true;
+}
@@ -0,0 +1,269 @@
+#include "../include/Pipeline.hpp"
+#include "../include/JsonWriter.hpp"
+#include "../include/PathLibrary.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+static std::shared_ptr<MarketSimulator> prepare(const Config& cfg) {
+    auto sim = std::make_shared<MarketSimulator>(cfg);
+    if (!cfg.prices_file.empty())
+        sim->usePrices(loadPrices(cfg.prices_file, cfg.prices_column));
+    else
+        useLibraryPrices(*sim); // pre-generated, when the library has them
+    sim->extendMarket(1);
+    computeAllSignals(*sim);    // registers the indicators, filled per chunk
+    return sim;
+}
+
+Pipeline::Pipeline(const Request& req, size_t chunk_bars)
+    : sim(prepare(req.config)),
+      chunk(std::max<size_t>(chunk_bars, 1)),
+      total(std::max(sim->getConfig().timesteps, 1)) {
+    addStrategy(req.strategy);
+}
+
+size_t Pipeline::addStrategy(const Strategy& strategy) {
+    strategy.addTimeframes(*sim);
+    backtests.emplace_back(*sim, strategy);
+    backtests.back().advance(bars);
+    return backtests.size() - 1;
+}
+
+std::pair<size_t, size_t> Pipeline::step() {
+    size_t from = bars;
+    size_t to = std::min(total, bars + chunk);
+    sim->extendMarket(to);
+    sim->extendSignals();
+    for (Backtester& b : backtests) b.advance(to);
+    bars = to;
+    if (save_every > 0 && bars - saved_at >= save_every) saveCheckpoint();
+    return {from, to};
+}
+
+RunStatus Pipeline::run(const CancelToken* token) {
+    while (!done()) {
+        if (token) {
+            RunStatus s = token->check();
+            if (s != RunStatus::COMPLETED) return s;
+        }
+        step();
+    }
+    return RunStatus::COMPLETED;
+}
+
+// ---------------------------------------------------------
+// CHECKPOINTS
+// ---------------------------------------------------------
+
+constexpr uint32_t kCheckpointVersion = 3;
+
+// What must match for a snapshot to continue this run: marketKey
+// without the timesteps, which a resumed run may raise
+static std::string runKey(const Config& cfg) {
+    std::string key = cfg.market;
+    key += '|';
+    key += std::to_string(cfg.seed);
+    key += cfg.precision == SignalPrecision::F32 ? "|f32" : "|f64";
+    if (!cfg.prices_file.empty()) key += "|file:" + cfg.prices_column + ':' + cfg.prices_file;
+    key += modelKey(cfg);
+    return key;
+}
+
+void Pipeline::checkpoint(std::ostream& out) const {
+    CheckpointWriter w(out);
+    w.raw("AXCP", 4);
+    w.value(kCheckpointVersion);
+    w.text(runKey(sim->getConfig()));
+    w.value((uint32_t)backtests.size());
+    for (const Backtester& b : backtests) w.text(rulesKey(b.rules()));
+    sim->save(w);
+    for (const Backtester& b : backtests) b.save(w);
+}
+
+void Pipeline::restore(std::istream& in) {
+    CheckpointReader r(in);
+    char magic[4];
+    r.raw(magic, 4);
+    if (std::memcmp(magic, "AXCP", 4) != 0 || r.value<uint32_t>() != kCheckpointVersion)
+        throw std::invalid_argument("Not a checkpoint of this engine");
+    if (r.text() != runKey(sim->getConfig()))
+        throw std::invalid_argument("Checkpoint is for another market, seed or precision");
+    if (r.value<uint32_t>() != backtests.size())
+        throw std::invalid_argument("Checkpoint is for other strategies");
+    for (const Backtester& b : backtests)
+        if (r.text(1 << 20) != rulesKey(b.rules()))
+            throw std::invalid_argument("Checkpoint is for other strategies");
+
+    sim->restore(r);
+    if (sim->bars() > total)
+        throw std::invalid_argument("timesteps is below the checkpoint's bars");
+    for (Backtester& b : backtests) b.restore(r);
+    bars = first = saved_at = sim->bars();
+}
+
+void Pipeline::checkpointTo(const std::string& path, size_t every_bars) {
+    save_path = path;
+    save_every = path.empty() ? 0 : every_bars;
+    saved_at = bars;
+}
+
+void Pipeline::saveCheckpoint() {
+    if (save_path.empty()) return;
+    std::string tmp = save_path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (out) checkpoint(out);
+        if (!out.flush()) throw std::runtime_error("Cannot write checkpoint " + tmp);
+    }
+#ifdef _WIN32
+    std::remove(save_path.c_str());     // rename() does not replace there
+#endif
+    if (std::rename(tmp.c_str(), save_path.c_str()) != 0)
+        throw std::runtime_error("Cannot write checkpoint " + save_path);
+    saved_at = bars;
+}
+
+// ---------------------------------------------------------
+// OUTPUT
+// ---------------------------------------------------------
+
+void NdjsonRun::next(std::string& line) {
+    const auto& prices = pipeline.simulator().getPrices();
+    const size_t origin = pipeline.simulator().origin();
+    const BacktestResult& res = pipeline.backtester().result();
+    line.clear();
+
+    if (!pipeline.done() && token) stop = token->check();
+    if (!pipeline.done() && stop == RunStatus::COMPLETED) {
+        auto range = pipeline.step();
+        line += "{\"type\":\"chunk\",\"from\":";
+        appendNumber(line, (int64_t)range.first);
+        line += ",\"to\":";
+        appendNumber(line, (int64_t)range.second);
+        line += ",\"prices\":";
+        appendArray(line, prices.data() + (range.first - origin), range.second - range.first);
+        line += ",\"trades\":";
+        res.trades.appendJson(line, trades_sent, res.trades.size());
+        line += ",\"metrics\":";
+        appendMetricsJson(line, res);
+        line += "}\n";
+        trades_sent = res.trades.size();
+        return;
+    }
+
+    line += "{\"type\":\"done\",\"bars\":";
+    appendNumber(line, (int64_t)pipeline.simulator().bars());
+    line += ",\"status\":\"";
+    line += runStatusName(stop);
+    line += "\",\"metrics\":";
+    appendMetricsJson(line, res);
+    line += "}\n";
+    sent_done = true;
+}
+
+RunStatus streamNdjson(Pipeline& pipeline, const LineSink& sink,
+                       const CancelToken* token) {
+    NdjsonRun run(pipeline, token);
+    std::string line;
+    while (!run.finished()) {
+        run.next(line);
+        if (!sink(line)) return RunStatus::CANCELLED;
+    }
+    return run.status();
+}
+
+// Prices formatted per JsonRun step, about a chunk's worth of run time
+constexpr size_t kPriceBlock = size_t(1) << 16;
+
+// Same layout as appendResultJson
+void JsonRun::appendHead(std::string& out, size_t i) const {
+    out += "{\"metrics\":";
+    appendMetricsJson(out, pipeline.backtester(i).result());
+    out += ",\"prices\":[";
+}
+
+void JsonRun::appendTail(std::string& out, size_t i) const {
+    out += "],\"status\":\"";
+    out += runStatusName(stop);
+    out += "\",\"trades\":";
+    pipeline.backtester(i).result().trades.appendJson(out);
+    out += '}';
+}
+
+void JsonRun::step() {
+    // The body lists the bars from start() on (all of them unless resumed)
+    const MarketSimulator& sim = pipeline.simulator();
+    const double* prices = sim.getPrices().data() + (pipeline.start() - sim.origin());
+    const size_t count = sim.bars() - pipeline.start();
+    size_t n = pipeline.strategies();
+
+    switch (phase) {
+        case RUN:
+            if (token) stop = token->check();
+            if (stop == RunStatus::COMPLETED && !pipeline.done()) pipeline.step();
+            else phase = PRICES;
+            return;
+        case PRICES: {
+            // A lone strategy gets the prices straight into its body
+            if (outputs.empty()) outputs.resize(n);
+            std::string& text = n == 1 ? outputs[0] : prices_text;
+            if (written == 0) {
+                text.reserve(count * 20 + 256 +
+                             (n == 1 ? pipeline.backtester().result().trades.size() * 96 : 0));
+                if (n == 1) appendHead(text, 0);
+            }
+            size_t block = std::min(kPriceBlock, count - written);
+            appendElements(text, prices + written, block, written == 0);
+            written += block;
+            if (written < count) return;
+            if (n == 1) {
+                appendTail(outputs[0], 0);
+                phase = DONE;
+            } else {
+                phase = BODIES;
+            }
+            return;
+        }
+        case BODIES: {
+            std::string& out = outputs[bodies];
+            out.reserve(prices_text.size() + pipeline.backtester(bodies).result().trades.size() * 96 + 256);
+            appendHead(out, bodies);
+            out += prices_text;
+            appendTail(out, bodies);
+            if (++bodies == n) {
+                std::string().swap(prices_text);
+                phase = DONE;
+            }
+            return;
+        }
+        case DONE:
+            return;
+    }
+}
+
+size_t estimateMemory(const Request& req, bool streamed) {
+    size_t bars = req.config.timesteps > 0 ? (size_t)req.config.timesteps : 1;
+    size_t width = req.config.precision == SignalPrecision::F32 ? 4 : 8;
+    size_t per_bar = 8 + 5 * width + 8;     // price, 5 indicator columns, equity
+    if (!streamed) per_bar += 20;         // price text in the response
+    return bars * per_bar;
+}
+
+size_t estimateStrategyMemory(const Request& req) {
+    size_t bars = req.config.timesteps > 0 ? (size_t)req.config.timesteps : 1;
+    return bars * (8 + 20);
+}
+
+std::string simulateToJson(const Request& req, CancelToken* token) {
+    CancelToken local;
+    if (!token) token = &local;
+    if (req.timeout_ms > 0) token->setTimeout(req.timeout_ms);
+
+    Pipeline pipeline(req);
+    JsonRun run(pipeline, token);
+    while (!run.done()) run.step();
+    return std::move(run.output());
+}
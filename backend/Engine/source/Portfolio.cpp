@@ -0,0 +1,492 @@
+#include "../include/Portfolio.hpp"
+#include "../include/Barrier.hpp"
+#include "../include/Kernels.hpp"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+constexpr size_t kGroup = 64;               // assets per indicator / position task
+constexpr size_t kBlockValues = 1 << 17;    // bars x assets per block
+constexpr size_t kMinBlockBars = 64;        // at least the longest window
+constexpr size_t kMaxBlockBars = 4096;
+
+#if defined(__GNUC__) && !defined(__clang__)
+// GCC's -O2 cost model does not vectorize loops that need an alias
+// check or a scalar tail, which is every loop over a group of assets
+#define AXIOM_VECTORIZE __attribute__((optimize("vect-cost-model=dynamic", "no-trapping-math")))
+#else
+#define AXIOM_VECTORIZE
+#endif
+
+// Same comparison as the compare kernels
+inline bool matches(double l, double r, char op) {
+    if (op == '>') return l > r;
+    if (op == '<') return l < r;
+    if (op == '=') return std::abs(l - r) < 0.0001;
+    return false;
+}
+
+// m[a] &= lhs[a] op rhs[a] (rhs == nullptr: op c), one loop per op so
+// each vectorizes
+AXIOM_VECTORIZE void andCompare(const double* lhs, const double* rhs, double c, char op,
+                                uint8_t* m, size_t n) {
+    if (op == '>') {
+        if (rhs) for (size_t a = 0; a < n; a++) m[a] &= lhs[a] > rhs[a];
+        else for (size_t a = 0; a < n; a++) m[a] &= lhs[a] > c;
+    } else if (op == '<') {
+        if (rhs) for (size_t a = 0; a < n; a++) m[a] &= lhs[a] < rhs[a];
+        else for (size_t a = 0; a < n; a++) m[a] &= lhs[a] < c;
+    } else {
+        for (size_t a = 0; a < n; a++) m[a] &= matches(lhs[a], rhs ? rhs[a] : c, op);
+    }
+}
+
+// out[a] = mean of rows t-w+1 .. t at column a, for a in [a0, a1),
+// summed oldest first as rollingMean does
+AXIOM_VECTORIZE void windowMean(const double* rows, size_t stride, size_t t, int w,
+                size_t a0, size_t a1, double* out) {
+    for (size_t a = a0; a < a1; a++) out[a] = 0.0;
+    for (size_t i = t + 1 - w; i <= t; i++) {
+        const double* r = rows + i * stride;
+        for (size_t a = a0; a < a1; a++) out[a] += r[a];
+    }
+    for (size_t a = a0; a < a1; a++) out[a] /= w;
+}
+
+// out[a] = population std-dev of the same window, as rollingStd
+AXIOM_VECTORIZE void windowStd(const double* rows, size_t stride, size_t t, int w,
+               size_t a0, size_t a1, double* out) {
+    double sq[kGroup];
+    windowMean(rows, stride, t, w, a0, a1, out);
+    for (size_t a = a0; a < a1; a++) sq[a - a0] = 0.0;
+    for (size_t i = t + 1 - w; i <= t; i++) {
+        const double* r = rows + i * stride;
+        for (size_t a = a0; a < a1; a++) sq[a - a0] += (r[a] - out[a]) * (r[a] - out[a]);
+    }
+    for (size_t a = a0; a < a1; a++) out[a] = std::sqrt(sq[a - a0] / w);
+}
+
+// k-th highest of v[0 .. n), 1-based, counting repeats. Keeps the k
+// highest so far in a min-heap (or the n - k + 1 lowest in a max-heap),
+// so most values cost one comparison with the heap's top.
+double kthHighest(const double* v, size_t n, size_t k, Series<double>& heap) {
+    auto select = [&](size_t m, auto better) {
+        heap.assign(v, v + m);
+        std::make_heap(heap.begin(), heap.end(), better);
+        for (size_t a = m; a < n; a++)
+            if (better(v[a], heap.front())) {
+                std::pop_heap(heap.begin(), heap.end(), better);
+                heap.back() = v[a];
+                std::push_heap(heap.begin(), heap.end(), better);
+            }
+        return heap.front();
+    };
+    if (k <= n / 2) return select(k, std::greater<double>());
+    return select(n - k + 1, std::less<double>());
+}
+
+// m[a] &= rank(v[a]) op c, where rank(a) = 1 + #{b : v[b] > v[a]}. A
+// bound on the rank is a bound on the value: rank(a) < k + 1 exactly
+// when v[a] >= the k-th highest value.
+void andRank(const double* v, size_t n, char op, double c, Series<double>& scratch, uint8_t* m) {
+    auto none = [&] { std::fill(m, m + n, 0); };
+    if (std::isnan(c)) return none();
+
+    if (op == '<') {            // rank <= ceil(c) - 1
+        double k = std::ceil(c) - 1;
+        if (k >= (double)n) return;
+        if (k < 1) return none();
+        double d = kthHighest(v, n, (size_t)k, scratch);
+        for (size_t a = 0; a < n; a++) m[a] &= v[a] >= d;
+    } else if (op == '>') {     // rank >= floor(c) + 1
+        double k = std::floor(c);
+        if (k < 1) return;
+        if (k >= (double)n) return none();
+        double d = kthHighest(v, n, (size_t)k, scratch);
+        for (size_t a = 0; a < n; a++) m[a] &= v[a] < d;
+    } else if (op == '=') {     // rank == k: d(k) <= v < d(k - 1)
+        double k = std::round(c);
+        if (!(std::abs(k - c) < 0.0001) || k < 1 || k > (double)n) return none();
+        double d = kthHighest(v, n, (size_t)k, scratch);
+        double above = k > 1 ? kthHighest(v, n, (size_t)k - 1, scratch) : HUGE_VAL;
+        for (size_t a = 0; a < n; a++) m[a] &= v[a] >= d && v[a] < above;
+    } else {
+        none();
+    }
+}
+
+// m[a] &= zscore(v[a]) op c among the n values
+AXIOM_VECTORIZE void andZscore(const double* v, size_t n, char op, double c,
+                               Series<double>& scratch, uint8_t* m) {
+    // four running sums in a fixed order, so the sums pipeline
+    double s[4] = {0.0, 0.0, 0.0, 0.0};
+    size_t a = 0;
+    for (; a + 4 <= n; a += 4)
+        for (int i = 0; i < 4; i++) s[i] += v[a + i];
+    for (; a < n; a++) s[0] += v[a];
+    const double mean = ((s[0] + s[1]) + (s[2] + s[3])) / n;
+
+    double q[4] = {0.0, 0.0, 0.0, 0.0};
+    for (a = 0; a + 4 <= n; a += 4)
+        for (int i = 0; i < 4; i++) q[i] += (v[a + i] - mean) * (v[a + i] - mean);
+    for (; a < n; a++) q[0] += (v[a] - mean) * (v[a] - mean);
+    const double sd = std::sqrt(((q[0] + q[1]) + (q[2] + q[3])) / n);
+
+    scratch.resize(n);
+    double* z = scratch.data();
+    if (sd > 0.0)
+        for (a = 0; a < n; a++) z[a] = (v[a] - mean) / sd;
+    else
+        std::fill(z, z + n, 0.0);
+    andCompare(z, nullptr, c, op, m, n);
+}
+
+// One indicator for the bars of the current block, time-major, after
+// `history` rows of the previous block that windows on it reach back to
+struct Panel {
+    Series<double> values;
+    size_t history = 0;
+};
+
+class PortfolioRun {
+public:
+    PortfolioRun(const double* prices, size_t assets, size_t bars, const Strategy& strategy,
+                 const PortfolioOptions& options);
+    PortfolioResult run();
+
+private:
+    bool needs(SignalType s) const { return need[(int)s]; }
+    // Panel row of bar t (in the current block or its history)
+    double* row(Panel& p, size_t t) { return p.values.data() + (t + p.history - b0) * n; }
+    const double* signal(SignalType s, size_t t);
+
+    void indicators(size_t g);
+    void rules(size_t t, Series<double>& scratch);
+    void andRules(const std::vector<Condition>& side, size_t t, uint8_t* m,
+                  Series<double>& scratch);
+    void positions(size_t g);
+    void aggregate();
+
+    const double* p;
+    const size_t n, bars;
+    const Strategy& strategy;
+    const PortfolioOptions& options;
+    bool need[6] = {};
+    size_t groups, block;
+    size_t b0 = 0, b1 = 0;      // current block
+    size_t finished = 0;        // bars of the blocks aggregated so far
+    bool stop = false;
+
+    Panel ma_short, ma_long, rsi, returns, volatility, volatility_ma;
+    Series<double> gain, loss;                  // RSI state per asset
+    Series<uint8_t> buy, sell;                  // rule results of the block
+    Series<uint8_t> in_pos;
+    Series<double> entry;
+    Series<double> delta;                       // realized P&L per group x bar
+    Series<int64_t> held;                       // open positions per group x bar
+    double peak = 0.0;
+    PortfolioResult res;
+};
+
+PortfolioRun::PortfolioRun(const double* prices, size_t assets, size_t bars,
+                           const Strategy& strategy, const PortfolioOptions& options)
+    : p(prices), n(assets), bars(bars), strategy(strategy), options(options) {
+    for (const auto* side : {&strategy.buy, &strategy.sell})
+        for (const Condition& c : *side) {
+            need[(int)c.lhs] = true;
+            if (c.rhs_type == OperandType::SIGNAL) need[(int)c.rhs_signal] = true;
+        }
+    if (needs(SignalType::VOLATILITY_MA)) need[(int)SignalType::VOLATILITY] = true;
+
+    groups = (n + kGroup - 1) / kGroup;
+    block = std::min(kMaxBlockBars, std::max(kMinBlockBars, kBlockValues / n));
+
+    auto panel = [&](Panel& panel, SignalType s, size_t history) {
+        if (!needs(s)) return;
+        panel.history = history;
+        panel.values.assign((block + history) * n, 0.0);
+    };
+    panel(ma_short, SignalType::MA_SHORT, 0);
+    panel(ma_long, SignalType::MA_LONG, 0);
+    panel(rsi, SignalType::RSI, 0);
+    panel(returns, SignalType::VOLATILITY, kVolatilityWindow - 1);
+    panel(volatility, SignalType::VOLATILITY, kVolatilityMaWindow - 1);
+    panel(volatility_ma, SignalType::VOLATILITY_MA, 0);
+    if (needs(SignalType::RSI)) {
+        gain.assign(n, 0.0);
+        loss.assign(n, 0.0);
+    }
+    buy.assign(block * n, 0);
+    sell.assign(block * n, 0);
+    in_pos.assign(n, 0);
+    entry.assign(n, 0.0);
+    delta.assign(groups * block, 0.0);
+    held.assign(groups * block, 0);
+
+    res.assets = n;
+    res.asset_pnl.assign(n, 0.0);
+    res.asset_trades.assign(n, 0);
+    res.asset_wins.assign(n, 0);
+    if (bars > (size_t)kFirstBar) {
+        res.equity.resize(bars - kFirstBar);
+        res.open.resize(bars - kFirstBar);
+    }
+}
+
+const double* PortfolioRun::signal(SignalType s, size_t t) {
+    switch (s) {
+        case SignalType::MA_SHORT: return row(ma_short, t);
+        case SignalType::MA_LONG: return row(ma_long, t);
+        case SignalType::RSI: return row(rsi, t);
+        case SignalType::VOLATILITY: return row(volatility, t);
+        case SignalType::VOLATILITY_MA: return row(volatility_ma, t);
+        default: return p + t * n;
+    }
+}
+
+// Pass 1: indicators of assets [g * kGroup, ...) for the block, each as
+// MarketSimulator::fill computes it (0 before its first full window)
+AXIOM_VECTORIZE void PortfolioRun::indicators(size_t g) {
+    const size_t a0 = g * kGroup, a1 = std::min(n, a0 + kGroup);
+
+    // the previous block's last rows become this one's history
+    for (Panel* panel : {&returns, &volatility}) {
+        if (b0 == 0 || panel->values.empty()) continue;
+        for (size_t r = 0; r < panel->history; r++) {
+            double* to = panel->values.data() + r * n;
+            const double* from = panel->values.data() + (block + r) * n;
+            std::copy(from + a0, from + a1, to + a0);
+        }
+    }
+
+    const int w = kRsiPeriod;
+    for (size_t t = b0; t < b1; t++) {
+        const double* now = p + t * n;
+        if (needs(SignalType::MA_SHORT)) {
+            double* out = row(ma_short, t);
+            if (t >= (size_t)kMaShort - 1) windowMean(p, n, t, kMaShort, a0, a1, out);
+            else std::fill(out + a0, out + a1, 0.0);
+        }
+        if (needs(SignalType::MA_LONG)) {
+            double* out = row(ma_long, t);
+            if (t >= (size_t)kMaLong - 1) windowMean(p, n, t, kMaLong, a0, a1, out);
+            else std::fill(out + a0, out + a1, 0.0);
+        }
+
+        if (needs(SignalType::RSI)) {
+            double* out = row(rsi, t);
+            if (t < (size_t)w) {
+                std::fill(out + a0, out + a1, 0.0);
+            } else if (t == (size_t)w) {
+                // initial average gain/loss
+                for (size_t a = a0; a < a1; a++) {
+                    double up = 0.0, down = 0.0;
+                    for (int j = 1; j <= w; j++) {
+                        double diff = p[j * n + a] - p[(j - 1) * n + a];
+                        if (diff >= 0) up += diff;
+                        else down -= diff;
+                    }
+                    gain[a] = up / w;
+                    loss[a] = down / w;
+                }
+            } else {
+                // Wilder smoothing
+                const double* before = now - n;
+                for (size_t a = a0; a < a1; a++) {
+                    double diff = now[a] - before[a];
+                    double up = diff > 0 ? diff : 0;
+                    double down = diff < 0 ? -diff : 0;
+                    gain[a] = (gain[a] * (w - 1) + up) / w;
+                    loss[a] = (loss[a] * (w - 1) + down) / w;
+                }
+            }
+            if (t >= (size_t)w)
+                for (size_t a = a0; a < a1; a++) {
+                    // divide unconditionally, so the loop has no branch
+                    double rs = gain[a] / (loss[a] == 0 ? 1.0 : loss[a]);
+                    rs = (loss[a] == 0) ? 0 : rs;
+                    out[a] = 100.0 - (100.0 / (1.0 + rs));
+                }
+        }
+
+        if (needs(SignalType::VOLATILITY)) {
+            // std-dev of the last log returns
+            double* ret = row(returns, t);
+            if (t == 0) std::fill(ret + a0, ret + a1, 0.0);
+            else
+                for (size_t a = a0; a < a1; a++) ret[a] = std::log(now[a] / (now - n)[a]);
+            double* out = row(volatility, t);
+            if (t >= (size_t)kVolatilityWindow)
+                windowStd(returns.values.data(), n, t + returns.history - b0,
+                          kVolatilityWindow, a0, a1, out);
+            else std::fill(out + a0, out + a1, 0.0);
+        }
+        if (needs(SignalType::VOLATILITY_MA)) {
+            double* out = row(volatility_ma, t);
+            if (t >= (size_t)kVolatilityMaWindow - 1)
+                windowMean(volatility.values.data(), n, t + volatility.history - b0,
+                           kVolatilityMaWindow, a0, a1, out);
+            else std::fill(out + a0, out + a1, 0.0);
+        }
+    }
+}
+
+// Pass 2: both sides' rules for every asset at bar t
+void PortfolioRun::rules(size_t t, Series<double>& scratch) {
+    const size_t r = t - b0;
+    andRules(strategy.buy, t, buy.data() + r * n, scratch);
+    andRules(strategy.sell, t, sell.data() + r * n, scratch);
+}
+
+// Rules are ANDed; no rules = no signal
+void PortfolioRun::andRules(const std::vector<Condition>& side, size_t t, uint8_t* m,
+                            Series<double>& scratch) {
+    std::fill(m, m + n, side.empty() ? 0 : 1);
+    for (const Condition& c : side) {
+        const double* lhs = signal(c.lhs, t);
+        if (c.cross == CrossSection::RANK) {
+            andRank(lhs, n, c.op, c.rhs_value, scratch, m);
+        } else if (c.cross == CrossSection::ZSCORE) {
+            andZscore(lhs, n, c.op, c.rhs_value, scratch, m);
+        } else {
+            const double* rhs = nullptr;
+            if (c.rhs_type == OperandType::SIGNAL) rhs = signal(c.rhs_signal, t);
+            andCompare(lhs, rhs, c.rhs_value, c.op, m, n);
+        }
+    }
+}
+
+// Pass 3: positions of assets [g * kGroup, ...), the Backtester's state
+// machine per asset, with the group's realized P&L per bar
+AXIOM_VECTORIZE void PortfolioRun::positions(size_t g) {
+    const size_t a0 = g * kGroup, a1 = std::min(n, a0 + kGroup);
+    for (size_t t = std::max(b0, (size_t)kFirstBar); t < b1; t++) {
+        const size_t r = t - b0;
+        const double* now = p + t * n;
+        const uint8_t* buys = buy.data() + r * n;
+        const uint8_t* sells = sell.data() + r * n;
+        double realized = 0.0;
+        int64_t open = 0;
+        for (size_t a = a0; a < a1; a++) {
+            if (!in_pos[a] && buys[a]) {
+                in_pos[a] = 1;
+                entry[a] = now[a];
+            } else if (in_pos[a] && sells[a]) {
+                in_pos[a] = 0;
+                double pnl = now[a] - entry[a];
+                realized += pnl;
+                res.asset_pnl[a] += pnl;
+                res.asset_trades[a]++;
+                if (pnl > 0) res.asset_wins[a]++;
+            }
+            open += in_pos[a];
+        }
+        delta[g * block + r] = realized;
+        held[g * block + r] = open;
+    }
+}
+
+// Pass 4: aggregate equity of the block, summed over the groups in order
+void PortfolioRun::aggregate() {
+    const size_t from = std::max(b0, (size_t)kFirstBar);
+    if (from < b1) {
+        double equity = res.total_pnl;
+        for (size_t t = from; t < b1; t++) {
+            const size_t r = t - b0;
+            double realized = 0.0;
+            int64_t open = 0;
+            for (size_t g = 0; g < groups; g++) {
+                realized += delta[g * block + r];
+                open += held[g * block + r];
+            }
+            equity += realized;
+            res.equity[t - kFirstBar] = equity;
+            res.open[t - kFirstBar] = open;
+        }
+        res.total_pnl = equity;
+        double dd = kernels().maxDrawdown(res.equity.data() + (from - kFirstBar), b1 - from, peak);
+        res.max_drawdown = std::max(res.max_drawdown, dd);
+    }
+    finished = b1;
+
+    if (options.cancel && b1 < bars) {
+        res.status = options.cancel->check();
+        stop = res.status != RunStatus::COMPLETED;
+    }
+}
+
+PortfolioResult PortfolioRun::run() {
+    int workers = options.threads > 0 ? options.threads
+                                      : (int)std::max(1u, std::thread::hardware_concurrency());
+    workers = (int)std::min<size_t>(workers, std::max(groups, std::min(block, bars)));
+    Barrier barrier(workers);
+    std::vector<Series<double>> scratch(workers);
+
+    // Every worker takes every workers-th group / bar of each pass, so
+    // the passes need only a barrier between them
+    auto work = [&](int id) {
+        for (size_t start = 0; start < bars; start += block) {
+            if (id == 0) {
+                b0 = start;
+                b1 = std::min(bars, start + block);
+            }
+            barrier.wait();
+            if (stop) return;
+            for (size_t g = id; g < groups; g += workers) indicators(g);
+            barrier.wait();
+            for (size_t t = std::max(b0, (size_t)kFirstBar) + id; t < b1; t += workers)
+                rules(t, scratch[id]);
+            barrier.wait();
+            for (size_t g = id; g < groups; g += workers) positions(g);
+            barrier.wait();
+            if (id == 0) aggregate();
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int id = 1; id < workers; id++) pool.emplace_back(work, id);
+    work(0);
+    for (auto& t : pool) t.join();
+
+    // a stopped run covers the blocks it finished, not the one it was
+    // about to start when it saw the stop
+    size_t done = finished > (size_t)kFirstBar ? finished - kFirstBar : 0;
+    res.equity.resize(std::min(res.equity.size(), done));
+    res.open.resize(std::min(res.open.size(), done));
+    for (size_t a = 0; a < n; a++) {
+        res.num_trades += res.asset_trades[a];
+        res.win_count += res.asset_wins[a];
+    }
+    return std::move(res);
+}
+
+} // namespace
+
+PortfolioResult runPortfolio(const double* prices, size_t assets, size_t bars,
+                             const Strategy& strategy, const PortfolioOptions& options) {
+    if (!prices || assets < 1)
+        throw std::invalid_argument("A portfolio needs prices of at least one asset");
+    if (strategy.stop_loss != 0.0 || strategy.take_profit != 0.0)
+        throw std::invalid_argument("Portfolios do not support stop_loss / take_profit");
+    if (strategy.execution != Execution::CLOSE)
+        throw std::invalid_argument("Portfolios fill at the bar price");
+    for (const auto* side : {&strategy.buy, &strategy.sell})
+        for (const Condition& c : *side) {
+            if (c.timeframe != 1)
+                throw std::invalid_argument("Portfolios do not support timeframes");
+            if (c.cross != CrossSection::NONE && c.rhs_type != OperandType::CONSTANT)
+                throw std::invalid_argument("Cross-sectional rules compare against a constant");
+        }
+    return PortfolioRun(prices, assets, bars, strategy, options).run();
+}
+
+PortfolioResult runPortfolio(const MultiAssetMarket& market, const Strategy& strategy,
+                             const PortfolioOptions& options) {
+    if (market.getConfig().layout != AssetLayout::TIME_MAJOR)
+        throw std::invalid_argument("A portfolio runs on a TIME_MAJOR market");
+    if (market.bars() == 0) throw std::invalid_argument("Market not generated");
+    return runPortfolio(market.prices(), market.assets(), market.bars(), strategy, options);
+}
@@ -0,0 +1,87 @@
+#include "../include/PriceSeries.hpp"
+#include <stdexcept>
+
+void PriceSeries::reserve(size_t n) {
+    open.reserve(n);
+    high.reserve(n);
+    low.reserve(n);
+    close.reserve(n);
+    volume.reserve(n);
+}
+
+void PriceSeries::clear() {
+    open.clear();
+    high.clear();
+    low.clear();
+    close.clear();
+    volume.clear();
+}
+
+size_t Resampler::add(int k, const double* prices, size_t bars) {
+    if (k < 1) throw std::invalid_argument("A timeframe is at least one bar");
+    if (bars != done) throw std::invalid_argument("Resampler is at another bar");
+    Frame f;
+    f.size = k;
+    f.bars.reserve(bars / (size_t)k + 1);
+    for (size_t t = 0; t < bars; t++) f.tick(prices[t]);
+    list.push_back(std::move(f));
+    return list.size() - 1;
+}
+
+void Resampler::extend(const double* prices, size_t count) {
+    if (list.empty()) {
+        done += count;
+        return;
+    }
+    // one pass over the prices, every frame per price
+    for (size_t t = 0; t < count; t++) {
+        double p = prices[t];
+        for (Frame& f : list) f.tick(p);
+    }
+    done += count;
+}
+
+void Resampler::clear() {
+    list.clear();
+    done = 0;
+}
+
+// ---------------------------------------------------------
+// CHECKPOINTS
+// ---------------------------------------------------------
+// bars | frames: size, ticks, open/high/low/close in progress
+
+constexpr uint32_t kMaxFrames = 64;
+
+void Resampler::save(CheckpointWriter& out) const {
+    out.value((uint64_t)done);
+    out.value((uint32_t)list.size());
+    for (const Frame& f : list) {
+        out.value((int32_t)f.size);
+        out.value((int32_t)f.ticks);
+        out.value(f.o);
+        out.value(f.h);
+        out.value(f.l);
+        out.value(f.c);
+    }
+}
+
+void Resampler::restore(CheckpointReader& in) {
+    size_t bars = (size_t)in.value<uint64_t>();
+    uint32_t count = in.value<uint32_t>();
+    if (count > kMaxFrames) throw std::runtime_error("Corrupt checkpoint");
+    std::vector<Frame> restored(count);
+    for (Frame& f : restored) {
+        f.size = in.value<int32_t>();
+        f.ticks = in.value<int32_t>();
+        f.o = in.value<double>();
+        f.h = in.value<double>();
+        f.l = in.value<double>();
+        f.c = in.value<double>();
+        if (f.size < 1 || f.ticks < 0 || (size_t)f.ticks != bars % (size_t)f.size)
+            throw std::runtime_error("Corrupt checkpoint");
+        f.first = bars / (size_t)f.size;
+    }
+    list = std::move(restored);
+    done = bars;
+}
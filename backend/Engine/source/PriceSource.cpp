@@ -0,0 +1,282 @@
+#include "../include/PriceSource.hpp"
+#include "../include/MappedFile.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// ---------------------------------------------------------
+// 1. NUMBERS
+// ---------------------------------------------------------
+
+// Powers of ten that are exact doubles
+constexpr double kPow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// Decimal text [p, end) to a double, correctly rounded. Prices are short
+// decimals, so almost all of them take the fast path: the digits fit a
+// double exactly and so does the power of ten, and one multiply or
+// divide rounds once (Clinger). Anything else goes to strtod.
+bool parseNumber(const char* p, const char* end, double& out) {
+    while (p < end && (*p == ' ' || *p == '"')) p++;
+    while (end > p && (end[-1] == ' ' || end[-1] == '"')) end--;
+    if (p == end) return false;
+
+    const char* start = p;
+    bool neg = *p == '-';
+    if (*p == '-' || *p == '+') p++;
+
+    uint64_t mantissa = 0;
+    int digits = 0;         // significant digits in mantissa
+    int scale = 0;          // decimal places taken into mantissa
+    bool any = false, dot = false, exact = true;
+    for (; p < end; p++) {
+        char c = *p;
+        if (c >= '0' && c <= '9') {
+            any = true;
+            if (mantissa == 0 && c == '0') {
+                if (dot) scale++;
+                continue;
+            }
+            if (digits < 19) {
+                mantissa = mantissa * 10 + (uint64_t)(c - '0');
+                digits++;
+                if (dot) scale++;
+            } else {
+                exact = false;
+                if (!dot) scale--;
+            }
+        } else if (c == '.' && !dot) {
+            dot = true;
+        } else {
+            break;
+        }
+    }
+    if (!any) return false;
+
+    int exponent = 0;
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        const char* e = p + 1;
+        bool eneg = e < end && *e == '-';
+        if (e < end && (*e == '-' || *e == '+')) e++;
+        if (e == end || *e < '0' || *e > '9') return false;
+        for (; e < end && *e >= '0' && *e <= '9'; e++)
+            if (exponent < 100000) exponent = exponent * 10 + (*e - '0');
+        exponent = eneg ? -exponent : exponent;
+        p = e;
+    }
+    if (p != end) return false;
+
+    int power = exponent - scale;
+    if (exact && mantissa <= (uint64_t(1) << 53) && power >= -22 && power <= 22) {
+        double v = (double)mantissa;
+        v = power < 0 ? v / kPow10[-power] : v * kPow10[power];
+        out = neg ? -v : v;
+        return true;
+    }
+
+    char buf[128];
+    size_t n = (size_t)(end - start);
+    if (n >= sizeof(buf)) return false;
+    std::memcpy(buf, start, n);
+    buf[n] = '\0';
+    char* stop;
+    out = std::strtod(buf, &stop);
+    return stop == buf + n;
+}
+
+// ---------------------------------------------------------
+// 2. CSV
+// ---------------------------------------------------------
+
+const char* lineEnd(const char* p, const char* end) {
+    const char* nl = static_cast<const char*>(std::memchr(p, '\n', (size_t)(end - p)));
+    return nl ? nl : end;
+}
+
+// Field `index` of the line [p, end), without a trailing '\r'
+bool field(const char* p, const char* end, char delim, size_t index,
+           const char*& from, const char*& to) {
+    if (end > p && end[-1] == '\r') end--;
+    for (size_t i = 0; i < index; i++) {
+        const char* d = static_cast<const char*>(std::memchr(p, delim, (size_t)(end - p)));
+        if (!d) return false;
+        p = d + 1;
+    }
+    const char* d = static_cast<const char*>(std::memchr(p, delim, (size_t)(end - p)));
+    from = p;
+    to = d ? d : end;
+    return true;
+}
+
+bool blank(const char* p, const char* end) {
+    for (; p < end; p++)
+        if (*p != ' ' && *p != '\r' && *p != '\t') return false;
+    return true;
+}
+
+std::string lower(std::string s) {
+    for (char& c : s) c = (char)std::tolower((unsigned char)c);
+    return s;
+}
+
+// Parse lines [p, end) into out; returns the first bad byte or nullptr
+const char* parseLines(const char* p, const char* end, char delim, size_t column,
+                       Series<double>& out) {
+    while (p < end) {
+        const char* e = lineEnd(p, end);
+        const char *from, *to;
+        if (!blank(p, e)) {
+            double v;
+            if (!field(p, e, delim, column, from, to) || !parseNumber(from, to, v)) return p;
+            out.push_back(v);
+        }
+        p = e + 1;
+    }
+    return nullptr;
+}
+
+// ---------------------------------------------------------
+// 3. SOURCES
+// ---------------------------------------------------------
+
+class ParsedPrices : public PriceSource {
+public:
+    explicit ParsedPrices(Series<double> values) : values(std::move(values)) {
+        span = {this->values.data(), this->values.size()};
+    }
+
+private:
+    Series<double> values;
+};
+
+class MappedPrices : public PriceSource {
+public:
+    explicit MappedPrices(const std::string& path) : file(path) {
+        if (file.size() % sizeof(double) != 0)
+            throw std::runtime_error("Not a float64 column file: " + path);
+        span = {reinterpret_cast<const double*>(file.data()), file.size() / sizeof(double)};
+    }
+
+private:
+    MappedFile file;
+};
+
+bool endsWith(const std::string& s, const char* suffix) {
+    size_t n = std::strlen(suffix);
+    return s.size() >= n && lower(s.substr(s.size() - n)) == suffix;
+}
+
+} // namespace
+
+Series<double> parseCsvPrices(const char* data, size_t size, const std::string& column, int threads) {
+    const char* p = data;
+    const char* end = data + size;
+    if (end - p >= 3 && std::memcmp(p, "\xEF\xBB\xBF", 3) == 0) p += 3;   // UTF-8 BOM
+    while (p < end && blank(p, lineEnd(p, end))) p = lineEnd(p, end) + 1;
+    if (p >= end) throw std::runtime_error("No prices in CSV");
+
+    // Delimiter, header and column from the first line
+    const char* first_end = lineEnd(p, end);
+    std::string first(p, first_end);
+    if (!first.empty() && first.back() == '\r') first.pop_back();
+    char delim = ',';
+    if (first.find(',') == std::string::npos) {
+        if (first.find(';') != std::string::npos) delim = ';';
+        else if (first.find('\t') != std::string::npos) delim = '\t';
+    }
+    std::vector<std::string> names;
+    for (size_t at = 0;;) {
+        size_t d = first.find(delim, at);
+        names.push_back(first.substr(at, d == std::string::npos ? std::string::npos : d - at));
+        if (d == std::string::npos) break;
+        at = d + 1;
+    }
+    bool header = false;
+    for (const std::string& name : names) {
+        double v;
+        if (!parseNumber(name.data(), name.data() + name.size(), v)) header = true;
+    }
+
+    size_t index = names.size() - 1;
+    auto named = [&](const std::string& want) {
+        for (size_t i = 0; i < names.size(); i++) {
+            std::string n = names[i];
+            n.erase(std::remove(n.begin(), n.end(), '"'), n.end());
+            n.erase(0, n.find_first_not_of(' '));
+            n.erase(n.find_last_not_of(' ') + 1);
+            if (lower(n) == lower(want)) {
+                index = i;
+                return true;
+            }
+        }
+        return false;
+    };
+    if (!column.empty()) {
+        if (!header || !named(column))
+            throw std::invalid_argument("CSV has no column \"" + column + "\"");
+    } else if (header && !named("close")) {
+        named("price");
+    }
+    if (header) p = first_end + 1;
+
+    // Chunks start after a newline, so no line is split between threads
+    int n = threads > 0 ? threads : (int)std::max(1u, std::thread::hardware_concurrency());
+    size_t bytes = p < end ? (size_t)(end - p) : 0;
+    n = (int)std::max<size_t>(1, std::min<size_t>((size_t)n, bytes / (1 << 20)));
+    std::vector<const char*> cuts{p};
+    for (int i = 1; i < n; i++) {
+        const char* c = p + bytes * (size_t)i / (size_t)n;
+        c = std::max(c, cuts.back());
+        c = c < end ? lineEnd(c, end) + 1 : end;
+        cuts.push_back(std::min(c, end));
+    }
+    cuts.push_back(end);
+
+    size_t line_bytes = std::max<size_t>(first.size() + 1, 2);
+    std::vector<Series<double>> parts(n);
+    std::vector<const char*> bad(n, nullptr);
+    auto work = [&](int i) {
+        if (cuts[i] >= cuts[i + 1]) return;
+        parts[i].reserve((size_t)(cuts[i + 1] - cuts[i]) / line_bytes + 16);
+        bad[i] = parseLines(cuts[i], cuts[i + 1], delim, index, parts[i]);
+    };
+    std::vector<std::thread> workers;
+    for (int i = 1; i < n; i++) workers.emplace_back(work, i);
+    work(0);
+    for (auto& t : workers) t.join();
+    for (const char* b : bad)
+        if (b) throw std::runtime_error("Bad price in CSV at byte " + std::to_string(b - data));
+
+    size_t total = 0;
+    for (const auto& part : parts) total += part.size();
+    if (total == 0) throw std::runtime_error("No prices in CSV");
+    if (n == 1) return std::move(parts[0]);
+    Series<double> out(total);
+    size_t at = 0;
+    for (const auto& part : parts) {
+        std::copy(part.begin(), part.end(), out.begin() + (std::ptrdiff_t)at);
+        at += part.size();
+    }
+    return out;
+}
+
+std::shared_ptr<const PriceSource> loadPrices(const std::string& path, const std::string& column,
+                                              int threads) {
+    if (endsWith(path, ".csv") || endsWith(path, ".txt")) {
+        MappedFile file(path);
+        return std::make_shared<ParsedPrices>(
+            parseCsvPrices(file.data(), file.size(), column, threads));
+    }
+    auto mapped = std::make_shared<MappedPrices>(path);
+    if (mapped->prices().empty()) throw std::runtime_error("No prices in " + path);
+    return mapped;
+}
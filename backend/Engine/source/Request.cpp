@@ -0,0 +1,195 @@
+#include "../include/Request.hpp"
+#include "../include/StochasticModel.hpp"
+#include <charconv>
+#include <stdexcept>
+
+using json = nlohmann::json;
+
+SignalType signalFromString(const std::string& s) {
+    if (s == "RSI") return SignalType::RSI;
+    if (s == "VOLATILITY") return SignalType::VOLATILITY;
+    if (s == "VOLATILITY_MA") return SignalType::VOLATILITY_MA;
+    if (s == "MA" || s == "SMA") return SignalType::MA_SHORT;
+    if (s == "MA_LONG") return SignalType::MA_LONG;
+    if (s == "Price") return SignalType::PRICE;
+    return SignalType::PRICE; // Default
+}
+
+CrossSection crossFromString(const std::string& s) {
+    if (s.empty()) return CrossSection::NONE;
+    if (s == "rank") return CrossSection::RANK;
+    if (s == "zscore") return CrossSection::ZSCORE;
+    throw std::invalid_argument("cross: \"rank\" or \"zscore\"");
+}
+
+Execution executionFromString(const std::string& s) {
+    if (s.empty() || s == "close") return Execution::CLOSE;
+    if (s == "book") return Execution::BOOK;
+    throw std::invalid_argument("execution: \"close\" or \"book\"");
+}
+
+std::string marketFromString(const std::string& s) {
+    if (s == "Mean Reversion" || s == "MeanReversion") return "MeanReverting";
+    if (s == "Sideways") return "Sideways";
+    if (s == "Agents" || s == "Agent-based") return "Agents";
+    if (s == "GBM" || s == "GARCH" || s == "Switching") return s;
+    if (s == "Jumps" || s == "Jump diffusion") return "Jumps";
+    if (s == "Regime switching") return "Switching";
+    return "Trending";
+}
+
+ModelParams parseModel(const json& j) {
+    ModelParams m;
+    m.mu = j.value("mu", m.mu);
+    m.sigma = j.value("sigma", m.sigma);
+    m.omega = j.value("omega", m.omega);
+    m.alpha = j.value("alpha", m.alpha);
+    m.beta = j.value("beta", m.beta);
+    m.jump_rate = j.value("jump_rate", m.jump_rate);
+    m.jump_mean = j.value("jump_mean", m.jump_mean);
+    m.jump_sd = j.value("jump_sd", m.jump_sd);
+    m.stay = j.value("stay", m.stay);
+    return m;
+}
+
+static void parseRules(const json& rules, std::vector<Condition>& target) {
+    for (const auto& r : rules) {
+        Condition c;
+        
+        // 1. LHS
+        c.lhs = signalFromString(r.value("lhs", "Price"));
+        
+        // 2. Operator
+        std::string op = r.value("op", ">");
+        c.op = op.empty() ? '>' : op[0];
+
+        // 3. RHS Logic
+        std::string type = r.value("rhs_type", "CONSTANT");
+        if (type == "SIGNAL") {
+            c.rhs_type = OperandType::SIGNAL;
+            // Read 'rhs_signal' from JSON, map to Enum
+            c.rhs_signal = signalFromString(r.value("rhs_signal", "Price"));
+            c.rhs_value = 0.0;
+        } else {
+            c.rhs_type = OperandType::CONSTANT;
+            c.rhs_signal = SignalType::PRICE;
+            c.rhs_value = r.value("rhs_value", 0.0);
+        }
+
+        // 4. Timeframe, in bars
+        c.timeframe = r.value("timeframe", 1);
+
+        // 5. Across the assets of a portfolio
+        c.cross = crossFromString(r.value("cross", ""));
+        
+        target.push_back(c);
+    }
+}
+
+Strategy parseStrategy(const json& j) {
+    Strategy strategy;
+    strategy.name = "User Strategy";
+    if (j.contains("buy")) parseRules(j["buy"], strategy.buy);
+    if (j.contains("sell")) parseRules(j["sell"], strategy.sell);
+    strategy.stop_loss = j.value("stop_loss", 0.0);
+    strategy.take_profit = j.value("take_profit", 0.0);
+    strategy.execution = executionFromString(j.value("execution", ""));
+    return strategy;
+}
+
+Request parseRequest(const json& input) {
+    Request req;
+    Config& cfg = req.config;
+
+    // Handle Frontend string differences
+    cfg.market = marketFromString(input.value("market", "Trending"));
+
+    cfg.timesteps = input.value("timesteps", 1000);
+    cfg.seed = input.value("seed", 42);
+    cfg.precision = input.value("precision", "float64") == "float32"
+        ? SignalPrecision::F32 : SignalPrecision::F64;
+    cfg.prices_file = input.value("prices_file", "");
+    cfg.prices_column = input.value("prices_column", "");
+    if (input.contains("model")) cfg.model = parseModel(input["model"]);
+    req.stream = input.value("stream", false);
+    req.timeout_ms = input.value("timeout_ms", (int64_t)0);
+    req.id = input.value("request_id", "");
+    req.priority = input.value("priority", "");
+    if (!req.priority.empty() && req.priority != "interactive" && req.priority != "batch")
+        throw std::invalid_argument("priority: \"interactive\" or \"batch\"");
+
+    if (input.contains("strategy"))
+        req.strategy = parseStrategy(input["strategy"]);
+    else
+        req.strategy.name = "User Strategy";
+
+    return req;
+}
+
+static void appendRules(std::string& key, const std::vector<Condition>& rules) {
+    for (const Condition& c : rules) {
+        key += std::to_string((int)c.lhs);
+        key += c.op;
+        if (c.rhs_type == OperandType::SIGNAL) {
+            key += 's';
+            key += std::to_string((int)c.rhs_signal);
+        } else {
+            // shortest round-trip form; -0 compares like 0
+            char buf[32];
+            double v = c.rhs_value == 0.0 ? 0.0 : c.rhs_value;
+            key.append(buf, std::to_chars(buf, buf + sizeof(buf), v).ptr);
+        }
+        if (c.timeframe != 1) {
+            key += '@';
+            key += std::to_string(c.timeframe);
+        }
+        if (c.cross != CrossSection::NONE) key += c.cross == CrossSection::RANK ? "#rank" : "#z";
+        key += ';';
+    }
+}
+
+std::string modelKey(const Config& cfg) {
+    if (!StochasticModel::isModel(cfg.market)) return "";
+    const ModelParams& m = cfg.model;
+    std::string key = "|model:";
+    char buf[32];
+    for (double v : {m.mu, m.sigma, m.omega, m.alpha, m.beta, m.jump_rate, m.jump_mean,
+                     m.jump_sd, m.stay}) {
+        key.append(buf, std::to_chars(buf, buf + sizeof(buf), v == 0.0 ? 0.0 : v).ptr);
+        key += ',';
+    }
+    return key;
+}
+
+std::string marketKey(const Request& req) {
+    const Config& cfg = req.config;
+    std::string key = cfg.market;
+    key += '|';
+    key += std::to_string(cfg.timesteps);
+    key += '|';
+    key += std::to_string(cfg.seed);
+    key += cfg.precision == SignalPrecision::F32 ? "|f32" : "|f64";
+    if (!cfg.prices_file.empty()) key += "|file:" + cfg.prices_column + ':' + cfg.prices_file;
+    key += modelKey(cfg);
+    return key;
+}
+
+std::string rulesKey(const Strategy& strategy) {
+    std::string key = "buy:";
+    appendRules(key, strategy.buy);
+    key += "|sell:";
+    appendRules(key, strategy.sell);
+    if (strategy.stop_loss != 0.0 || strategy.take_profit != 0.0) {
+        char buf[32];
+        key += "|exit:";
+        key.append(buf, std::to_chars(buf, buf + sizeof(buf), strategy.stop_loss).ptr);
+        key += ',';
+        key.append(buf, std::to_chars(buf, buf + sizeof(buf), strategy.take_profit).ptr);
+    }
+    if (strategy.execution == Execution::BOOK) key += "|book";
+    return key;
+}
+
+std::string canonicalKey(const Request& req) {
+    return marketKey(req) + '|' + rulesKey(req.strategy);
+}
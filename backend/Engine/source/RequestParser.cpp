@@ -0,0 +1,274 @@
+#include "../include/RequestParser.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace {
+
+// Cursor over the request text. Every method returns false as soon as
+// the input leaves the fast path.
+class Reader {
+public:
+    Reader(const char* data, size_t length) : p(data), end(data + length) {}
+
+    void skipSpace() {
+        while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) p++;
+    }
+
+    bool consume(char c) {
+        skipSpace();
+        if (p >= end || *p != c) return false;
+        p++;
+        return true;
+    }
+
+    bool peek(char c) {
+        skipSpace();
+        return p < end && *p == c;
+    }
+
+    bool atEnd() {
+        skipSpace();
+        return p == end;
+    }
+
+    // Plain string without escapes
+    bool string(std::string& out) {
+        if (!consume('"')) return false;
+        const char* start = p;
+        while (p < end && *p != '"') {
+            if (*p == '\\' || (unsigned char)*p < 0x20) return false;
+            p++;
+        }
+        if (p >= end) return false;
+        out.assign(start, p);
+        p++;
+        return true;
+    }
+
+    bool boolean(bool& out) {
+        skipSpace();
+        if (end - p >= 4 && std::memcmp(p, "true", 4) == 0) {
+            p += 4;
+            out = true;
+            return true;
+        }
+        if (end - p >= 5 && std::memcmp(p, "false", 5) == 0) {
+            p += 5;
+            out = false;
+            return true;
+        }
+        return false;
+    }
+
+    bool integer(long long& out) {
+        skipSpace();
+        const char* start = p;
+        bool neg = p < end && *p == '-';
+        if (neg) p++;
+        if (p >= end || *p < '0' || *p > '9') return false;
+        unsigned long long v = 0;
+        int digits = 0;
+        while (p < end && *p >= '0' && *p <= '9') {
+            v = v * 10 + (unsigned)(*p - '0');
+            if (++digits > 18) return false;
+            p++;
+        }
+        // fractions and exponents are left to the DOM path
+        if (p < end && (*p == '.' || *p == 'e' || *p == 'E')) return false;
+        if (digits > 1 && start[neg ? 1 : 0] == '0') return false;   // leading zero
+        out = neg ? -(long long)v : (long long)v;
+        return true;
+    }
+
+    // JSON's number grammar: -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+    // Anything else (+30, .5, 30., 01) is left to the DOM path to reject.
+    bool number(double& out) {
+        skipSpace();
+        const char* start = p;
+        if (p < end && *p == '-') p++;
+        if (p < end && *p == '0') p++;
+        else if (!digits()) return false;
+        if (p < end && *p == '.') {
+            p++;
+            if (!digits()) return false;
+        }
+        if (p < end && (*p == 'e' || *p == 'E')) {
+            p++;
+            if (p < end && (*p == '+' || *p == '-')) p++;
+            if (!digits()) return false;
+        }
+        if (p < end && ((*p >= '0' && *p <= '9') || *p == '.' || *p == 'e' || *p == 'E' ||
+                        *p == '+' || *p == '-'))
+            return false;   // e.g. the 1 of 01
+        size_t n = (size_t)(p - start);
+        if (n == 0 || n >= 64) return false;
+
+        char buf[64];
+        std::memcpy(buf, start, n);
+        buf[n] = '\0';
+        char* stop = nullptr;
+        out = std::strtod(buf, &stop);
+        return stop == buf + n;
+    }
+
+private:
+    // One or more digits
+    bool digits() {
+        const char* from = p;
+        while (p < end && *p >= '0' && *p <= '9') p++;
+        return p > from;
+    }
+
+    const char* p;
+    const char* end;
+};
+
+// Iterate the members of an object: fn(key) must consume the value
+template <typename Fn>
+bool members(Reader& r, Fn fn) {
+    if (!r.consume('{')) return false;
+    if (r.consume('}')) return true;
+    for (;;) {
+        std::string key;
+        if (!r.string(key) || !r.consume(':')) return false;
+        if (!fn(key)) return false;
+        if (r.consume(',')) continue;
+        return r.consume('}');
+    }
+}
+
+bool rule(Reader& r, Condition& c) {
+    std::string lhs = "Price", op = ">", type = "CONSTANT", rhs_signal = "Price", cross;
+    double rhs_value = 0.0;
+    long long timeframe = 1;
+
+    bool ok = members(r, [&](const std::string& key) {
+        if (key == "lhs") return r.string(lhs);
+        if (key == "op") return r.string(op);
+        if (key == "rhs_type") return r.string(type);
+        if (key == "rhs_signal") return r.string(rhs_signal);
+        if (key == "rhs_value") return r.number(rhs_value);
+        if (key == "timeframe") return r.integer(timeframe);
+        if (key == "cross") return r.string(cross);
+        return false;
+    });
+    if (!ok || timeframe < INT32_MIN || timeframe > INT32_MAX) return false;
+    if (!cross.empty() && cross != "rank" && cross != "zscore") return false;
+
+    // same mapping as parseRules() in Request.cpp
+    c.lhs = signalFromString(lhs);
+    c.op = op.empty() ? '>' : op[0];
+    if (type == "SIGNAL") {
+        c.rhs_type = OperandType::SIGNAL;
+        c.rhs_signal = signalFromString(rhs_signal);
+        c.rhs_value = 0.0;
+    } else {
+        c.rhs_type = OperandType::CONSTANT;
+        c.rhs_signal = SignalType::PRICE;
+        c.rhs_value = rhs_value;
+    }
+    c.timeframe = (int)timeframe;
+    c.cross = crossFromString(cross);
+    return true;
+}
+
+bool rules(Reader& r, std::vector<Condition>& target) {
+    if (!r.consume('[')) return false;
+    if (r.consume(']')) return true;
+    for (;;) {
+        Condition c;
+        if (!rule(r, c)) return false;
+        target.push_back(c);
+        if (r.consume(',')) continue;
+        return r.consume(']');
+    }
+}
+
+bool strategy(Reader& r, Strategy& s) {
+    bool seen_buy = false, seen_sell = false;
+    return members(r, [&](const std::string& key) {
+        // a repeated key would mean "last wins"; leave that to the DOM
+        if (key == "buy" && !seen_buy) return seen_buy = true, rules(r, s.buy);
+        if (key == "sell" && !seen_sell) return seen_sell = true, rules(r, s.sell);
+        if (key == "stop_loss") return r.number(s.stop_loss);
+        if (key == "take_profit") return r.number(s.take_profit);
+        if (key == "execution") {
+            std::string e;
+            if (!r.string(e) || (e != "close" && e != "book")) return false;
+            s.execution = e == "book" ? Execution::BOOK : Execution::CLOSE;
+            return true;
+        }
+        return false;
+    });
+}
+
+bool model(Reader& r, ModelParams& m) {
+    return members(r, [&](const std::string& key) {
+        if (key == "mu") return r.number(m.mu);
+        if (key == "sigma") return r.number(m.sigma);
+        if (key == "omega") return r.number(m.omega);
+        if (key == "alpha") return r.number(m.alpha);
+        if (key == "beta") return r.number(m.beta);
+        if (key == "jump_rate") return r.number(m.jump_rate);
+        if (key == "jump_mean") return r.number(m.jump_mean);
+        if (key == "jump_sd") return r.number(m.jump_sd);
+        if (key == "stay") return r.number(m.stay);
+        return false;
+    });
+}
+
+} // namespace
+
+bool parseRequestFast(const char* data, size_t length, Request& out) {
+    Reader r(data, length);
+    Request req;
+    req.strategy.name = "User Strategy";
+
+    std::string market = "Trending", precision = "float64", prices_file, prices_column;
+    long long timesteps = 1000, seed = 42, timeout_ms = 0;
+    bool seen_strategy = false, seen_model = false;
+    ModelParams params;
+
+    bool ok = members(r, [&](const std::string& key) {
+        if (key == "market") return r.string(market);
+        if (key == "timesteps") return r.integer(timesteps);
+        if (key == "seed") return r.integer(seed);
+        if (key == "precision") return r.string(precision);
+        if (key == "prices_file") return r.string(prices_file);
+        if (key == "prices_column") return r.string(prices_column);
+        if (key == "stream") return r.boolean(req.stream);
+        if (key == "timeout_ms") return r.integer(timeout_ms);
+        if (key == "request_id") return r.string(req.id);
+        if (key == "priority") return r.string(req.priority);
+        if (key == "strategy" && !seen_strategy) return seen_strategy = true, strategy(r, req.strategy);
+        if (key == "model" && !seen_model) return seen_model = true, model(r, params);
+        return false;
+    });
+    if (!ok || !r.atEnd()) return false;
+
+    if (timesteps < INT32_MIN || timesteps > INT32_MAX) return false;
+    if (seed < 0 || seed > UINT32_MAX) return false;
+    if (!req.priority.empty() && req.priority != "interactive" && req.priority != "batch")
+        return false;   // parseRequest reports it
+
+    // Handle Frontend string differences (as parseRequest does)
+    Config& cfg = req.config;
+    cfg.market = marketFromString(market);
+    cfg.timesteps = (int)timesteps;
+    cfg.seed = (unsigned int)seed;
+    cfg.precision = precision == "float32" ? SignalPrecision::F32 : SignalPrecision::F64;
+    cfg.prices_file = std::move(prices_file);
+    cfg.prices_column = std::move(prices_column);
+    cfg.model = params;
+    req.timeout_ms = timeout_ms;
+
+    out = std::move(req);
+    return true;
+}
+
+Request parseRequestText(const char* data, size_t length) {
+    Request req;
+    if (parseRequestFast(data, length, req)) return req;
+    return parseRequest(nlohmann::json::parse(data, data + length));
+}
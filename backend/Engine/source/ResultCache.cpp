@@ -0,0 +1,72 @@
+#include "../include/ResultCache.hpp"
+#include <cstdint>
+#include <iterator>
+
+// Heap bytes a string owns beyond the object itself (0 while its data
+// sits in the object's small-string buffer)
+static size_t heapBytes(const std::string& s) {
+    auto data = (uintptr_t)s.data();
+    auto self = (uintptr_t)&s;
+    bool small = data >= self && data < self + sizeof(std::string);
+    return small ? 0 : s.capacity() + 1;
+}
+
+size_t ResultCache::footprint(const std::string& key, const std::string& body) {
+    // list node (two links + Entry), map node (next link + key + iterator
+    // + cached hash) and its bucket, both key copies, and the
+    // make_shared block holding the body (vtable, two counts, string)
+    size_t list_node = 2 * sizeof(void*) + sizeof(Entry);
+    size_t map_node = sizeof(void*) + sizeof(std::string) + sizeof(List::iterator) + sizeof(size_t);
+    size_t bucket = sizeof(void*);
+    size_t body_block = sizeof(void*) + 2 * sizeof(int) + sizeof(std::string);
+    return list_node + map_node + bucket + 2 * heapBytes(key) + body_block + heapBytes(body);
+}
+
+ResultCache::Body ResultCache::get(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mu);
+    auto it = index.find(key);
+    if (it == index.end()) {
+        misses++;
+        return nullptr;
+    }
+    hits++;
+    lru.splice(lru.begin(), lru, it->second);
+    return it->second->body;
+}
+
+void ResultCache::put(const std::string& key, Body body) {
+    if (!body) return;
+    std::string stored = key;           // sized like the copies kept
+    size_t size = footprint(stored, *body);
+    if (size > capacity / 4) return;
+
+    std::lock_guard<std::mutex> lock(mu);
+    auto found = index.find(stored);
+    if (found != index.end()) evict(found->second);
+
+    while (!lru.empty() && bytes + size > capacity) {
+        evict(std::prev(lru.end()));
+        evictions++;
+    }
+    lru.push_front({std::move(stored), std::move(body), size});
+    index.emplace(lru.front().key, lru.begin());
+    bytes += size;
+}
+
+void ResultCache::evict(List::iterator it) {
+    bytes -= it->bytes;
+    index.erase(it->key);
+    lru.erase(it);
+}
+
+ResultCache::Stats ResultCache::stats() const {
+    std::lock_guard<std::mutex> lock(mu);
+    Stats s;
+    s.entries = lru.size();
+    s.bytes = bytes;
+    s.capacity = capacity;
+    s.hits = hits;
+    s.misses = misses;
+    s.evictions = evictions;
+    return s;
+}
@@ -0,0 +1,144 @@
+#include "../include/Scheduler.hpp"
+#include <algorithm>
+
+const char* priorityName(Priority p) {
+    return p == Priority::INTERACTIVE ? "interactive" : "batch";
+}
+
+Scheduler::Scheduler(SchedulerOptions options) : opts(options) {
+    int n = opts.executors > 0 ? opts.executors
+                               : (int)std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 0; i < n; i++) executors.emplace_back([this] { executorLoop(); });
+}
+
+Scheduler::~Scheduler() {
+    {
+        std::lock_guard<std::mutex> lock(mu);
+        stopping = true;
+    }
+    cv.notify_all();
+    for (auto& t : executors) t.join();
+}
+
+Priority Scheduler::classify(uint64_t cost) const {
+    return cost <= opts.interactive_cost ? Priority::INTERACTIVE : Priority::BATCH;
+}
+
+Scheduler::Admission Scheduler::submit(Job job) {
+    if (job.memory > budget(job.priority)) return Admission::TOO_LARGE;
+    {
+        std::lock_guard<std::mutex> lock(mu);
+        if (waiting[0].size() + waiting[1].size() >= opts.max_waiting)
+            return Admission::QUEUE_FULL;
+        int c = (int)job.priority;
+        waiting[c].push_back(std::move(job));
+        admit();
+    }
+    cv.notify_all();
+    return Admission::ACCEPTED;
+}
+
+Scheduler::Stats Scheduler::stats() const {
+    std::lock_guard<std::mutex> lock(mu);
+    Stats s;
+    for (int c = 0; c < 2; c++) {
+        s.running[c] = running[c];
+        s.waiting[c] = waiting[c].size();
+        s.slices[c] = slices[c];
+    }
+    s.memory = memory;
+    return s;
+}
+
+size_t Scheduler::budget(Priority p) const {
+    if (p == Priority::INTERACTIVE) return opts.memory_budget;
+    return opts.memory_budget - std::min(opts.interactive_reserve, opts.memory_budget);
+}
+
+// In priority order, FIFO within a class; a job that does not fit blocks
+// the ones behind it so large runs are not starved by small ones
+void Scheduler::admit() {
+    for (auto& queue : waiting) {
+        while (!queue.empty()) {
+            Job& job = queue.front();
+            if (memory + job.memory > budget(job.priority)) return;
+            memory += job.memory;
+            running[(int)job.priority]++;
+            ready[(int)job.priority].push_back(std::move(job));
+            queue.pop_front();
+        }
+    }
+}
+
+void Scheduler::charge(int64_t bytes) {
+    {
+        std::lock_guard<std::mutex> lock(mu);
+        memory = (size_t)((int64_t)memory + bytes);
+        if (bytes >= 0) return;
+        admit();
+    }
+    cv.notify_all();
+}
+
+bool Scheduler::pick(Job& job, Clock::time_point& wake) {
+    Clock::time_point now = Clock::now();
+    // First job of a queue that may start; later ones are left in order
+    auto due = [&](std::deque<Job>& queue) {
+        for (auto it = queue.begin(); it != queue.end(); ++it) {
+            if (it->not_before <= now) return it;
+            wake = std::min(wake, it->not_before);
+        }
+        return queue.end();
+    };
+    auto& interactive = ready[(int)Priority::INTERACTIVE];
+    auto& batch = ready[(int)Priority::BATCH];
+    auto i = due(interactive);
+    auto b = due(batch);
+    if (i == interactive.end() && b == batch.end()) return false;
+
+    bool take_batch = i == interactive.end() ||
+                      (b != batch.end() && burst >= opts.interactive_burst);
+    auto& queue = take_batch ? batch : interactive;
+    auto it = take_batch ? b : i;
+    burst = take_batch ? 0 : burst + 1;
+
+    job = std::move(*it);
+    queue.erase(it);
+    slices[(int)job.priority]++;
+    return true;
+}
+
+void Scheduler::executorLoop() {
+    std::unique_lock<std::mutex> lock(mu);
+    for (;;) {
+        Job job;
+        Clock::time_point wake = Clock::time_point::max();
+        while (!stopping && !pick(job, wake)) {
+            if (wake == Clock::time_point::max()) cv.wait(lock);
+            else cv.wait_until(lock, wake);
+            wake = Clock::time_point::max();
+        }
+        if (stopping) return;
+
+        lock.unlock();
+        bool more;
+        try {
+            more = job.slice();
+        } catch (...) {
+            more = false;       // the job reports its own errors
+        }
+        if (!more) job.slice = nullptr;     // release what the job holds, unlocked
+        lock.lock();
+
+        if (more) {
+            job.not_before = Clock::time_point();
+            ready[(int)job.priority].push_back(std::move(job));
+            cv.notify_one();
+        } else {
+            memory -= job.memory;
+            running[(int)job.priority]--;
+            admit();
+            cv.notify_all();
+        }
+    }
+}
@@ -0,0 +1,81 @@
+#include "../include/SeriesAllocator.hpp"
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+static size_t roundUp(size_t bytes, size_t to) {
+    return (bytes + to - 1) / to * to;
+}
+
+#if defined(__linux__)
+
+// Explicit 2 MiB pages from the hugetlb pool. Fails unless the admin has
+// reserved pages (vm.nr_hugepages), which is the common case.
+static void* mapHugeTlb(size_t len) {
+#ifdef MAP_HUGETLB
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB;
+#ifdef MAP_HUGE_2MB
+    flags |= MAP_HUGE_2MB;
+#endif
+    void* p = mmap(nullptr, len, PROT_READ | PROT_WRITE, flags, -1, 0);
+    return p == MAP_FAILED ? nullptr : p;
+#else
+    (void)len;
+    return nullptr;
+#endif
+}
+
+// Normal anonymous mapping trimmed to a 2 MiB boundary and flagged for
+// transparent huge pages.
+static void* mapTransparent(size_t len) {
+    size_t span = len + kHugePageBytes;
+    void* raw = mmap(nullptr, span, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) return nullptr;
+
+    char* base = static_cast<char*>(raw);
+    char* aligned = reinterpret_cast<char*>(
+        roundUp(reinterpret_cast<size_t>(base), kHugePageBytes));
+    size_t head = aligned - base;
+    size_t tail = span - head - len;
+    if (head) munmap(base, head);
+    if (tail) munmap(aligned + len, tail);
+
+#ifdef MADV_HUGEPAGE
+    madvise(aligned, len, MADV_HUGEPAGE);   // advisory; ignore failure
+#endif
+    return aligned;
+}
+
+#endif
+
+void* seriesAllocate(size_t bytes) {
+    if (bytes == 0) bytes = 1;
+
+#if defined(__linux__)
+    if (bytes >= kHugePageBytes) {
+        size_t len = roundUp(bytes, kHugePageBytes);
+        if (void* p = mapHugeTlb(len)) return p;
+        if (void* p = mapTransparent(len)) return p;
+        throw std::bad_alloc();
+    }
+#endif
+
+    return ::operator new(roundUp(bytes, kSeriesAlignment),
+                          std::align_val_t(kSeriesAlignment));
+}
+
+void seriesRelease(void* p, size_t bytes) noexcept {
+    if (!p) return;
+    if (bytes == 0) bytes = 1;
+
+#if defined(__linux__)
+    if (bytes >= kHugePageBytes) {
+        munmap(p, roundUp(bytes, kHugePageBytes));
+        return;
+    }
+#endif
+
+    ::operator delete(p, std::align_val_t(kSeriesAlignment));
+}
@@ -0,0 +1,399 @@
+#include "../include/SimulateService.hpp"
+#include "../include/Backtest.hpp"
+#include "../include/Pipeline.hpp"
+#include "../include/RequestParser.hpp"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+
+using json = nlohmann::json;
+
+static HttpResponse jsonError(int status, const std::string& error,
+                              const std::string& details = "") {
+    json body = {{"error", error}};
+    if (!details.empty()) body["details"] = details;
+
+    HttpResponse r;
+    r.status = status;
+    r.body = body.dump();
+    return r;
+}
+
+SimulateService::SimulateService(ServiceOptions options)
+    : opts(options), cache(opts.cache_bytes), scheduler(opts.scheduling) {}
+
+void SimulateService::handle(const HttpRequest& req, HttpReply reply) {
+    if (req.path == "/simulate") {
+        if (req.method != "POST") return reply.send(jsonError(405, "Method not allowed"));
+        return simulate(req, std::move(reply));
+    }
+    if (req.path.compare(0, 10, "/simulate/") == 0 && req.path.size() > 10) {
+        if (req.method != "DELETE") return reply.send(jsonError(405, "Method not allowed"));
+        return reply.send(cancel(req.path.substr(10)));
+    }
+    if (req.path == "/stats" && req.method == "GET") return reply.send(stats());
+    if (req.path == "/" && req.method == "GET") {
+        HttpResponse r;
+        r.content_type = "text/plain";
+        r.body = "Hello, server is running!";
+        return reply.send(r);
+    }
+    reply.send(jsonError(404, "Not found"));
+}
+
+bool SimulateService::isControl(const HttpRequest& req) {
+    return req.method == "DELETE";
+}
+
+static HttpResponse rejection(Scheduler::Admission a) {
+    if (a == Scheduler::Admission::TOO_LARGE)
+        return jsonError(413, "Run exceeds the memory budget", "lower timesteps or stream the result");
+    return jsonError(503, "Server busy", "too many runs waiting");
+}
+
+Job SimulateService::newJob(const Request& request, bool streamed) const {
+    Job job;
+    job.priority = request.priority.empty()
+        ? scheduler.classify(jobCost((uint64_t)std::max(request.config.timesteps, 1)))
+        : request.priority == "batch" ? Priority::BATCH : Priority::INTERACTIVE;
+    job.memory = estimateMemory(request, streamed);
+    return job;
+}
+
+// Validates and submits; the run itself happens in scheduler slices,
+// which finish the reply
+void SimulateService::simulate(const HttpRequest& req, HttpReply reply) {
+    try {
+        Request request = parseRequestText(req.body.data(), req.body.size());
+        // clients must not name files on the server
+        if (!request.config.prices_file.empty())
+            throw std::invalid_argument("prices_file is only read by the command line and the library");
+        if (request.timeout_ms <= 0) request.timeout_ms = opts.default_timeout_ms;
+
+        std::shared_ptr<CancelToken> token = track(request);
+        if (!token) return reply.send(jsonError(409, "Request id already running", request.id));
+        if (request.timeout_ms > 0) token->setTimeout(request.timeout_ms);
+
+        const std::string* accept = req.header("accept");
+        if (request.stream || (accept && accept->find("application/x-ndjson") != std::string::npos))
+            return stream(request, token, reply);
+        join(request, token, reply);
+    } catch (const json::parse_error&) {
+        reply.send(jsonError(400, "Invalid JSON"));
+    } catch (const json::exception& e) {
+        reply.send(jsonError(400, "Invalid request", e.what()));
+    } catch (const std::invalid_argument& e) {
+        reply.send(jsonError(400, "Invalid request", e.what()));
+    } catch (const std::exception& e) {
+        reply.send(jsonError(500, "Simulation failed", e.what()));
+    }
+}
+
+// Streams are per client: never shared or cached
+void SimulateService::stream(Request& request, std::shared_ptr<CancelToken> token, HttpReply reply) {
+    std::shared_ptr<Untrack> untrack_when_done(new Untrack{this, request.id});
+    auto pipeline = std::make_shared<Pipeline>(request);   // validation errors surface here
+
+    HttpResponse head;
+    head.content_type = "application/x-ndjson";
+    head.headers.emplace_back("X-Request-Id", request.id);
+
+    Job job = newJob(request, true);
+    auto run = std::make_shared<NdjsonRun>(*pipeline, token.get());
+    bool started = false;
+    job.slice = [reply, head, pipeline, token, run, untrack_when_done, started]() mutable {
+        if (!started) started = true, reply.begin(head);
+        std::string line;
+        run->next(line);
+        if (!reply.chunk(line)) return false;
+        if (!run->finished()) return true;
+        reply.end();
+        return false;
+    };
+
+    Scheduler::Admission a = scheduler.submit(std::move(job));
+    if (a != Scheduler::Admission::ACCEPTED) reply.send(rejection(a));
+}
+
+static void respond(HttpReply& reply, const std::string& id, const char* cache,
+                    const std::string& body) {
+    HttpResponse r;
+    r.body = body;
+    r.headers.emplace_back("X-Request-Id", id);
+    r.headers.emplace_back("X-Cache", cache);
+    reply.send(r);
+}
+
+// Answer from the cache, join the identical run in flight, ride on a
+// run of the same market, or start one
+void SimulateService::join(Request& request, std::shared_ptr<CancelToken> token, HttpReply reply) {
+    std::shared_ptr<Untrack> untrack_when_done(new Untrack{this, request.id});
+    Waiter me{reply, request.id, token, untrack_when_done, "coalesced"};
+    std::string key = canonicalKey(request);
+
+    ResultCache::Body cached;
+    {
+        std::lock_guard<std::mutex> lock(mu);
+        auto it = flights.find(key);
+        if (it != flights.end()) return it->second->waiters.push_back(std::move(me));
+        cached = cache.get(key);
+    }
+    if (cached) return respond(reply, request.id, "hit", *cached);
+
+    auto flight = std::make_shared<Flight>();
+    flight->key = key;
+    flight->strategy = request.strategy;
+    std::string market = marketKey(request);
+    std::shared_ptr<Pipeline> pipeline;
+    std::shared_ptr<Batch> batch;
+
+    while (!batch) {
+        {
+            std::lock_guard<std::mutex> lock(mu);
+            auto it = flights.find(key);
+            if (it != flights.end()) return it->second->waiters.push_back(std::move(me));
+
+            auto open = batches.find(market);
+            if (open != batches.end() && open->second->size < opts.max_batch) {
+                Batch& b = *open->second;
+                me.cache = "miss";
+                flight->waiters.push_back(std::move(me));
+                flights.emplace(key, flight);
+                b.joining.push_back(flight);
+                b.size++;
+                size_t extra = estimateStrategyMemory(request);
+                b.charged += extra;
+                scheduler.charge((int64_t)extra);
+                batched++;
+                return;
+            }
+            if (pipeline) {
+                batch = std::make_shared<Batch>();
+                batch->key = market;
+                batch->members.push_back(flight);
+                batch->size = 1;
+                me.cache = "miss";
+                flight->waiters.push_back(std::move(me));
+                flights.emplace(key, flight);
+                batches[market] = batch;    // a full one keeps running unlisted
+            }
+        }
+        if (!pipeline) pipeline = std::make_shared<Pipeline>(request);   // validation errors surface here
+    }
+
+    // The run answers to its waiters, not to any one token
+    Job job = newJob(request, false);
+    job.not_before = std::chrono::steady_clock::now() +
+                     std::chrono::microseconds(opts.batch_window_us);
+    auto run = std::make_shared<JsonRun>(*pipeline);
+    job.slice = [this, batch, pipeline, run]() {
+        gather(batch, *pipeline, run->formatting());
+        if (!run->formatting() && !prune(batch, *pipeline)) {
+            release(batch);
+            return false;
+        }
+        run->step();
+        if (!run->done()) return true;
+        finish(batch, *run);
+        return false;
+    };
+
+    Scheduler::Admission a = scheduler.submit(std::move(job));
+    if (a != Scheduler::Admission::ACCEPTED) fail(batch, rejection(a));
+}
+
+void SimulateService::retire(const std::shared_ptr<Flight>& flight) {
+    auto it = flights.find(flight->key);
+    if (it != flights.end() && it->second == flight) flights.erase(it);
+}
+
+void SimulateService::close(const std::shared_ptr<Batch>& batch) {
+    auto it = batches.find(batch->key);
+    if (it != batches.end() && it->second == batch) batches.erase(it);
+}
+
+void SimulateService::release(const std::shared_ptr<Batch>& batch) {
+    size_t extra;
+    {
+        std::lock_guard<std::mutex> lock(mu);
+        extra = batch->charged;
+        batch->charged = 0;
+    }
+    if (extra) scheduler.charge(-(int64_t)extra);
+}
+
+void SimulateService::gather(const std::shared_ptr<Batch>& batch, Pipeline& pipeline, bool closing) {
+    std::vector<std::shared_ptr<Flight>> joiners;
+    {
+        std::lock_guard<std::mutex> lock(mu);
+        joiners.swap(batch->joining);
+        if (closing) close(batch);
+    }
+    for (auto& flight : joiners) {
+        try {
+            pipeline.addStrategy(flight->strategy);
+            batch->members.push_back(flight);
+        } catch (const std::exception& e) {
+            std::vector<Waiter> waiters;
+            {
+                std::lock_guard<std::mutex> lock(mu);
+                retire(flight);
+                waiters.swap(flight->waiters);
+            }
+            HttpResponse error = jsonError(400, "Invalid request", e.what());
+            for (Waiter& w : waiters) w.reply.send(error);
+        }
+    }
+}
+
+bool SimulateService::prune(const std::shared_ptr<Batch>& batch, const Pipeline& pipeline) {
+    struct Stopped {
+        Waiter waiter;
+        RunStatus status;
+        size_t member;
+    };
+    std::vector<Stopped> stopped;   // released outside the lock
+    bool alive = false;
+    {
+        std::lock_guard<std::mutex> lock(mu);
+        for (size_t m = 0; m < batch->members.size(); m++) {
+            auto& waiters = batch->members[m]->waiters;
+            for (size_t i = 0; i < waiters.size();) {
+                RunStatus s = waiters[i].reply.gone() ? RunStatus::CANCELLED
+                                                      : waiters[i].token->check();
+                if (s == RunStatus::COMPLETED) {
+                    i++;
+                    continue;
+                }
+                stopped.push_back({std::move(waiters[i]), s, m});
+                waiters.erase(waiters.begin() + (std::ptrdiff_t)i);
+            }
+            if (waiters.empty()) retire(batch->members[m]);    // runs on, unlisted
+            else alive = true;
+        }
+        alive = alive || !batch->joining.empty();
+        if (!alive) close(batch);
+    }
+
+    // Bars reached so far, as a run of its own would have answered
+    std::string partial;
+    for (size_t i = 0; i < stopped.size(); i++) {
+        Stopped& st = stopped[i];
+        if (st.waiter.reply.gone()) continue;
+        partial.clear();
+        appendResultJson(partial, pipeline.simulator().getPrices(),
+                         pipeline.backtester(st.member).result(), st.status);
+        respond(st.waiter.reply, st.waiter.id, st.waiter.cache, partial);
+    }
+    return alive;
+}
+
+void SimulateService::finish(const std::shared_ptr<Batch>& batch, JsonRun& run) {
+    std::vector<ResultCache::Body> bodies;
+    for (size_t i = 0; i < batch->members.size(); i++)
+        bodies.push_back(std::make_shared<const std::string>(std::move(run.output(i))));
+
+    std::vector<std::pair<Waiter, size_t>> waiters;
+    {
+        std::lock_guard<std::mutex> lock(mu);
+        for (size_t i = 0; i < batch->members.size(); i++) {
+            Flight& flight = *batch->members[i];
+            cache.put(flight.key, bodies[i]);
+            retire(batch->members[i]);
+            for (Waiter& w : flight.waiters) waiters.emplace_back(std::move(w), i);
+            flight.waiters.clear();
+        }
+    }
+    release(batch);
+    for (auto& w : waiters) respond(w.first.reply, w.first.id, w.first.cache, *bodies[w.second]);
+}
+
+void SimulateService::fail(const std::shared_ptr<Batch>& batch, const HttpResponse& error) {
+    std::vector<Waiter> waiters;
+    {
+        std::lock_guard<std::mutex> lock(mu);
+        close(batch);
+        std::vector<std::shared_ptr<Flight>> all = batch->members;
+        all.insert(all.end(), batch->joining.begin(), batch->joining.end());
+        batch->joining.clear();
+        for (auto& flight : all) {
+            retire(flight);
+            for (Waiter& w : flight->waiters) waiters.push_back(std::move(w));
+            flight->waiters.clear();
+        }
+    }
+    release(batch);
+    for (Waiter& w : waiters) {
+        HttpResponse r = error;
+        r.headers.emplace_back("X-Request-Id", w.id);
+        w.reply.send(r);
+    }
+}
+
+HttpResponse SimulateService::cancel(const std::string& id) {
+    std::shared_ptr<CancelToken> token;
+    {
+        std::lock_guard<std::mutex> lock(mu);
+        auto it = running.find(id);
+        if (it != running.end()) token = it->second;
+    }
+    if (!token) return jsonError(404, "Unknown request id", id);
+
+    token->cancel();
+    HttpResponse r;
+    r.status = 202;
+    r.body = json({{"request_id", id}, {"status", "cancelling"}}).dump();
+    return r;
+}
+
+HttpResponse SimulateService::stats() const {
+    Scheduler::Stats st = scheduler.stats();
+    json body;
+    for (Priority p : {Priority::INTERACTIVE, Priority::BATCH}) {
+        int c = (int)p;
+        body[priorityName(p)] = {{"running", st.running[c]},
+                                 {"waiting", st.waiting[c]},
+                                 {"slices", st.slices[c]}};
+    }
+    body["memory_bytes"] = st.memory;
+
+    ResultCache::Stats cs = cache.stats();
+    body["cache"] = {{"entries", cs.entries}, {"bytes", cs.bytes}, {"capacity", cs.capacity},
+                     {"hits", cs.hits}, {"misses", cs.misses}, {"evictions", cs.evictions}};
+    {
+        std::lock_guard<std::mutex> lock(mu);
+        body["coalescing"] = flights.size();
+        body["batches"] = batches.size();
+        body["batched"] = batched;
+    }
+
+    HttpResponse r;
+    r.body = body.dump();
+    return r;
+}
+
+// Ids end up in a response header and a URL path
+static bool validId(const std::string& id) {
+    if (id.empty() || id.size() > 64) return false;
+    for (char c : id)
+        if (!std::isalnum((unsigned char)c) && c != '-' && c != '_' && c != '.') return false;
+    return true;
+}
+
+std::shared_ptr<CancelToken> SimulateService::track(Request& request) {
+    if (!request.id.empty() && !validId(request.id))
+        throw std::invalid_argument("request_id: up to 64 letters, digits, '-', '_' or '.'");
+
+    std::lock_guard<std::mutex> lock(mu);
+    if (request.id.empty()) request.id = "run-" + std::to_string(next_id++);
+    auto token = std::make_shared<CancelToken>();
+    if (!running.emplace(request.id, token).second) return nullptr;
+    return token;
+}
+
+void SimulateService::untrack(const std::string& id) {
+    std::lock_guard<std::mutex> lock(mu);
+    running.erase(id);
+}
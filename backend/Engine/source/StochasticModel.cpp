@@ -0,0 +1,118 @@
+#include "../include/StochasticModel.hpp"
+#include "../include/MarketSimulator.hpp"
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+uint64_t mix(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+constexpr double kStart = 100.0;    // bar 0 of every path
+
+}
+
+std::unique_ptr<StochasticModel> StochasticModel::create(const std::string& market,
+                                                         const ModelParams& params) {
+    if (market == "GBM") return std::make_unique<GbmModel>(params);
+    if (market == "GARCH") return std::make_unique<GarchModel>(params);
+    if (market == "Jumps") return std::make_unique<JumpModel>(params);
+    if (market == "Switching") return std::make_unique<SwitchingModel>(params);
+    return nullptr;
+}
+
+bool StochasticModel::isModel(const std::string& market) {
+    return market == "GBM" || market == "GARCH" || market == "Jumps" || market == "Switching";
+}
+
+uint64_t StochasticModel::pathKey(uint64_t seed) {
+    return mix(seed ^ 0x5EEDBA7C4ull);
+}
+
+void StochasticModel::advance(const uint64_t* keys, double* price, double* state, size_t n,
+                              uint64_t t, size_t steps, double* out, size_t stride) const {
+    if (n == 0 || steps == 0) return;
+    (kernels().*kernel)(coefficients, keys, price, state, n, t, steps, out, stride);
+}
+
+void StochasticModel::generate(const uint64_t* seeds, size_t n, size_t bars, double* out) const {
+    if (n == 0 || bars == 0) return;
+    std::vector<uint64_t> keys(n);
+    std::vector<double> price(n, kStart), state(n, initial);
+    for (size_t p = 0; p < n; p++) {
+        keys[p] = pathKey(seeds[p]);
+        out[p] = kStart;
+    }
+    advance(keys.data(), price.data(), state.data(), n, 0, bars - 1, out + n, n);
+}
+
+GbmModel::GbmModel(const ModelParams& params) : StochasticModel(&KernelTable::gbmPaths) {
+    if (!std::isfinite(params.mu) || !(params.sigma >= 0.0 && std::isfinite(params.sigma)))
+        throw std::invalid_argument("GBM: mu finite, sigma 0 or more");
+    coefficients.drift = params.mu - 0.5 * params.sigma * params.sigma;
+    coefficients.sigma = params.sigma;
+    walk_drift = kStart * params.mu;
+    walk_noise = kStart * params.sigma;
+}
+
+GarchModel::GarchModel(const ModelParams& params) : StochasticModel(&KernelTable::garchPaths) {
+    const double persistence = params.alpha + params.beta;
+    if (!std::isfinite(params.mu) || !(params.omega > 0.0 && std::isfinite(params.omega)) ||
+        !(params.alpha >= 0.0 && params.beta >= 0.0 && persistence < 1.0))
+        throw std::invalid_argument("GARCH: omega positive, alpha and beta 0 or more, "
+                                    "alpha + beta below 1");
+    coefficients.drift = params.mu;
+    coefficients.omega = params.omega;
+    coefficients.alpha = params.alpha;
+    coefficients.beta = params.beta;
+    initial = params.omega / (1.0 - persistence);
+    walk_drift = kStart * params.mu;
+    walk_noise = kStart * std::sqrt(initial);
+}
+
+JumpModel::JumpModel(const ModelParams& params) : StochasticModel(&KernelTable::jumpPaths) {
+    if (!std::isfinite(params.mu) || !(params.sigma >= 0.0 && std::isfinite(params.sigma)) ||
+        !(params.jump_rate >= 0.0 && params.jump_rate <= 1.0) ||
+        !(std::fabs(params.jump_mean) <= 1.0) || !(params.jump_sd >= 0.0 && params.jump_sd <= 1.0))
+        throw std::invalid_argument("Jumps: jump_rate within [0, 1], |jump_mean| and jump_sd "
+                                    "at most 1, sigma 0 or more");
+    const double lambda = params.jump_rate;
+    const double mean_jump = std::exp(params.jump_mean + 0.5 * params.jump_sd * params.jump_sd);
+    coefficients.drift = params.mu - 0.5 * params.sigma * params.sigma - lambda * (mean_jump - 1.0);
+    coefficients.sigma = params.sigma;
+    coefficients.jump_mean = params.jump_mean;
+    coefficients.jump_sd = params.jump_sd;
+    // P(N <= k) of the bar's jump count, Poisson(lambda)
+    double pk = std::exp(-lambda), cdf = pk;
+    for (int k = 0; k < kMaxJumps; k++) {
+        coefficients.jump_cdf[k] = cdf;
+        pk *= lambda / (k + 1);
+        cdf += pk;
+    }
+    walk_drift = kStart * params.mu;
+    walk_noise = kStart * std::sqrt(params.sigma * params.sigma +
+                                    lambda * (params.jump_mean * params.jump_mean +
+                                              params.jump_sd * params.jump_sd));
+}
+
+SwitchingModel::SwitchingModel(const ModelParams& params)
+    : StochasticModel(&KernelTable::switchingPaths) {
+    if (!(params.stay >= 0.0 && params.stay <= 1.0))
+        throw std::invalid_argument("Switching: stay within [0, 1]");
+    coefficients.switch_at[0] = params.stay;
+    coefficients.switch_at[1] = params.stay + 0.5 * (1.0 - params.stay);
+    const char* regimes[3] = {"Trending", "Sideways", "MeanReverting"};
+    for (int r = 0; r < 3; r++) {
+        MarketDynamics d = marketDynamics(regimes[r]);
+        coefficients.regime_drift[r] = d.drift;
+        coefficients.regime_reversion[r] = d.reversion;
+        coefficients.regime_mean[r] = d.mean;
+        coefficients.regime_noise[r] = d.noise;
+        walk_drift += d.drift / 3;
+        walk_noise += d.noise / 3;
+    }
+}
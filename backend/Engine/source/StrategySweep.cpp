@@ -0,0 +1,241 @@
+#include "../include/StrategySweep.hpp"
+#include "../include/Backtest.hpp"
+#include "../include/Request.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <string>
+
+#if defined(__APPLE__)
+#include <sys/sysctl.h>
+#elif !defined(_WIN32)
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr size_t L = kPathLanes;
+
+bool inLanes(const Strategy& strategy) {
+    if (strategy.stop_loss != 0.0 || strategy.take_profit != 0.0 ||
+        strategy.execution != Execution::CLOSE)
+        return false;
+    for (const auto* side : {&strategy.buy, &strategy.sell})
+        for (const Condition& c : *side)
+            if (c.timeframe != 1) return false;
+    return true;
+}
+
+// Backtester's checks, without building one
+void checkStrategy(const MarketSimulator& sim, const Strategy& strategy) {
+    if (!strategy.isValid(sim))
+        throw std::invalid_argument("Strategy references a signal that is not computed");
+    for (const auto* side : {&strategy.buy, &strategy.sell})
+        for (const Condition& c : *side)
+            if (c.cross != CrossSection::NONE)
+                throw std::invalid_argument("Cross-sectional rules need a portfolio of assets");
+    if (!(strategy.stop_loss >= 0.0 && strategy.stop_loss < 1.0))
+        throw std::invalid_argument("stop_loss: a fraction of the entry price, 0 to below 1");
+    if (!(strategy.take_profit >= 0.0 && std::isfinite(strategy.take_profit)))
+        throw std::invalid_argument("take_profit: a fraction of the entry price, 0 or more");
+}
+
+// rulesKey with the constants left out
+std::string shapeKey(const Strategy& strategy) {
+    Strategy shape = strategy;
+    for (auto* side : {&shape.buy, &shape.sell})
+        for (Condition& c : *side)
+            if (c.rhs_type == OperandType::CONSTANT) c.rhs_value = 0.0;
+    return rulesKey(shape);
+}
+
+size_t laneBars(const MarketSimulator& sim) {
+    return sim.bars() > (size_t)kFirstBar ? sim.bars() - kFirstBar : 0;
+}
+
+// Tiles of the first part of a run: each candidate runs kTrials tiles,
+// in turn, and the one with the least time per bar runs the rest
+class TileTuner {
+public:
+    static constexpr size_t kTrials = 2;
+
+    TileTuner(size_t fixed, size_t bar_bytes) {
+        if (fixed) {
+            best = fixed;
+            return;
+        }
+        // the reads of a tile fill half the L2; masks and books stay in L1
+        const size_t base = std::max<size_t>(1, l2CacheBytes() / 2 / bar_bytes);
+        for (size_t quarters : {1, 2, 4, 8})
+            candidates.push_back(std::max<size_t>(64, base * quarters / 4));
+        cost.assign(candidates.size(), 0.0);
+        best = candidates[2];
+    }
+
+    size_t next() const {
+        return trial < candidates.size() * kTrials ? candidates[trial % candidates.size()] : best;
+    }
+
+    void record(size_t bars, double seconds) {
+        const size_t k = candidates.size();
+        if (trial >= k * kTrials) return;
+        cost[trial % k] += seconds / (double)bars;
+        if (++trial == k * kTrials) best = candidates[std::min_element(cost.begin(), cost.end()) -
+                                                      cost.begin()];
+    }
+
+    // The tile the run settled on: the fastest if every candidate ran
+    size_t settled() const { return best; }
+
+private:
+    std::vector<size_t> candidates;
+    std::vector<double> cost;     // seconds per bar, summed over the trials
+    size_t trial = 0;
+    size_t best = 0;
+};
+
+} // namespace
+
+size_t l2CacheBytes() {
+#if defined(__APPLE__)
+    uint64_t size = 0;
+    size_t length = sizeof(size);
+    if (sysctlbyname("hw.l2cachesize", &size, &length, nullptr, 0) == 0 && size > 0)
+        return (size_t)size;
+#elif defined(_SC_LEVEL2_CACHE_SIZE)
+    long size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    if (size > 0) return (size_t)size;
+#endif
+    return (size_t)1 << 20;
+}
+
+StrategySweep::StrategySweep(const MarketSimulator& sim, const std::vector<Strategy>& strategies)
+    : sim(sim), list(strategies) {
+    if (sim.origin() != 0)
+        throw std::invalid_argument("A sweep runs on a simulator's bars from 0");
+    std::map<std::string, size_t> shape_of;
+    for (size_t s = 0; s < list.size(); s++) {
+        checkStrategy(sim, list[s]);
+        if (!inLanes(list[s])) {
+            others.push_back(s);
+            continue;
+        }
+        auto it = shape_of.emplace(shapeKey(list[s]), groups.size()).first;
+        if (it->second == groups.size()) groups.emplace_back();
+        groups[it->second].push_back(s);
+    }
+
+    // the prices, the mask bytes and every column a lane group reads
+    std::set<SignalType> read;
+    for (const auto& group : groups)
+        for (const auto* side : {&list[group[0]].buy, &list[group[0]].sell})
+            for (const Condition& c : *side) {
+                read.insert(c.lhs);
+                if (c.rhs_type == OperandType::SIGNAL) read.insert(c.rhs_signal);
+            }
+    bar_bytes = sizeof(double) + 2;
+    for (SignalType type : read)
+        bar_bytes += sim.getColumn(type).isSingle() ? sizeof(float) : sizeof(double);
+}
+
+size_t StrategySweep::blocks() const {
+    size_t count = 0;
+    for (const auto& group : groups) count += (group.size() + L - 1) / L;
+    return count;
+}
+
+std::vector<PathMetrics> StrategySweep::run(size_t tile_bars, size_t* tile) const {
+    std::vector<PathMetrics> out(list.size());
+    const size_t n = laneBars(sim);
+
+    // blocks of up to kPathLanes variants of one shape
+    struct Block {
+        const size_t* index;
+        size_t m;
+    };
+    std::vector<Block> blocks;
+    for (const auto& group : groups)
+        for (size_t b = 0; b < group.size(); b += L)
+            blocks.push_back({group.data() + b, std::min(L, group.size() - b)});
+    std::vector<LaneBook> books(blocks.size());
+
+    TileTuner tuner(tile_bars, bar_bytes);
+    Masks masks;
+    for (size_t from = 0; from < n && !blocks.empty();) {
+        const size_t to = std::min(n, from + tuner.next());
+        auto start = std::chrono::steady_clock::now();
+        for (size_t k = 0; k < blocks.size(); k++)
+            runBlock(blocks[k].index, blocks[k].m, from, to, books[k], masks);
+        tuner.record(to - from, std::chrono::duration<double>(
+                                    std::chrono::steady_clock::now() - start).count());
+        from = to;
+    }
+    if (tile) *tile = tuner.settled();
+
+    for (size_t k = 0; k < blocks.size(); k++)
+        for (size_t l = 0; l < blocks[k].m; l++) {
+            PathMetrics& m = out[blocks[k].index[l]];
+            m.total_pnl = books[k].equity[l];
+            m.num_trades = (int)books[k].trades[l];
+            m.win_count = (int)books[k].wins[l];
+            m.max_drawdown = books[k].drawdown[l];
+        }
+    for (size_t s : others) {
+        BacktestResult r = runBacktest(sim, list[s]);
+        out[s] = {r.total_pnl, r.num_trades, r.win_count, r.max_drawdown};
+    }
+    return out;
+}
+
+// AND one side's rules of variants index[0 .. m) into one byte per bar
+// for bars kFirstBar + [from, to), bit l = variant l; lanes past m
+// repeat the last one
+void StrategySweep::ruleMask(const size_t* index, size_t m, bool buy, size_t from, size_t to,
+                             std::vector<uint8_t>& mask, std::vector<uint8_t>& bits) const {
+    auto side = [&](size_t l) -> const std::vector<Condition>& {
+        const Strategy& s = list[index[std::min(l, m - 1)]];
+        return buy ? s.buy : s.sell;
+    };
+    const std::vector<Condition>& rules = side(0);
+    const size_t n = to - from;
+    mask.assign(n, rules.empty() ? 0x00 : 0xFF);
+    const KernelTable& k = kernels();
+    const size_t at = kFirstBar + from;
+
+    for (size_t j = 0; j < rules.size(); j++) {
+        const Condition& c = rules[j];
+        const SignalColumn& lhs = sim.getColumn(c.lhs);
+        if (c.rhs_type == OperandType::SIGNAL) {
+            // the same for every variant: a bit per bar, spread to the lanes
+            const SignalColumn& rhs = sim.getColumn(c.rhs_signal);
+            bits.assign((n + 7) / 8, 0xFF);
+            if (lhs.isSingle())
+                k.compareF32(lhs.f32() + at, rhs.f32() + at, 0.0f, c.op, bits.data(), n);
+            else
+                k.compareF64(lhs.f64() + at, rhs.f64() + at, 0.0, c.op, bits.data(), n);
+            for (size_t i = 0; i < n; i++) mask[i] &= (uint8_t)-((bits[i >> 3] >> (i & 7)) & 1);
+            continue;
+        }
+        double threshold[L];
+        float narrow[L];
+        for (size_t l = 0; l < L; l++) {
+            threshold[l] = side(l)[j].rhs_value;
+            narrow[l] = (float)threshold[l];
+        }
+        if (lhs.isSingle())
+            k.thresholdF32(lhs.f32() + at, narrow, c.op, mask.data(), n);
+        else
+            k.thresholdF64(lhs.f64() + at, threshold, c.op, mask.data(), n);
+    }
+}
+
+void StrategySweep::runBlock(const size_t* index, size_t m, size_t from, size_t to,
+                             LaneBook& book, Masks& masks) const {
+    ruleMask(index, m, true, from, to, masks.buy, masks.bits);
+    ruleMask(index, m, false, from, to, masks.sell, masks.bits);
+    kernels().variantBacktest(sim.getPrices().data() + kFirstBar + from, masks.buy.data(),
+                              masks.sell.data(), to - from, book);
+}
@@ -0,0 +1,73 @@
+#include "../include/TradeLog.hpp"
+#include "../include/JsonWriter.hpp"
+
+void TradeLog::reserve(size_t n) {
+    bar.reserve(n);
+    side.reserve(n);
+    price.reserve(n);
+    pnl.reserve(n);
+    entry.reserve(n);
+}
+
+void TradeLog::clear() {
+    bar.clear();
+    side.clear();
+    price.clear();
+    pnl.clear();
+    entry.clear();
+}
+
+void TradeLog::recordBuy(int64_t t, double p) {
+    bar.push_back(t);
+    side.push_back(Side::BUY);
+    price.push_back(p);
+    pnl.push_back(0.0);
+    entry.push_back(t);
+}
+
+void TradeLog::recordSell(int64_t t, double p, double realized, int64_t entry_t) {
+    bar.push_back(t);
+    side.push_back(Side::SELL);
+    price.push_back(p);
+    pnl.push_back(realized);
+    entry.push_back(entry_t);
+}
+
+void TradeLog::appendJson(std::string& out, size_t from, size_t to) const {
+    out.reserve(out.size() + (to - from) * 64 + 2);
+    out += '[';
+    for (size_t i = from; i < to; i++) {
+        if (i > from) out += ',';
+        if (side[i] == Side::SELL) {
+            out += "{\"pnl\":";
+            appendNumber(out, pnl[i]);
+            out += ",\"price\":";
+        } else {
+            out += "{\"price\":";
+        }
+        appendNumber(out, price[i]);
+        out += ",\"t\":";
+        appendNumber(out, bar[i]);
+        out += side[i] == Side::SELL ? ",\"type\":\"SELL\"}" : ",\"type\":\"BUY\"}";
+    }
+    out += ']';
+}
+
+void TradeLog::writeBinary(std::ostream& out) const {
+    const uint32_t version = 1;
+    const uint64_t count = size();
+
+    out.write("AXTL", 4);
+    out.write(reinterpret_cast<const char*>(&version), sizeof(version));
+    out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+
+    auto column = [&](const auto& v) {
+        out.write(reinterpret_cast<const char*>(v.data()),
+                  (std::streamsize)(v.size() * sizeof(v[0])));
+    };
+    column(bar);
+    column(side);
+    column(price);
+    column(pnl);
+    column(entry);
+}
@@ -0,0 +1,977 @@
+#include "../include/axiom.h"
+#include "../include/AgentMarket.hpp"
+#include "../include/Backtest.hpp"
+#include "../include/Kernels.hpp"
+#include "../include/MultiAsset.hpp"
+#include "../include/OrderBook.hpp"
+#include "../include/PathBatch.hpp"
+#include "../include/PathLibrary.hpp"
+#include "../include/Pipeline.hpp"
+#include "../include/Portfolio.hpp"
+#include "../include/PriceSource.hpp"
+#include "../include/Request.hpp"
+#include "../include/RequestParser.hpp"
+#include "../include/StochasticModel.hpp"
+#include "../include/StrategySweep.hpp"
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using json = nlohmann::json;
+
+// Handles are thin owners around the C++ engine objects. The simulator
+// is shared so a result can outlive the axiom_sim that produced it.
+struct axiom_sim {
+    std::shared_ptr<MarketSimulator> sim;
+    bool generated = false;
+    bool signals = false;
+};
+
+struct axiom_result {
+    std::shared_ptr<const MarketSimulator> sim;
+    size_t first = 0;       // first bar of the output, > 0 if resumed
+    BacktestResult result;
+    RunStatus status = RunStatus::COMPLETED;
+    std::string json;
+};
+
+struct axiom_cancel {
+    CancelToken token;
+};
+
+struct axiom_assets {
+    std::shared_ptr<MultiAssetMarket> market;
+    bool generated = false;
+};
+
+struct axiom_portfolio {
+    PortfolioResult result;
+};
+
+static thread_local std::string last_error;
+
+static int fail(int status, const std::string& message) {
+    last_error = message;
+    return status;
+}
+
+template <typename T>
+static T* failNull(int status, const std::string& message) {
+    fail(status, message);
+    return nullptr;
+}
+
+// Run fn, translating C++ exceptions into a status code
+template <typename Fn>
+static int guarded(Fn fn) {
+    try {
+        return fn();
+    } catch (const json::exception& e) {
+        return fail(AXIOM_ERR_PARSE, e.what());
+    } catch (const std::invalid_argument& e) {
+        return fail(AXIOM_ERR_ARGUMENT, e.what());
+    } catch (const std::exception& e) {
+        return fail(AXIOM_ERR_INTERNAL, e.what());
+    } catch (...) {
+        return fail(AXIOM_ERR_INTERNAL, "unknown error");
+    }
+}
+
+static int exportColumn(const SignalColumn& col, const void** data,
+                        size_t* length, int* dtype) {
+    *length = col.size();
+    if (col.isSingle()) {
+        *data = col.f32();
+        *dtype = AXIOM_F32;
+    } else {
+        *data = col.f64();
+        *dtype = AXIOM_F64;
+    }
+    return AXIOM_OK;
+}
+
+template <typename T>
+static int exportVector(const T& v, int type, const void** data,
+                        size_t* length, int* dtype) {
+    *data = v.data();
+    *length = v.size();
+    *dtype = type;
+    return AXIOM_OK;
+}
+
+// Prices of the bars a result covers
+static const double* resultPrices(const axiom_result* r, size_t* count) {
+    *count = r->sim->bars() - r->first;
+    return r->sim->getPrices().data() + (r->first - r->sim->origin());
+}
+
+static Request parseOrFail(const char* request_json, size_t length, bool& ok) {
+    ok = false;
+    Request req;
+    try {
+        req = parseRequestText(request_json, length);
+        ok = true;
+    } catch (const json::parse_error&) {
+        fail(AXIOM_ERR_PARSE, "Invalid JSON input");
+    } catch (const std::exception& e) {
+        fail(AXIOM_ERR_PARSE, e.what());
+    }
+    return req;
+}
+
+// Resume and/or schedule snapshots as the options ask; an unreadable or
+// mismatched snapshot is the caller's argument error
+static void applyCheckpoint(Pipeline& pipeline, const axiom_checkpoint* checkpoint) {
+    if (!checkpoint) return;
+    if (checkpoint->resume_path) {
+        std::ifstream in(checkpoint->resume_path, std::ios::binary);
+        if (!in) throw std::invalid_argument("Cannot open checkpoint");
+        try {
+            pipeline.restore(in);
+        } catch (const std::runtime_error& e) {
+            throw std::invalid_argument(e.what());
+        }
+    }
+    if (checkpoint->save_path)
+        pipeline.checkpointTo(checkpoint->save_path, (size_t)checkpoint->every_bars);
+}
+
+extern "C" {
+
+int axiom_abi_version(void) {
+    return AXIOM_ABI_VERSION;
+}
+
+const char* axiom_last_error(void) {
+    return last_error.c_str();
+}
+
+int axiom_set_isa(const char* name) {
+    Isa isa;
+    if (!name || !parseIsa(name, isa))
+        return fail(AXIOM_ERR_ARGUMENT, "Unknown ISA");
+    if (!selectIsa(isa))
+        return fail(AXIOM_ERR_ARGUMENT, "Unsupported ISA");
+    return AXIOM_OK;
+}
+
+const char* axiom_isa(void) {
+    return isaName(kernels().isa);
+}
+
+// --- Path library ---
+
+int axiom_library_generate(const char* path, const char* markets,
+                           uint32_t first_seed, uint32_t seed_count,
+                           int timesteps, int threads) {
+    if (!path || !markets) return fail(AXIOM_ERR_ARGUMENT, "null argument");
+    return guarded([&] {
+        std::vector<std::string> names;
+        std::string list = markets;
+        for (size_t at = 0; at <= list.size();) {
+            size_t comma = std::min(list.find(',', at), list.size());
+            if (comma > at) names.push_back(list.substr(at, comma - at));
+            at = comma + 1;
+        }
+        std::vector<uint32_t> seeds;
+        for (uint32_t i = 0; i < seed_count; i++) seeds.push_back(first_seed + i);
+        PathLibrary::generate(path, names, seeds, timesteps, threads);
+        return AXIOM_OK;
+    });
+}
+
+int axiom_library_use(const char* path) {
+    if (!path) {
+        PathLibrary::install(nullptr);
+        return AXIOM_OK;
+    }
+    return guarded([&] {
+        try {
+            PathLibrary::install(std::make_shared<PathLibrary>(path));
+        } catch (const std::runtime_error& e) {
+            throw std::invalid_argument(e.what());
+        }
+        return AXIOM_OK;
+    });
+}
+
+// --- Recorded prices ---
+
+int axiom_prices_convert(const char* csv_path, const char* column, const char* out_path,
+                         uint64_t* bars) {
+    if (!csv_path || !out_path) return fail(AXIOM_ERR_ARGUMENT, "null path");
+    return guarded([&] {
+        std::shared_ptr<const PriceSource> source;
+        try {
+            source = loadPrices(csv_path, column ? column : "");
+        } catch (const std::runtime_error& e) {
+            throw std::invalid_argument(e.what());
+        }
+        PriceSpan prices = source->prices();
+        std::ofstream out(out_path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(prices.data()),
+                  (std::streamsize)(prices.size() * sizeof(double)));
+        if (!out) throw std::runtime_error(std::string("Cannot write ") + out_path);
+        if (bars) *bars = prices.size();
+        return AXIOM_OK;
+    });
+}
+
+// --- Simulator ---
+
+axiom_sim* axiom_sim_create(const char* market, int timesteps,
+                            uint32_t seed, int float32_signals) {
+    if (timesteps < 1)
+        return failNull<axiom_sim>(AXIOM_ERR_ARGUMENT, "timesteps must be positive");
+
+    axiom_sim* handle = nullptr;
+    guarded([&] {
+        json input = {
+            {"market", market ? market : "Trending"},
+            {"timesteps", timesteps},
+            {"seed", seed},
+            {"precision", float32_signals ? "float32" : "float64"}
+        };
+        Request req = parseRequest(input);
+        handle = new axiom_sim;
+        handle->sim = std::make_shared<MarketSimulator>(req.config);
+        return AXIOM_OK;
+    });
+    return handle;
+}
+
+void axiom_sim_destroy(axiom_sim* sim) {
+    delete sim;
+}
+
+int axiom_sim_use_prices(axiom_sim* sim, const char* path, const char* column) {
+    if (!sim || !path) return fail(AXIOM_ERR_ARGUMENT, "null simulator or path");
+    return guarded([&] {
+        try {
+            sim->sim->usePrices(loadPrices(path, column ? column : ""));
+        } catch (const std::runtime_error& e) {
+            throw std::invalid_argument(e.what());
+        }
+        sim->generated = false;
+        sim->signals = false;
+        return AXIOM_OK;
+    });
+}
+
+int axiom_sim_generate(axiom_sim* sim) {
+    if (!sim) return fail(AXIOM_ERR_ARGUMENT, "null simulator");
+    return guarded([&] {
+        if (!sim->sim->borrowsPrices()) useLibraryPrices(*sim->sim);
+        sim->sim->runMarket();
+        sim->generated = true;
+        sim->signals = false;
+        return AXIOM_OK;
+    });
+}
+
+int axiom_sim_compute_signals(axiom_sim* sim) {
+    if (!sim) return fail(AXIOM_ERR_ARGUMENT, "null simulator");
+    if (!sim->generated) return fail(AXIOM_ERR_STATE, "generate before computing signals");
+    return guarded([&] {
+        computeAllSignals(*sim->sim);
+        sim->signals = true;
+        return AXIOM_OK;
+    });
+}
+
+int axiom_sim_column(const axiom_sim* sim, int column,
+                     const void** data, size_t* length, int* dtype) {
+    if (!sim || !data || !length || !dtype)
+        return fail(AXIOM_ERR_ARGUMENT, "null argument");
+    if (!sim->generated) return fail(AXIOM_ERR_STATE, "simulator not generated");
+
+    const MarketSimulator& s = *sim->sim;
+    return guarded([&] {
+        switch (column) {
+            case AXIOM_COL_PRICE:
+                return exportVector(s.getPrices(), AXIOM_F64, data, length, dtype);
+            case AXIOM_COL_MA_SHORT:
+                return exportColumn(s.getColumn(SignalType::MA_SHORT), data, length, dtype);
+            case AXIOM_COL_MA_LONG:
+                return exportColumn(s.getColumn(SignalType::MA_LONG), data, length, dtype);
+            case AXIOM_COL_RSI:
+                return exportColumn(s.getColumn(SignalType::RSI), data, length, dtype);
+            case AXIOM_COL_VOLATILITY:
+                return exportColumn(s.getColumn(SignalType::VOLATILITY), data, length, dtype);
+            case AXIOM_COL_VOLATILITY_MA:
+                return exportColumn(s.getColumn(SignalType::VOLATILITY_MA), data, length, dtype);
+            default:
+                return fail(AXIOM_ERR_ARGUMENT, "not a simulator column");
+        }
+    });
+}
+
+int axiom_sim_add_timeframe(axiom_sim* sim, int bars) {
+    if (!sim) return fail(AXIOM_ERR_ARGUMENT, "null simulator");
+    return guarded([&] {
+        sim->sim->addTimeframe(bars);
+        return AXIOM_OK;
+    });
+}
+
+int axiom_sim_timeframe_column(const axiom_sim* sim, int bars, int column,
+                               const void** data, size_t* length, int* dtype) {
+    if (!sim || !data || !length || !dtype)
+        return fail(AXIOM_ERR_ARGUMENT, "null argument");
+    if (!sim->generated) return fail(AXIOM_ERR_STATE, "simulator not generated");
+
+    const MarketSimulator* frame = sim->sim->timeframe(bars);
+    if (!frame) return fail(AXIOM_ERR_ARGUMENT, "timeframe not added");
+    const Resampler& r = sim->sim->timeframes();
+    size_t i = 0;
+    while (r.frameSize(i) != bars) i++;
+    const PriceSeries& ohlcv = r.frame(i);
+
+    return guarded([&] {
+        switch (column) {
+            case AXIOM_COL_OPEN: return exportVector(ohlcv.open, AXIOM_F64, data, length, dtype);
+            case AXIOM_COL_HIGH: return exportVector(ohlcv.high, AXIOM_F64, data, length, dtype);
+            case AXIOM_COL_LOW: return exportVector(ohlcv.low, AXIOM_F64, data, length, dtype);
+            case AXIOM_COL_PRICE: return exportVector(ohlcv.close, AXIOM_F64, data, length, dtype);
+            case AXIOM_COL_VOLUME: return exportVector(ohlcv.volume, AXIOM_F64, data, length, dtype);
+            case AXIOM_COL_MA_SHORT:
+                return exportColumn(frame->getColumn(SignalType::MA_SHORT), data, length, dtype);
+            case AXIOM_COL_MA_LONG:
+                return exportColumn(frame->getColumn(SignalType::MA_LONG), data, length, dtype);
+            case AXIOM_COL_RSI:
+                return exportColumn(frame->getColumn(SignalType::RSI), data, length, dtype);
+            case AXIOM_COL_VOLATILITY:
+                return exportColumn(frame->getColumn(SignalType::VOLATILITY), data, length, dtype);
+            case AXIOM_COL_VOLATILITY_MA:
+                return exportColumn(frame->getColumn(SignalType::VOLATILITY_MA), data, length, dtype);
+            default:
+                return fail(AXIOM_ERR_ARGUMENT, "not a timeframe column");
+        }
+    });
+}
+
+axiom_result* axiom_sim_run_strategy(axiom_sim* sim, const char* strategy_json,
+                                     size_t length) {
+    if (!sim || !strategy_json)
+        return failNull<axiom_result>(AXIOM_ERR_ARGUMENT, "null argument");
+    if (!sim->signals)
+        return failNull<axiom_result>(AXIOM_ERR_STATE, "compute signals before running a strategy");
+
+    axiom_result* handle = nullptr;
+    guarded([&] {
+        Strategy strategy = parseStrategy(json::parse(strategy_json, strategy_json + length));
+        auto res = std::make_unique<axiom_result>();
+        res->sim = sim->sim;
+        strategy.addTimeframes(*sim->sim);
+        res->result = runBacktest(*sim->sim, strategy);
+        handle = res.release();
+        return AXIOM_OK;
+    });
+    return handle;
+}
+
+// --- Multi-asset markets ---
+
+axiom_assets* axiom_assets_create(const char* market, size_t assets, int timesteps,
+                                  uint64_t seed, const double* correlation,
+                                  double rho, int asset_major, int threads) {
+    axiom_assets* handle = nullptr;
+    guarded([&] {
+        MultiAssetConfig cfg;
+        // same market names as a simulator
+        cfg.market = parseRequest(json{{"market", market ? market : "Sideways"}}).config.market;
+        cfg.assets = assets;
+        cfg.timesteps = timesteps;
+        cfg.seed = seed;
+        if (correlation) cfg.correlation.assign(correlation, correlation + assets * assets);
+        cfg.rho = rho;
+        cfg.layout = asset_major ? AssetLayout::ASSET_MAJOR : AssetLayout::TIME_MAJOR;
+        cfg.threads = threads;
+        auto res = std::make_unique<axiom_assets>();
+        res->market = std::make_shared<MultiAssetMarket>(std::move(cfg));
+        handle = res.release();
+        return AXIOM_OK;
+    });
+    return handle;
+}
+
+int axiom_assets_generate(axiom_assets* market) {
+    if (!market) return fail(AXIOM_ERR_ARGUMENT, "null argument");
+    return guarded([&] {
+        market->market->generate();
+        market->generated = true;
+        return AXIOM_OK;
+    });
+}
+
+int axiom_assets_prices(const axiom_assets* market, const double** data,
+                        size_t* assets, size_t* bars) {
+    if (!market || !data || !assets || !bars) return fail(AXIOM_ERR_ARGUMENT, "null argument");
+    if (!market->generated) return fail(AXIOM_ERR_STATE, "market not generated");
+    *data = market->market->prices();
+    *assets = market->market->assets();
+    *bars = market->market->bars();
+    return AXIOM_OK;
+}
+
+void axiom_assets_destroy(axiom_assets* market) {
+    delete market;
+}
+
+axiom_portfolio* axiom_assets_run_strategy(const axiom_assets* market,
+                                           const char* strategy_json, size_t length,
+                                           int threads, axiom_cancel* cancel) {
+    if (!market || !strategy_json)
+        return failNull<axiom_portfolio>(AXIOM_ERR_ARGUMENT, "null argument");
+    if (!market->generated)
+        return failNull<axiom_portfolio>(AXIOM_ERR_STATE, "market not generated");
+
+    axiom_portfolio* handle = nullptr;
+    guarded([&] {
+        Strategy strategy = parseStrategy(json::parse(strategy_json, strategy_json + length));
+        PortfolioOptions options;
+        options.threads = threads;
+        options.cancel = cancel ? &cancel->token : nullptr;
+        auto res = std::make_unique<axiom_portfolio>();
+        res->result = runPortfolio(*market->market, strategy, options);
+        handle = res.release();
+        return AXIOM_OK;
+    });
+    return handle;
+}
+
+int axiom_portfolio_status(const axiom_portfolio* portfolio, int* status) {
+    if (!portfolio || !status) return fail(AXIOM_ERR_ARGUMENT, "null argument");
+    switch (portfolio->result.status) {
+        case RunStatus::CANCELLED: *status = AXIOM_RUN_CANCELLED; break;
+        case RunStatus::DEADLINE_EXCEEDED: *status = AXIOM_RUN_DEADLINE_EXCEEDED; break;
+        default: *status = AXIOM_RUN_COMPLETED; break;
+    }
+    return AXIOM_OK;
+}
+
+int axiom_portfolio_metrics(const axiom_portfolio* portfolio, axiom_metrics* out) {
+    if (!portfolio || !out) return fail(AXIOM_ERR_ARGUMENT, "null argument");
+    const PortfolioResult& r = portfolio->result;
+    out->total_pnl = r.total_pnl;
+    out->num_trades = r.num_trades;
+    out->win_rate = r.num_trades > 0 ? (double)r.win_count / r.num_trades : 0.0;
+    out->max_drawdown = r.max_drawdown;
+    return AXIOM_OK;
+}
+
+int axiom_portfolio_column(const axiom_portfolio* portfolio, int column,
+                           const void** data, size_t* length, int* dtype) {
+    if (!portfolio || !data || !length || !dtype)
+        return fail(AXIOM_ERR_ARGUMENT, "null argument");
+    const PortfolioResult& r = portfolio->result;
+    switch (column) {
+        case AXIOM_COL_EQUITY: return exportVector(r.equity, AXIOM_F64, data, length, dtype);
+        case AXIOM_COL_OPEN_POSITIONS: return exportVector(r.open, AXIOM_I64, data, length, dtype);
+        case AXIOM_COL_ASSET_PNL: return exportVector(r.asset_pnl, AXIOM_F64, data, length, dtype);
+        case AXIOM_COL_ASSET_TRADES:
+            return exportVector(r.asset_trades, AXIOM_I64, data, length, dtype);
+        default: return fail(AXIOM_ERR_ARGUMENT, "not a portfolio column");
+    }
+}
+
+void axiom_portfolio_destroy(axiom_portfolio* portfolio) {
+    delete portfolio;
+}
+
+// --- Order book ---
+
+int axiom_book_benchmark(const char* market, uint64_t events, uint32_t seed,
+                         axiom_book_bench* out) {
+    if (!market || !out) return fail(AXIOM_ERR_ARGUMENT, "null argument");
+    if (events < 1 || events > (uint64_t)INT32_MAX * 64)
+        return fail(AXIOM_ERR_ARGUMENT, "events: 1 to 2^37");
+    return guarded([&] {
+        OrderFlowOptions options;
+        Config cfg;
+        cfg.market = marketFromString(market);
+        cfg.timesteps = (int)((events + options.events_per_bar - 1) / options.events_per_bar);
+        cfg.seed = seed;
+        MarketSimulator sim(cfg);
+        sim.runMarket();
+
+        const auto& prices = sim.getPrices();
+        OrderBook book(0);
+        OrderFlow flow(sim.dynamics(), seed, options);
+        auto start = std::chrono::steady_clock::now();
+        for (size_t t = 0; t < prices.size(); t++) flow.bar(book, t, prices[t]);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+                             .count();
+
+        const OrderBook::Stats& stats = book.stats();
+        out->events = flow.events();
+        out->seconds = seconds;
+        out->events_per_second = seconds > 0.0 ? flow.events() / seconds : 0.0;
+        out->adds = stats.adds;
+        out->cancels = stats.cancels;
+        out->fills = stats.fills;
+        out->volume = stats.volume;
+        return AXIOM_OK;
+    });
+}
+
+// --- Agent-based market ---
+
+int axiom_agents_benchmark(uint64_t agents, uint64_t steps, uint64_t seed, int threads,
+                           axiom_agents_bench* out) {
+    if (!out) return fail(AXIOM_ERR_ARGUMENT, "null argument");
+    if (steps < 1 || steps > (uint64_t)INT32_MAX) return fail(AXIOM_ERR_ARGUMENT, "steps: 1 to 2^31");
+    if (threads < 0) return fail(AXIOM_ERR_ARGUMENT, "threads: 0 or more");
+    return guarded([&] {
+        AgentMarketConfig cfg;
+        cfg.agents = (size_t)agents;
+        cfg.seed = seed;
+        cfg.threads = threads;
+        AgentMarket market(cfg);
+
+        Series<double> prices;
+        prices.reserve(steps + 1);
+        prices.push_back(100.0);
+        auto start = std::chrono::steady_clock::now();
+        market.extend(prices, 0, steps + 1);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+                             .count();
+
+        out->agents = agents;
+        out->steps = steps;
+        out->threads = market.threads();
+        out->seconds = seconds;
+        out->agent_steps_per_second = seconds > 0.0 ? (double)agents * steps / seconds : 0.0;
+        out->last_price = prices.back();
+        return AXIOM_OK;
+    });
+}
+
+// --- Stochastic models ---
+
+int axiom_model_benchmark(const char* market, uint64_t paths, uint64_t bars, uint64_t seed,
+                          axiom_model_bench* out) {
+    if (!market || !out) return fail(AXIOM_ERR_ARGUMENT, "null argument");
+    if (paths < 1 || bars < 2 || paths * bars > (uint64_t)1 << 28)
+        return fail(AXIOM_ERR_ARGUMENT, "paths x bars: 2 to 2^28");
+    std::string name = marketFromString(market);
+    if (!StochasticModel::isModel(name)) return fail(AXIOM_ERR_ARGUMENT, "not a model market");
+    return guarded([&] {
+        auto model = StochasticModel::create(name, ModelParams());
+        std::vector<uint64_t> seeds(paths);
+        for (uint64_t p = 0; p < paths; p++) seeds[p] = seed + p;
+        std::vector<double> prices(paths * bars);
+        auto start = std::chrono::steady_clock::now();
+        model->generate(seeds.data(), paths, bars, prices.data());
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+                             .count();
+
+        // the walk a path at a time, on up to 64 paths
+        const uint64_t walks = std::min<uint64_t>(paths, 64);
+        Config cfg;
+        cfg.timesteps = (int)bars;
+        start = std::chrono::steady_clock::now();
+        for (uint64_t p = 0; p < walks; p++) {
+            cfg.seed = (unsigned)(seed + p);
+            MarketSimulator sim(cfg);
+            sim.runMarket();
+        }
+        double walk = std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+                          .count();
+
+        double last = 0.0;
+        for (uint64_t p = 0; p < paths; p++) last += prices[(bars - 1) * paths + p];
+        out->paths = paths;
+        out->bars = bars;
+        out->seconds = seconds;
+        out->ns_per_path_bar = seconds * 1e9 / ((double)paths * bars);
+        out->walk_ns_per_path_bar = walk * 1e9 / ((double)walks * bars);
+        out->mean_last_price = last / paths;
+        return AXIOM_OK;
+    });
+}
+
+// --- Path blocks ---
+
+static void exportMetrics(const PathMetrics& m, axiom_metrics* out) {
+    out->total_pnl = m.total_pnl;
+    out->num_trades = m.num_trades;
+    out->win_rate = m.num_trades > 0 ? (double)m.win_count / m.num_trades : 0.0;
+    out->max_drawdown = m.max_drawdown;
+}
+
+int axiom_paths_run(const char* request_json, size_t length, const uint32_t* seeds,
+                    size_t count, int threads, axiom_metrics* out) {
+    if (!request_json || (count && (!seeds || !out)))
+        return fail(AXIOM_ERR_ARGUMENT, "null argument");
+    bool parsed;
+    Request req = parseOrFail(request_json, length, parsed);
+    if (!parsed) return AXIOM_ERR_PARSE;
+    return guarded([&] {
+        std::vector<PathMetrics> metrics =
+            runPaths(req.config, {req.strategy}, std::vector<uint32_t>(seeds, seeds + count),
+                     threads);
+        for (size_t i = 0; i < count; i++) exportMetrics(metrics[i], out + i);
+        return AXIOM_OK;
+    });
+}
+
+int axiom_paths_benchmark(const char* request_json, size_t length, uint64_t paths,
+                          axiom_paths_bench* out) {
+    if (!request_json || !out) return fail(AXIOM_ERR_ARGUMENT, "null argument");
+    if (paths < 1 || paths > (uint64_t)1 << 24) return fail(AXIOM_ERR_ARGUMENT, "paths: 1 to 2^24");
+    bool parsed;
+    Request req = parseOrFail(request_json, length, parsed);
+    if (!parsed) return AXIOM_ERR_PARSE;
+    return guarded([&] {
+        std::vector<uint32_t> seeds(paths);
+        for (uint64_t p = 0; p < paths; p++) seeds[p] = req.config.seed + (uint32_t)p;
+        auto start = std::chrono::steady_clock::now();
+        std::vector<PathMetrics> lanes = runPaths(req.config, {req.strategy}, seeds, 1);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+                             .count();
+
+        int identical = 1;
+        start = std::chrono::steady_clock::now();
+        for (uint64_t p = 0; p < paths; p++) {
+            Config cfg = req.config;
+            cfg.seed = seeds[p];
+            MarketSimulator sim(cfg);
+            sim.runMarket();
+            computeAllSignals(sim);
+            BacktestResult r = runBacktest(sim, req.strategy);
+            const PathMetrics& m = lanes[p];
+            if (r.total_pnl != m.total_pnl || r.num_trades != m.num_trades ||
+                r.win_count != m.win_count || r.max_drawdown != m.max_drawdown)
+                identical = 0;
+        }
+        double serial = std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+                            .count();
+
+        const uint64_t bars = req.config.timesteps > 0 ? (uint64_t)req.config.timesteps : 1;
+        out->paths = paths;
+        out->bars = bars;
+        out->seconds = seconds;
+        out->serial_seconds = serial;
+        out->path_bars_per_second = seconds > 0.0 ? (double)paths * bars / seconds : 0.0;
+        out->identical = identical;
+        return AXIOM_OK;
+    });
+}
+
+// --- Strategy sweeps ---
+
+// The request's market run to the end with every indicator and the
+// timeframes the strategies read, as a Pipeline prepares it
+static std::unique_ptr<MarketSimulator> sweepMarket(const Config& cfg,
+                                                    const std::vector<Strategy>& strategies) {
+    auto sim = std::make_unique<MarketSimulator>(cfg);
+    if (!cfg.prices_file.empty())
+        sim->usePrices(loadPrices(cfg.prices_file, cfg.prices_column));
+    else
+        useLibraryPrices(*sim);
+    sim->extendMarket(1);
+    computeAllSignals(*sim);
+    for (const Strategy& s : strategies) s.addTimeframes(*sim);
+    sim->extendMarket((size_t)std::max(cfg.timesteps, 1));
+    sim->extendSignals();
+    return sim;
+}
+
+// Variant v of `strategy`: every constant of its rules scaled by
+// 0.5 + v / count
+static std::vector<Strategy> sweepVariants(const Strategy& strategy, uint64_t count) {
+    std::vector<Strategy> variants(count, strategy);
+    for (uint64_t v = 0; v < count; v++) {
+        const double scale = 0.5 + (double)v / (double)count;
+        for (auto* side : {&variants[v].buy, &variants[v].sell})
+            for (Condition& c : *side)
+                if (c.rhs_type == OperandType::CONSTANT) c.rhs_value *= scale;
+    }
+    return variants;
+}
+
+int axiom_sweep_run(const char* request_json, size_t length, const char* strategies_json,
+                    size_t strategies_length, axiom_metrics* out, size_t count) {
+    if (!request_json || !strategies_json || (count && !out))
+        return fail(AXIOM_ERR_ARGUMENT, "null argument");
+    bool parsed;
+    Request req = parseOrFail(request_json, length, parsed);
+    if (!parsed) return AXIOM_ERR_PARSE;
+    return guarded([&] {
+        json list = json::parse(strategies_json, strategies_json + strategies_length);
+        if (!list.is_array() || list.size() != count)
+            throw std::invalid_argument("strategies: an array of count strategies");
+        std::vector<Strategy> strategies;
+        for (const json& j : list) strategies.push_back(parseStrategy(j));
+        auto sim = sweepMarket(req.config, strategies);
+        std::vector<PathMetrics> metrics = StrategySweep(*sim, strategies).run();
+        for (size_t i = 0; i < count; i++) exportMetrics(metrics[i], out + i);
+        return AXIOM_OK;
+    });
+}
+
+int axiom_sweep_benchmark(const char* request_json, size_t length, uint64_t strategies,
+                          axiom_sweep_bench* out) {
+    if (!request_json || !out) return fail(AXIOM_ERR_ARGUMENT, "null argument");
+    if (strategies < 1 || strategies > (uint64_t)1 << 20)
+        return fail(AXIOM_ERR_ARGUMENT, "strategies: 1 to 2^20");
+    bool parsed;
+    Request req = parseOrFail(request_json, length, parsed);
+    if (!parsed) return AXIOM_ERR_PARSE;
+    return guarded([&] {
+        std::vector<Strategy> variants = sweepVariants(req.strategy, strategies);
+        auto sim = sweepMarket(req.config, variants);
+
+        auto start = std::chrono::steady_clock::now();
+        StrategySweep sweep(*sim, variants);
+        std::vector<PathMetrics> lanes = sweep.run();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+                             .count();
+
+        int identical = 1;
+        start = std::chrono::steady_clock::now();
+        for (uint64_t v = 0; v < strategies; v++) {
+            BacktestResult r = runBacktest(*sim, variants[v]);
+            const PathMetrics& m = lanes[v];
+            if (r.total_pnl != m.total_pnl || r.num_trades != m.num_trades ||
+                r.win_count != m.win_count || r.max_drawdown != m.max_drawdown)
+                identical = 0;
+        }
+        double serial = std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+                            .count();
+
+        const uint64_t bars = sim->bars() > (size_t)kFirstBar ? sim->bars() - kFirstBar : 0;
+        const double work = (double)strategies * (double)bars;
+        out->strategies = strategies;
+        out->bars = bars;
+        out->shapes = sweep.shapes();
+        out->seconds = seconds;
+        out->serial_seconds = serial;
+        out->strategy_bars_per_second = seconds > 0.0 ? work / seconds : 0.0;
+        out->serial_strategy_bars_per_second = serial > 0.0 ? work / serial : 0.0;
+        out->identical = identical;
+        return AXIOM_OK;
+    });
+}
+
+int axiom_tiling_benchmark(const char* request_json, size_t length, uint64_t strategies,
+                           axiom_tiling_bench* out) {
+    if (!request_json || !out) return fail(AXIOM_ERR_ARGUMENT, "null argument");
+    if (strategies < 1 || strategies > (uint64_t)1 << 20)
+        return fail(AXIOM_ERR_ARGUMENT, "strategies: 1 to 2^20");
+    bool parsed;
+    Request req = parseOrFail(request_json, length, parsed);
+    if (!parsed) return AXIOM_ERR_PARSE;
+    return guarded([&] {
+        std::vector<Strategy> variants = sweepVariants(req.strategy, strategies);
+        auto sim = sweepMarket(req.config, variants);
+        StrategySweep sweep(*sim, variants);
+        const uint64_t bars = sim->bars() > (size_t)kFirstBar ? sim->bars() - kFirstBar : 0;
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<PathMetrics> naive = sweep.run(std::max<size_t>(bars, 1));
+        double naive_seconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        size_t tile = 0;
+        start = std::chrono::steady_clock::now();
+        std::vector<PathMetrics> tiled = sweep.run(0, &tile);
+        double tiled_seconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        int identical = 1;
+        for (size_t i = 0; i < naive.size(); i++)
+            if (naive[i].total_pnl != tiled[i].total_pnl ||
+                naive[i].num_trades != tiled[i].num_trades ||
+                naive[i].win_count != tiled[i].win_count ||
+                naive[i].max_drawdown != tiled[i].max_drawdown)
+                identical = 0;
+
+        const double columns = (double)bars * (double)sweep.barBytes();
+        const bool fits = columns <= (double)(l2CacheBytes() / 2);
+        out->strategies = strategies;
+        out->bars = bars;
+        out->blocks = sweep.blocks();
+        out->tile_bars = tile;
+        out->bar_bytes = sweep.barBytes();
+        out->naive_seconds = naive_seconds;
+        out->tiled_seconds = tiled_seconds;
+        out->naive_read_bytes = fits ? columns : columns * (double)sweep.blocks();
+        out->tiled_read_bytes = columns;
+        out->identical = identical;
+        return AXIOM_OK;
+    });
+}
+
+// --- Results ---
+
+axiom_cancel* axiom_cancel_create(void) {
+    return new axiom_cancel;
+}
+
+void axiom_cancel_trigger(axiom_cancel* cancel) {
+    if (cancel) cancel->token.cancel();
+}
+
+void axiom_cancel_destroy(axiom_cancel* cancel) {
+    delete cancel;
+}
+
+axiom_result* axiom_run_json(const char* request_json, size_t length) {
+    return axiom_run_json_cancellable(request_json, length, nullptr);
+}
+
+axiom_result* axiom_run_json_cancellable(const char* request_json, size_t length,
+                                         axiom_cancel* cancel) {
+    return axiom_run_json_checkpointed(request_json, length, cancel, nullptr);
+}
+
+axiom_result* axiom_run_json_checkpointed(const char* request_json, size_t length,
+                                          axiom_cancel* cancel,
+                                          const axiom_checkpoint* checkpoint) {
+    if (!request_json)
+        return failNull<axiom_result>(AXIOM_ERR_ARGUMENT, "null argument");
+
+    bool parsed;
+    Request req = parseOrFail(request_json, length, parsed);
+    if (!parsed) return nullptr;
+
+    axiom_result* handle = nullptr;
+    guarded([&] {
+        CancelToken local;
+        CancelToken& token = cancel ? cancel->token : local;
+        if (req.timeout_ms > 0) token.setTimeout(req.timeout_ms);
+
+        Pipeline pipeline(req);
+        applyCheckpoint(pipeline, checkpoint);
+        auto res = std::make_unique<axiom_result>();
+        res->status = pipeline.run(&token);
+        pipeline.saveCheckpoint();
+        res->sim = pipeline.shareSimulator();
+        res->first = pipeline.start();
+        res->result = pipeline.takeResult();
+        handle = res.release();
+        return AXIOM_OK;
+    });
+    return handle;
+}
+
+int axiom_stream_json(const char* request_json, size_t length,
+                      axiom_line_fn on_line, void* user) {
+    return axiom_stream_json_cancellable(request_json, length, on_line, user, nullptr);
+}
+
+int axiom_stream_json_cancellable(const char* request_json, size_t length,
+                                  axiom_line_fn on_line, void* user,
+                                  axiom_cancel* cancel) {
+    return axiom_stream_json_checkpointed(request_json, length, on_line, user, cancel, nullptr);
+}
+
+int axiom_stream_json_checkpointed(const char* request_json, size_t length,
+                                   axiom_line_fn on_line, void* user,
+                                   axiom_cancel* cancel,
+                                   const axiom_checkpoint* checkpoint) {
+    if (!request_json || !on_line) return fail(AXIOM_ERR_ARGUMENT, "null argument");
+
+    bool parsed;
+    Request req = parseOrFail(request_json, length, parsed);
+    if (!parsed) return AXIOM_ERR_PARSE;
+
+    return guarded([&] {
+        CancelToken local;
+        CancelToken& token = cancel ? cancel->token : local;
+        if (req.timeout_ms > 0) token.setTimeout(req.timeout_ms);
+
+        Pipeline pipeline(req);
+        applyCheckpoint(pipeline, checkpoint);
+        bool stopped = false;
+        streamNdjson(pipeline, [&](const std::string& line) {
+            stopped = on_line(line.data(), line.size(), user) != 0;
+            return !stopped;
+        }, &token);
+        pipeline.saveCheckpoint();
+        return stopped ? fail(AXIOM_ERR_STOPPED, "stopped by callback") : AXIOM_OK;
+    });
+}
+
+int axiom_result_status(const axiom_result* result, int* status) {
+    if (!result || !status) return fail(AXIOM_ERR_ARGUMENT, "null argument");
+    switch (result->status) {
+        case RunStatus::CANCELLED: *status = AXIOM_RUN_CANCELLED; break;
+        case RunStatus::DEADLINE_EXCEEDED: *status = AXIOM_RUN_DEADLINE_EXCEEDED; break;
+        default: *status = AXIOM_RUN_COMPLETED; break;
+    }
+    return AXIOM_OK;
+}
+
+int axiom_result_metrics(const axiom_result* result, axiom_metrics* out) {
+    if (!result || !out) return fail(AXIOM_ERR_ARGUMENT, "null argument");
+    const BacktestResult& r = result->result;
+    out->total_pnl = r.total_pnl;
+    out->num_trades = r.num_trades;
+    out->win_rate = r.num_trades > 0 ? (double)r.win_count / r.num_trades : 0.0;
+    out->max_drawdown = r.max_drawdown;
+    return AXIOM_OK;
+}
+
+int axiom_result_column(const axiom_result* result, int column,
+                        const void** data, size_t* length, int* dtype) {
+    if (!result || !data || !length || !dtype)
+        return fail(AXIOM_ERR_ARGUMENT, "null argument");
+
+    const BacktestResult& r = result->result;
+    switch (column) {
+        case AXIOM_COL_PRICE:
+            *data = resultPrices(result, length);
+            *dtype = AXIOM_F64;
+            return AXIOM_OK;
+        case AXIOM_COL_EQUITY:
+            return exportVector(r.equity, AXIOM_F64, data, length, dtype);
+        case AXIOM_COL_TRADE_BAR:
+            return exportVector(r.trades.bars(), AXIOM_I64, data, length, dtype);
+        case AXIOM_COL_TRADE_SIDE:
+            return exportVector(r.trades.sides(), AXIOM_U8, data, length, dtype);
+        case AXIOM_COL_TRADE_PRICE:
+            return exportVector(r.trades.prices(), AXIOM_F64, data, length, dtype);
+        case AXIOM_COL_TRADE_PNL:
+            return exportVector(r.trades.pnls(), AXIOM_F64, data, length, dtype);
+        case AXIOM_COL_TRADE_ENTRY:
+            return exportVector(r.trades.entries(), AXIOM_I64, data, length, dtype);
+        default:
+            return fail(AXIOM_ERR_ARGUMENT, "not a result column");
+    }
+}
+
+const char* axiom_result_json(axiom_result* result, size_t* length) {
+    if (!result) return failNull<const char>(AXIOM_ERR_ARGUMENT, "null result");
+    int status = guarded([&] {
+        if (result->json.empty()) {
+            size_t count;
+            const double* prices = resultPrices(result, &count);
+            appendResultJson(result->json, prices, count, result->result, result->status);
+        }
+        return AXIOM_OK;
+    });
+    if (status != AXIOM_OK) return nullptr;
+    if (length) *length = result->json.size();
+    return result->json.c_str();
+}
+
+int axiom_result_save_trades(const axiom_result* result, const char* path) {
+    if (!result || !path) return fail(AXIOM_ERR_ARGUMENT, "null argument");
+    std::ofstream bin(path, std::ios::binary);
+    if (!bin) return fail(AXIOM_ERR_ARGUMENT, "Cannot open file");
+    result->result.trades.writeBinary(bin);
+    return bin ? AXIOM_OK : fail(AXIOM_ERR_INTERNAL, "write failed");
+}
+
+void axiom_result_destroy(axiom_result* result) {
+    delete result;
+}
+
+} // extern "C"
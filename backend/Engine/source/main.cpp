@@ -1,223 +1,336 @@
-#include "../include/MarketSimulator.hpp"
-#include "../include/strategy.hpp"
-#include "../include/config.hpp"
-#include <iostream>
+// AXIOM command line engine: a thin wrapper over libaxiom (include/axiom.h).
+// Reads the request JSON from a file argument or stdin, prints the result.
+#include "../include/axiom.h"
+#include "../include/HttpServer.hpp"
+#include "../include/SimulateService.hpp"
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
 #include <fstream>
-#include <vector>
+#include <iostream>
+#include <iterator>
 #include <string>
-#include <cmath>
-#include <algorithm>
-
-// Based on your screenshot, json.hpp is in ../json/
-#include "../json/json.hpp"
-
-using json = nlohmann::json;
 
-// ---------------------------------------------------------
-// 1. HELPER FUNCTIONS
-// ---------------------------------------------------------
-
-// Map string names to SignalType Enum
-SignalType signalFromString(const std::string& s) {
-    if (s == "RSI") return SignalType::RSI;
-    if (s == "VOLATILITY") return SignalType::VOLATILITY;
-    if (s == "VOLATILITY_MA") return SignalType::VOLATILITY_MA;
-    if (s == "MA" || s == "SMA") return SignalType::MA_SHORT;
-    if (s == "MA_LONG") return SignalType::MA_LONG;
-    if (s == "Price") return SignalType::PRICE;
-    return SignalType::PRICE; // Default
+static int printError(const std::string& message) {
+    std::string escaped;
+    for (char c : message) {
+        if (c == '"' || c == '\\') escaped += '\\';
+        if ((unsigned char)c >= 0x20) escaped += c;
+    }
+    std::cout << "{ \"error\": \"" << escaped << "\" }" << std::endl;
+    return 1;
 }
 
-// Compare LHS vs RHS (Constant or Signal)
-inline bool evaluateCondition(const MarketSimulator& sim, const Condition& c, int t) {
-    // Get Left Value
-    double left = sim.getSignal(c.lhs, t);
-    
-    // Get Right Value
-    double right = 0.0;
-    if (c.rhs_type == OperandType::SIGNAL) {
-        right = sim.getSignal(c.rhs_signal, t);
-    } else {
-        right = c.rhs_value;
-    }
+static axiom_cancel* volatile interrupt = nullptr;
 
-    // Compare
-    if (c.op == '>') return left > right;
-    if (c.op == '<') return left < right;
-    if (c.op == '=') return std::abs(left - right) < 0.0001;
-    return false;
+extern "C" void onInterrupt(int sig) {
+    if (interrupt) axiom_cancel_trigger(interrupt);
+    std::signal(sig, SIG_DFL);
 }
 
-// ---------------------------------------------------------
-// 2. MAIN EXECUTION
-// ---------------------------------------------------------
-
 int main(int argc, char* argv[]) {
-    // --- INPUT PARSING ---
-    json input;
-    
-    // Check if a file argument was provided (e.g. for debugging)
-    if (argc > 1) {
-        std::ifstream f(argv[1]);
-        if (f.is_open()) {
-            f >> input;
-        } else {
-            // If file fails, return empty JSON to prevent python crash
-            std::cout << "{ \"error\": \"Cannot open file\" }" << std::endl;
-            return 1;
+    // --- COMMAND LINE ---
+    // engine [input.json] [--trades-bin <path>] [--isa scalar|sse2|avx2|avx512]
+    // engine [input.json] --stream            (NDJSON chunks, see Pipeline.hpp)
+    // engine [input.json] [--checkpoint <path> [--checkpoint-every N]] [--resume <path>]
+    // engine --serve [--host 127.0.0.1] [--port 8000] [--workers N] [--timeout-ms N]
+    //               [--max-inflight-mb N] [--interactive-bars N] [--cache-mb N]
+    //               [--batch-window-ms X]
+    // engine --generate-library <path> [--markets Trending,Sideways,MeanReversion]
+    //               [--seeds A-B] [--timesteps N] [--workers N]
+    // engine --convert-prices <in.csv> <out.f64> [--column NAME]
+    // engine --bench-book [--events N] [--markets Trending,...] [--seeds A]
+    // engine --bench-agents [--agents N] [--steps N] [--workers N] [--seeds A]
+    // engine --bench-models [--paths N] [--timesteps N] [--markets GBM,GARCH,...] [--seeds A]
+    // engine [input.json] --bench-paths [--paths N]
+    // engine [input.json] --bench-sweep [--strategies N]
+    // engine [input.json] --bench-tiling [--strategies N]
+    // --library <path> (any mode) takes prices from a generated library
+    const char* input_path = nullptr;
+    const char* trades_bin_path = nullptr;
+    bool serve = false;
+    bool stream = false;
+    axiom_checkpoint checkpoint = {nullptr, 0, nullptr};
+    const char* library_path = nullptr;
+    const char* generate_path = nullptr;
+    const char* convert_from = nullptr;
+    const char* convert_to = nullptr;
+    const char* column = nullptr;
+    bool bench_book = false;
+    bool bench_agents = false;
+    bool bench_models = false;
+    bool bench_paths = false;
+    bool bench_sweep = false;
+    bool bench_tiling = false;
+    uint64_t events = 10000000;
+    uint64_t agents = 1000000;
+    uint64_t steps = 10000;
+    uint64_t paths = 4096;
+    uint64_t variants = 256;
+    std::string markets;
+    std::string seeds = "0-99";
+    int timesteps = 1000;
+    int workers = 0;
+    HttpServerOptions server_opts;
+    ServiceOptions service_opts;
+    SchedulerOptions& scheduling = service_opts.scheduling;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--trades-bin" && i + 1 < argc) trades_bin_path = argv[++i];
+        else if (arg == "--serve") serve = true;
+        else if (arg == "--stream") stream = true;
+        else if (arg == "--checkpoint" && i + 1 < argc) checkpoint.save_path = argv[++i];
+        else if (arg == "--checkpoint-every" && i + 1 < argc)
+            checkpoint.every_bars = (uint64_t)std::atoll(argv[++i]);
+        else if (arg == "--resume" && i + 1 < argc) checkpoint.resume_path = argv[++i];
+        else if (arg == "--library" && i + 1 < argc) library_path = argv[++i];
+        else if (arg == "--generate-library" && i + 1 < argc) generate_path = argv[++i];
+        else if (arg == "--convert-prices" && i + 2 < argc) {
+            convert_from = argv[++i];
+            convert_to = argv[++i];
         }
-    } else {
-        // Default: Read from Python Pipe (stdin)
-        try {
-            // Check if stdin has data
-            if (std::cin.peek() == std::ifstream::traits_type::eof()) {
-                return 0; 
-            }
-            std::cin >> input;
-        } catch (...) {
-            std::cout << "{ \"error\": \"Invalid JSON input\" }" << std::endl;
-            return 1;
+        else if (arg == "--column" && i + 1 < argc) column = argv[++i];
+        else if (arg == "--bench-book") bench_book = true;
+        else if (arg == "--bench-agents") bench_agents = true;
+        else if (arg == "--bench-models") bench_models = true;
+        else if (arg == "--bench-paths") bench_paths = true;
+        else if (arg == "--bench-sweep") bench_sweep = true;
+        else if (arg == "--bench-tiling") bench_tiling = true;
+        else if (arg == "--events" && i + 1 < argc) events = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--agents" && i + 1 < argc) agents = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--steps" && i + 1 < argc) steps = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--paths" && i + 1 < argc) paths = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--strategies" && i + 1 < argc)
+            variants = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--markets" && i + 1 < argc) markets = argv[++i];
+        else if (arg == "--seeds" && i + 1 < argc) seeds = argv[++i];
+        else if (arg == "--timesteps" && i + 1 < argc) timesteps = std::atoi(argv[++i]);
+        else if (arg == "--host" && i + 1 < argc) server_opts.host = argv[++i];
+        else if (arg == "--port" && i + 1 < argc) server_opts.port = std::atoi(argv[++i]);
+        else if (arg == "--workers" && i + 1 < argc)
+            workers = server_opts.workers = scheduling.executors = std::atoi(argv[++i]);
+        else if (arg == "--max-inflight-mb" && i + 1 < argc) {
+            scheduling.memory_budget = (size_t)std::atoll(argv[++i]) << 20;
+            scheduling.interactive_reserve = scheduling.memory_budget / 4;
         }
+        else if (arg == "--cache-mb" && i + 1 < argc)
+            service_opts.cache_bytes = (size_t)std::atoll(argv[++i]) << 20;
+        else if (arg == "--batch-window-ms" && i + 1 < argc)
+            service_opts.batch_window_us = (int64_t)(std::atof(argv[++i]) * 1000);
+        else if (arg == "--interactive-bars" && i + 1 < argc)
+            scheduling.interactive_cost = (uint64_t)std::atoll(argv[++i]);
+        else if (arg == "--timeout-ms" && i + 1 < argc)
+            service_opts.default_timeout_ms = std::atoll(argv[++i]);
+        else if (arg == "--isa" && i + 1 < argc) {
+            if (axiom_set_isa(argv[++i]) != AXIOM_OK)
+                return printError("Unsupported ISA");
+        }
+        else if (!input_path) input_path = argv[i];
     }
 
-    // --- MARKET CONFIG ---
-    Config cfg;
-    std::string mkt = input.value("market", "Trending");
-    
-    // Handle Frontend string differences
-    if (mkt == "Mean Reversion" || mkt == "MeanReversion") cfg.market = "MeanReverting";
-    else if (mkt == "Sideways") cfg.market = "Sideways";
-    else cfg.market = "Trending";
-
-    cfg.timesteps = input.value("timesteps", 1000);
-    cfg.seed = input.value("seed", 42);
-
-    // --- RUN SIMULATION ---
-    MarketSimulator sim(cfg);
-    sim.runMarket();
-
-    // --- PRE-COMPUTE INDICATORS ---
-    // We compute ALL indicators so the user can select any combination
-    sim.computeRSI(14);
-    sim.computeVolatility(20);
-    sim.computeMovingAverage(20, 50); // Short=20, Long=50
-    sim.computeMovingAverageOnSignal(SignalType::VOLATILITY, SignalType::VOLATILITY_MA, 50);
-
-    const auto& prices = sim.getPrices();
-
-    // --- PARSE STRATEGY ---
-    Strategy strategy;
-    strategy.name = "User Strategy";
-
-    auto parseRules = [&](const json& rules, std::vector<Condition>& target) {
-        for (const auto& r : rules) {
-            Condition c;
-            
-            // 1. LHS
-            c.lhs = signalFromString(r.value("lhs", "Price"));
-            
-            // 2. Operator
-            std::string op = r.value("op", ">");
-            c.op = op[0];
-
-            // 3. RHS Logic
-            std::string type = r.value("rhs_type", "CONSTANT");
-            if (type == "SIGNAL") {
-                c.rhs_type = OperandType::SIGNAL;
-                // Read 'rhs_signal' from JSON, map to Enum
-                c.rhs_signal = signalFromString(r.value("rhs_signal", "Price"));
-            } else {
-                c.rhs_type = OperandType::CONSTANT;
-                c.rhs_value = r.value("rhs_value", 0.0);
-            }
-            
-            target.push_back(c);
+    if (markets.empty())
+        markets = bench_models ? "GBM,GARCH,Jumps,Switching" : "Trending,Sideways,MeanReversion";
+
+    // --- RECORDED PRICES ---
+    if (convert_from) {
+        auto start = std::chrono::steady_clock::now();
+        uint64_t bars = 0;
+        if (axiom_prices_convert(convert_from, column, convert_to, &bars) != AXIOM_OK)
+            return printError(axiom_last_error());
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "{ \"bars\": " << bars << ", \"seconds\": " << seconds << " }" << std::endl;
+        return 0;
+    }
+
+    // --- ORDER BOOK BENCHMARK ---
+    // one line per market: events of order flow matched, single-threaded
+    if (bench_book) {
+        uint32_t seed = (uint32_t)std::strtoul(seeds.c_str(), nullptr, 10);
+        for (size_t at = 0; at <= markets.size();) {
+            size_t comma = std::min(markets.find(',', at), markets.size());
+            std::string market = markets.substr(at, comma - at);
+            at = comma + 1;
+            axiom_book_bench b;
+            if (axiom_book_benchmark(market.c_str(), events, seed, &b) != AXIOM_OK)
+                return printError(axiom_last_error());
+            std::cout << "{ \"market\": \"" << market << "\", \"events\": " << b.events
+                      << ", \"seconds\": " << b.seconds
+                      << ", \"events_per_second\": " << (uint64_t)b.events_per_second
+                      << ", \"fills\": " << b.fills << ", \"volume\": " << b.volume << " }"
+                      << std::endl;
         }
-    };
+        return 0;
+    }
 
-    if (input.contains("strategy")) {
-        if (input["strategy"].contains("buy")) parseRules(input["strategy"]["buy"], strategy.buy);
-        if (input["strategy"].contains("sell")) parseRules(input["strategy"]["sell"], strategy.sell);
+    // --- AGENT MARKET BENCHMARK ---
+    if (bench_agents) {
+        uint64_t seed = std::strtoull(seeds.c_str(), nullptr, 10);
+        axiom_agents_bench b;
+        if (axiom_agents_benchmark(agents, steps, seed, workers, &b) != AXIOM_OK)
+            return printError(axiom_last_error());
+        std::cout << "{ \"agents\": " << b.agents << ", \"steps\": " << b.steps
+                  << ", \"threads\": " << b.threads << ", \"seconds\": " << b.seconds
+                  << ", \"agent_steps_per_second\": " << (uint64_t)b.agent_steps_per_second
+                  << ", \"last_price\": " << b.last_price << " }" << std::endl;
+        return 0;
     }
 
-    // --- EXECUTE TRADES ---
-    bool in_pos = false;
-    double entry_price = 0.0;
-    std::vector<json> trades; // Store trades for JSON output
-    
-    double equity = 0.0;
-    int win_count = 0;
-    int trade_count = 0;
-    double max_dd = 0.0;
-    double peak = 0.0;
-
-    // Start at t=50 to allow indicators to warm up
-    for (int t = 50; t < (int)prices.size(); t++) {
-        
-        // Evaluate BUY (AND logic)
-        bool buy_signal = !strategy.buy.empty();
-        for (const auto& c : strategy.buy) {
-            if (!evaluateCondition(sim, c, t)) {
-                buy_signal = false;
-                break;
-            }
+    // --- STOCHASTIC MODEL BENCHMARK ---
+    // one line per model: batched paths against the regime walk
+    if (bench_models) {
+        uint64_t seed = std::strtoull(seeds.c_str(), nullptr, 10);
+        for (size_t at = 0; at <= markets.size();) {
+            size_t comma = std::min(markets.find(',', at), markets.size());
+            std::string market = markets.substr(at, comma - at);
+            at = comma + 1;
+            axiom_model_bench b;
+            if (axiom_model_benchmark(market.c_str(), paths, (uint64_t)timesteps, seed, &b) !=
+                AXIOM_OK)
+                return printError(axiom_last_error());
+            std::cout << "{ \"market\": \"" << market << "\", \"paths\": " << b.paths
+                      << ", \"bars\": " << b.bars << ", \"seconds\": " << b.seconds
+                      << ", \"ns_per_path_bar\": " << b.ns_per_path_bar
+                      << ", \"walk_ns_per_path_bar\": " << b.walk_ns_per_path_bar
+                      << ", \"mean_last_price\": " << b.mean_last_price << " }" << std::endl;
         }
+        return 0;
+    }
 
-        // Evaluate SELL (AND logic)
-        bool sell_signal = !strategy.sell.empty();
-        for (const auto& c : strategy.sell) {
-            if (!evaluateCondition(sim, c, t)) {
-                sell_signal = false;
-                break;
-            }
+    // --- PATH LIBRARY ---
+    if (generate_path) {
+        // "A-B" inclusive, or a single seed
+        size_t dash = seeds.find('-');
+        uint32_t first = (uint32_t)std::strtoul(seeds.c_str(), nullptr, 10);
+        uint32_t last = dash == std::string::npos
+            ? first : (uint32_t)std::strtoul(seeds.c_str() + dash + 1, nullptr, 10);
+        if (last < first) return printError("--seeds: A-B with A <= B");
+        uint32_t count = last - first + 1;
+        if (axiom_library_generate(generate_path, markets.c_str(), first, count,
+                                   timesteps, workers) != AXIOM_OK)
+            return printError(axiom_last_error());
+        std::cout << "{ \"seeds\": " << count << ", \"timesteps\": " << timesteps << " }"
+                  << std::endl;
+        return 0;
+    }
+    if (library_path && axiom_library_use(library_path) != AXIOM_OK)
+        return printError(axiom_last_error());
+
+    // --- SERVER MODE ---
+    if (serve) {
+        SimulateService service(service_opts);
+        HttpServer server(server_opts, [&](const HttpRequest& req, HttpReply reply) {
+            service.handle(req, std::move(reply));
+        });
+        server.setInline(SimulateService::isControl);
+        std::string error;
+        std::cerr << "Serving on http://" << server_opts.host << ":" << server_opts.port << std::endl;
+        if (!server.run(error)) {
+            std::cerr << "Server error: " << error << std::endl;
+            return 1;
         }
+        return 0;
+    }
 
-        // State Machine
-        if (!in_pos && buy_signal) {
-            in_pos = true;
-            entry_price = prices[t];
-            
-            trades.push_back({
-                {"t", t},
-                {"type", "BUY"},
-                {"price", prices[t]}
-            });
+    // --- INPUT ---
+    std::string text;
+    
+    // Check if a file argument was provided (e.g. for debugging)
+    if (input_path) {
+        std::ifstream f(input_path, std::ios::binary);
+        if (!f.is_open()) {
+            // If file fails, return error JSON to prevent python crash
+            return printError("Cannot open file");
         }
-        else if (in_pos && sell_signal) {
-            in_pos = false;
-            double pnl = prices[t] - entry_price;
-            equity += pnl;
-            trade_count++;
-            if (pnl > 0) win_count++;
-
-            trades.push_back({
-                {"t", t},
-                {"type", "SELL"},
-                {"price", prices[t]},
-                {"pnl", pnl}
-            });
+        text.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+    } else {
+        // Default: Read from Python Pipe (stdin)
+        if (std::cin.peek() == std::ifstream::traits_type::eof()) {
+            return 0; 
         }
+        text.assign(std::istreambuf_iterator<char>(std::cin), std::istreambuf_iterator<char>());
+    }
 
-        // Track Max Drawdown
-        peak = std::max(peak, equity);
-        double dd = peak - equity;
-        if (dd > max_dd) max_dd = dd;
+    // --- PATH BLOCK BENCHMARK ---
+    // the request on --paths seeds from its own: lane blocks against a run per seed
+    if (bench_paths) {
+        axiom_paths_bench b;
+        if (axiom_paths_benchmark(text.data(), text.size(), paths, &b) != AXIOM_OK)
+            return printError(axiom_last_error());
+        std::cout << "{ \"paths\": " << b.paths << ", \"bars\": " << b.bars
+                  << ", \"seconds\": " << b.seconds << ", \"serial_seconds\": " << b.serial_seconds
+                  << ", \"path_bars_per_second\": " << (uint64_t)b.path_bars_per_second
+                  << ", \"identical\": " << (b.identical ? "true" : "false") << " }" << std::endl;
+        return 0;
     }
 
-    // --- JSON OUTPUT ---
-    json output;
-    output["prices"] = prices;       // Frontend App.js expects "prices"
-    output["trades"] = trades;       // Frontend App.js expects "trades"
-    
-    output["metrics"] = {
-        {"total_pnl", std::round(equity * 100.0) / 100.0},
-        {"num_trades", trade_count},
-        {"win_rate", trade_count > 0 ? (double)win_count/trade_count : 0.0},
-        {"max_drawdown", std::round(max_dd * 100.0) / 100.0}
-    };
+    // --- SWEEP BENCHMARK ---
+    // --strategies variants of the request's strategy: lanes against a Backtester each
+    if (bench_sweep) {
+        axiom_sweep_bench b;
+        if (axiom_sweep_benchmark(text.data(), text.size(), variants, &b) != AXIOM_OK)
+            return printError(axiom_last_error());
+        std::cout << "{ \"strategies\": " << b.strategies << ", \"bars\": " << b.bars
+                  << ", \"shapes\": " << b.shapes << ", \"seconds\": " << b.seconds
+                  << ", \"serial_seconds\": " << b.serial_seconds
+                  << ", \"strategy_bars_per_second\": " << (uint64_t)b.strategy_bars_per_second
+                  << ", \"serial_strategy_bars_per_second\": "
+                  << (uint64_t)b.serial_strategy_bars_per_second
+                  << ", \"identical\": " << (b.identical ? "true" : "false") << " }" << std::endl;
+        return 0;
+    }
+
+    // --- TILING BENCHMARK ---
+    // the same variants' sweep in the naive order and tiled
+    if (bench_tiling) {
+        axiom_tiling_bench b;
+        if (axiom_tiling_benchmark(text.data(), text.size(), variants, &b) != AXIOM_OK)
+            return printError(axiom_last_error());
+        std::cout << "{ \"strategies\": " << b.strategies << ", \"bars\": " << b.bars
+                  << ", \"blocks\": " << b.blocks << ", \"tile_bars\": " << b.tile_bars
+                  << ", \"bar_bytes\": " << b.bar_bytes
+                  << ", \"naive_seconds\": " << b.naive_seconds
+                  << ", \"tiled_seconds\": " << b.tiled_seconds
+                  << ", \"naive_read_bytes\": " << (uint64_t)b.naive_read_bytes
+                  << ", \"tiled_read_bytes\": " << (uint64_t)b.tiled_read_bytes
+                  << ", \"identical\": " << (b.identical ? "true" : "false") << " }" << std::endl;
+        return 0;
+    }
+
+    // --- RUN ---
+    // Ctrl-C / SIGTERM stop the run at the next chunk and print what was
+    // reached ("status": "cancelled"); a second one kills
+    interrupt = axiom_cancel_create();
+    std::signal(SIGINT, onInterrupt);
+    std::signal(SIGTERM, onInterrupt);
+
+    if (stream) {
+        auto write_line = [](const char* line, size_t length, void*) {
+            std::cout.write(line, (std::streamsize)length);
+            std::cout.flush();          // each chunk reaches the pipe right away
+            return std::cout ? 0 : 1;
+        };
+        if (axiom_stream_json_checkpointed(text.data(), text.size(), write_line,
+                                           nullptr, interrupt, &checkpoint) != AXIOM_OK)
+            return printError(axiom_last_error());
+        return 0;
+    }
+
+    axiom_result* result = axiom_run_json_checkpointed(text.data(), text.size(), interrupt,
+                                                       &checkpoint);
+    if (!result) return printError(axiom_last_error());
+
+    if (trades_bin_path && axiom_result_save_trades(result, trades_bin_path) != AXIOM_OK) {
+        axiom_result_destroy(result);
+        return printError(axiom_last_error());
+    }
 
     // Print to stdout for Python to catch
-    std::cout << output.dump() << std::endl;
+    size_t length = 0;
+    const char* output = axiom_result_json(result, &length);
+    std::cout.write(output, (std::streamsize)length);
+    std::cout << std::endl;
 
+    axiom_result_destroy(result);
     return 0;
-}
\ No newline at end of file
+}
@@ -2,28 +2,35 @@
 #include <algorithm>
 
 bool Strategy::isValid(const MarketSimulator& sim) const {
-    auto available = sim.getAvailableSignals();
-
-    auto hasSignal = [&](SignalType s) {
+    auto hasSignal = [&](const Condition& c, SignalType s) {
+        const MarketSimulator* on = c.timeframe == 1 ? &sim : sim.timeframe(c.timeframe);
+        if (!on) return false;
+        auto available = on->getAvailableSignals();
         return std::find(available.begin(), available.end(), s)
                != available.end();
     };
 
     for (const auto& c : buy) {
-        if (!hasSignal(c.lhs)) return false;
+        if (!hasSignal(c, c.lhs)) return false;
         if (c.rhs_type == OperandType::SIGNAL &&
-            !hasSignal(c.rhs_signal))
+            !hasSignal(c, c.rhs_signal))
             return false;
     }
 
     for (const auto& c : sell) {
-        if (!hasSignal(c.lhs)) return false;
+        if (!hasSignal(c, c.lhs)) return false;
         if (c.rhs_type == OperandType::SIGNAL &&
-            !hasSignal(c.rhs_signal))
+            !hasSignal(c, c.rhs_signal))
             return false;
     }
 
     return true;
 }
 
+void Strategy::addTimeframes(MarketSimulator& sim) const {
+    for (const auto* side : {&buy, &sell})
+        for (const auto& c : *side)
+            sim.addTimeframe(c.timeframe);
+}
+
 
@@ -1,12 +1,23 @@
-from flask import Flask, request, jsonify
+from flask import Flask, Response, request, jsonify
 from flask_cors import CORS
 import json
 import subprocess
 import os
 
+import axiom
+
 app = Flask(__name__)
 CORS(app)
 
+# In-process engine (libaxiom) when it has been built, else the CLI binary
+engine = axiom.load()
+
+# Runs without "timeout_ms" get this deadline. The engine stops itself and
+# returns partial results ("status": "deadline_exceeded"); the subprocess
+# timeout is only a backstop for an engine that does not answer.
+DEFAULT_TIMEOUT_MS = int(os.environ.get("ENGINE_TIMEOUT_MS", "30000"))
+BACKSTOP_GRACE_S = 15
+
 @app.route("/")
 def home():
     return "Hello, server is running!"
@@ -16,9 +27,29 @@ def simulate():
     if not request.is_json:
         return jsonify({"error": "Invalid JSON"}), 400
 
-    
     data = request.json
-    
+    payload = request.get_data()
+    if "timeout_ms" not in data:
+        data["timeout_ms"] = DEFAULT_TIMEOUT_MS
+        payload = json.dumps(data).encode()
+    timeout_ms = data["timeout_ms"]
+    if (isinstance(timeout_ms, bool) or not isinstance(timeout_ms, (int, float))
+            or not timeout_ms >= 0 or timeout_ms == float("inf")):
+        return jsonify({"error": "timeout_ms: milliseconds, 0 for no deadline"}), 400
+
+    # Streaming: forward the engine's NDJSON lines as a chunked response
+    if data.get("stream"):
+        return Response(stream_lines(payload), mimetype="application/x-ndjson")
+
+    # 1. In-process: request bytes straight into the engine
+    if engine is not None:
+        try:
+            body = engine.simulate_json(payload)
+            return Response(body, mimetype="application/json")
+        except axiom.AxiomError as e:
+            print("Engine Error:", str(e))
+            return jsonify({"error": "Simulation failed", "details": str(e)}), 500
+
     # 2. Convert to string for piping
     json_input = json.dumps(data)
     
@@ -41,7 +72,9 @@ def simulate():
             input=json_input,       # Send JSON to C++ std::cin
             capture_output=True,    # Capture C++ std::cout
             text=True,
-            check=True
+            check=True,
+            # 0 = no deadline: the engine runs to the end, so no backstop either
+            timeout=timeout_ms / 1000 + BACKSTOP_GRACE_S if timeout_ms > 0 else None
         )
 
         engine_output = completed.stdout.strip()
@@ -56,6 +89,9 @@ def simulate():
     
         
 
+    except subprocess.TimeoutExpired:
+        print("C++ Error: engine did not finish in time")
+        return jsonify({"error": "Simulation timed out"}), 504
     except subprocess.CalledProcessError as e:
         print("C++ Error:", e.stderr)
         return jsonify({"error": "Simulation failed", "details": e.stderr}), 500
@@ -63,5 +99,29 @@ def simulate():
         print("Server Error:", str(e))
         return jsonify({"error": str(e)}), 500
 
+def engine_path():
+    exe_path = os.path.join(".", "Engine", "engine.exe")
+    return exe_path if os.path.exists(exe_path) else "./engine.exe"
+
+def stream_lines(payload):
+    if engine is not None:
+        try:
+            yield from engine.stream_json(payload)
+        except axiom.AxiomError as e:
+            yield (json.dumps({"type": "error", "error": str(e)}) + "\n").encode()
+        return
+
+    # CLI fallback: engine --stream prints one line per chunk and flushes
+    proc = subprocess.Popen([engine_path(), "--stream"], stdin=subprocess.PIPE,
+                            stdout=subprocess.PIPE)
+    try:
+        proc.stdin.write(payload)
+        proc.stdin.close()
+        for line in proc.stdout:
+            yield line
+    finally:
+        proc.kill()
+        proc.wait()
+
 if __name__ == "__main__":  
     app.run(port=8000, debug=True)
\ No newline at end of file
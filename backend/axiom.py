@@ -0,0 +1,316 @@
+"""ctypes binding for libaxiom (see Engine/include/axiom.h).
+
+Runs the C++ engine in-process instead of spawning engine.exe:
+
+    engine = Engine()                        # finds libaxiom next to Engine/
+    body = engine.simulate_json(raw_bytes)   # same JSON the CLI prints
+
+    for line in engine.stream_json(raw_bytes):  # NDJSON lines as they are ready
+        ...
+
+    with engine.simulate(request_dict) as result:
+        equity = result.column("equity")     # numpy view, no copy
+        result.metrics                       # dict
+
+    with engine.simulator("Trending", 10000, seed=7) as sim:
+        sim.compute_signals()
+        rsi = sim.column("rsi")              # numpy view, no copy
+        with sim.run_strategy({"buy": [...], "sell": [...]}) as result:
+            ...
+
+Column arrays are views into engine memory and keep their owner from
+being collected; they are valid until it is closed (the end of its with
+block) and, for a simulator, until its next generate().
+"""
+import ctypes
+import json
+import os
+import queue
+import sys
+import threading
+
+ABI_VERSION = 1
+
+_HERE = os.path.dirname(os.path.abspath(__file__))
+_LIB_NAMES = {
+    "win32": "axiom.dll",
+    "darwin": "libaxiom.dylib",
+}
+
+# axiom_column / axiom_dtype values from axiom.h
+SIM_COLUMNS = {         # axiom_sim_column
+    "price": 0,
+    "ma_short": 1,
+    "ma_long": 2,
+    "rsi": 3,
+    "volatility": 4,
+    "volatility_ma": 5,
+}
+RESULT_COLUMNS = {      # axiom_result_column
+    "price": 0,         # the run's prices, from bar 0 or the resumed bar
+    "equity": 16,
+    "trade_bar": 17,
+    "trade_side": 18,
+    "trade_price": 19,
+    "trade_pnl": 20,
+    "trade_entry": 21,
+}
+RUN_STATUS = {0: "completed", 1: "cancelled", 2: "deadline_exceeded"}
+_DTYPES = {
+    0: (ctypes.c_double, "float64"),
+    1: (ctypes.c_float, "float32"),
+    2: (ctypes.c_int64, "int64"),
+    3: (ctypes.c_uint8, "uint8"),
+}
+
+
+class AxiomError(RuntimeError):
+    pass
+
+
+class _Metrics(ctypes.Structure):
+    _fields_ = [
+        ("total_pnl", ctypes.c_double),
+        ("num_trades", ctypes.c_int64),
+        ("win_rate", ctypes.c_double),
+        ("max_drawdown", ctypes.c_double),
+    ]
+
+
+# int (*axiom_line_fn)(const char* line, size_t length, void* user)
+_LINE_FN = ctypes.CFUNCTYPE(ctypes.c_int, ctypes.c_void_p, ctypes.c_size_t, ctypes.c_void_p)
+
+
+def _default_path():
+    name = _LIB_NAMES.get(sys.platform, "libaxiom.so")
+    return os.environ.get("AXIOM_LIB", os.path.join(_HERE, "Engine", name))
+
+
+def _bind(lib):
+    vp, sz, ip = ctypes.c_void_p, ctypes.c_size_t, ctypes.POINTER(ctypes.c_int)
+    col = [vp, ctypes.c_int, ctypes.POINTER(vp), ctypes.POINTER(sz), ip]
+
+    lib.axiom_abi_version.restype = ctypes.c_int
+    lib.axiom_last_error.restype = ctypes.c_char_p
+    lib.axiom_set_isa.argtypes = [ctypes.c_char_p]
+    lib.axiom_isa.restype = ctypes.c_char_p
+    lib.axiom_sim_create.argtypes = [ctypes.c_char_p, ctypes.c_int, ctypes.c_uint32, ctypes.c_int]
+    lib.axiom_sim_create.restype = vp
+    lib.axiom_sim_destroy.argtypes = [vp]
+    lib.axiom_sim_generate.argtypes = [vp]
+    lib.axiom_sim_compute_signals.argtypes = [vp]
+    lib.axiom_sim_column.argtypes = col
+    lib.axiom_sim_run_strategy.argtypes = [vp, ctypes.c_char_p, sz]
+    lib.axiom_sim_run_strategy.restype = vp
+    lib.axiom_run_json.argtypes = [ctypes.c_char_p, sz]
+    lib.axiom_run_json.restype = vp
+    lib.axiom_stream_json.argtypes = [ctypes.c_char_p, sz, _LINE_FN, vp]
+    lib.axiom_result_json.argtypes = [vp, ctypes.POINTER(sz)]
+    lib.axiom_result_json.restype = vp
+    lib.axiom_result_status.argtypes = [vp, ip]
+    lib.axiom_result_metrics.argtypes = [vp, ctypes.POINTER(_Metrics)]
+    lib.axiom_result_column.argtypes = col
+    lib.axiom_result_destroy.argtypes = [vp]
+    return lib
+
+
+def _column(lib, fn, owner, handle, columns, kind, name):
+    """Zero-copy numpy view of column `name`, kept alive by owner."""
+    import numpy as np
+
+    if name not in columns:
+        raise AxiomError(f"not a {kind} column: {name!r}")
+    data, length, dtype = ctypes.c_void_p(), ctypes.c_size_t(), ctypes.c_int()
+    status = fn(handle, columns[name],
+                ctypes.byref(data), ctypes.byref(length), ctypes.byref(dtype))
+    if status != 0:
+        raise AxiomError(lib.axiom_last_error().decode())
+    if length.value == 0:
+        return np.empty(0, dtype=_DTYPES[dtype.value][1])
+
+    ctype = _DTYPES[dtype.value][0]
+    buf = (ctype * length.value).from_address(data.value)
+    buf._owner = owner         # keep the engine memory alive
+    return np.ctypeslib.as_array(buf)
+
+
+class Result:
+    """Owns one axiom_result handle."""
+
+    def __init__(self, lib, handle):
+        self._lib = lib
+        self._handle = handle
+
+    def close(self):
+        if self._handle:
+            self._lib.axiom_result_destroy(self._handle)
+            self._handle = None
+
+    __del__ = close
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+    def json(self):
+        """Response body as bytes (copied out of the engine)."""
+        length = ctypes.c_size_t()
+        ptr = self._lib.axiom_result_json(self._handle, ctypes.byref(length))
+        if not ptr:
+            raise AxiomError(self._lib.axiom_last_error().decode())
+        return ctypes.string_at(ptr, length.value)
+
+    @property
+    def status(self):
+        """"completed", or why the run stopped early (partial results)."""
+        code = ctypes.c_int()
+        self._lib.axiom_result_status(self._handle, ctypes.byref(code))
+        return RUN_STATUS[code.value]
+
+    @property
+    def metrics(self):
+        m = _Metrics()
+        self._lib.axiom_result_metrics(self._handle, ctypes.byref(m))
+        return {name: getattr(m, name) for name, _ in _Metrics._fields_}
+
+    def column(self, name):
+        """Zero-copy numpy view of a result column (RESULT_COLUMNS)."""
+        return _column(self._lib, self._lib.axiom_result_column, self, self._handle,
+                       RESULT_COLUMNS, "result", name)
+
+
+class Simulator:
+    """Owns one axiom_sim handle: prices and indicator columns."""
+
+    def __init__(self, lib, handle):
+        self._lib = lib
+        self._handle = handle
+
+    def close(self):
+        if self._handle:
+            self._lib.axiom_sim_destroy(self._handle)
+            self._handle = None
+
+    __del__ = close
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+    def _check(self, status):
+        if status != 0:
+            raise AxiomError(self._lib.axiom_last_error().decode())
+
+    def generate(self):
+        """Regenerate the prices; earlier column views are invalidated."""
+        self._check(self._lib.axiom_sim_generate(self._handle))
+
+    def compute_signals(self):
+        self._check(self._lib.axiom_sim_compute_signals(self._handle))
+
+    def column(self, name):
+        """Zero-copy numpy view of a simulator column (SIM_COLUMNS)."""
+        return _column(self._lib, self._lib.axiom_sim_column, self, self._handle,
+                       SIM_COLUMNS, "simulator", name)
+
+    def run_strategy(self, strategy):
+        """Backtest {"buy": [...], "sell": [...]} on these prices."""
+        payload = json.dumps(strategy).encode()
+        handle = self._lib.axiom_sim_run_strategy(self._handle, payload, len(payload))
+        if not handle:
+            raise AxiomError(self._lib.axiom_last_error().decode())
+        return Result(self._lib, handle)
+
+
+class Engine:
+    def __init__(self, path=None):
+        self._lib = _bind(ctypes.CDLL(path or _default_path()))
+        version = self._lib.axiom_abi_version()
+        if version != ABI_VERSION:
+            raise AxiomError(f"libaxiom ABI {version}, expected {ABI_VERSION}")
+
+    @property
+    def isa(self):
+        return self._lib.axiom_isa().decode()
+
+    def set_isa(self, name):
+        if self._lib.axiom_set_isa(name.encode()) != 0:
+            raise AxiomError(self._lib.axiom_last_error().decode())
+
+    def simulator(self, market="Trending", timesteps=10000, seed=0, float32=False):
+        """A generated Simulator; call compute_signals() for the indicators."""
+        handle = self._lib.axiom_sim_create(market.encode(), timesteps, seed, int(float32))
+        if not handle:
+            raise AxiomError(self._lib.axiom_last_error().decode())
+        sim = Simulator(self._lib, handle)
+        sim.generate()
+        return sim
+
+    def run(self, payload):
+        """Run a raw request (bytes) and return a Result."""
+        handle = self._lib.axiom_run_json(payload, len(payload))
+        if not handle:
+            raise AxiomError(self._lib.axiom_last_error().decode())
+        return Result(self._lib, handle)
+
+    def simulate_json(self, payload):
+        """Raw request bytes in, response JSON bytes out."""
+        with self.run(payload) as result:
+            return result.json()
+
+    def stream_json(self, payload):
+        """Raw request bytes in, NDJSON lines (bytes) out as the run advances.
+
+        The engine runs on a helper thread; closing the generator early
+        stops it at the next chunk.
+        """
+        lines = queue.Queue(maxsize=16)
+        stop = threading.Event()
+        done = object()
+        error = []
+
+        @_LINE_FN
+        def on_line(ptr, length, _user):
+            if stop.is_set():
+                return 1
+            lines.put(ctypes.string_at(ptr, length))
+            return 0
+
+        def run():
+            status = self._lib.axiom_stream_json(payload, len(payload), on_line, None)
+            if status != 0 and not stop.is_set():
+                error.append(self._lib.axiom_last_error().decode())
+            lines.put(done)
+
+        worker = threading.Thread(target=run, daemon=True)
+        worker.start()
+        try:
+            while True:
+                line = lines.get()
+                if line is done:
+                    break
+                yield line
+        finally:
+            stop.set()
+            while worker.is_alive():        # unblock a pending put()
+                try:
+                    lines.get(timeout=0.1)
+                except queue.Empty:
+                    pass
+        if error:
+            raise AxiomError(error[0])
+
+    def simulate(self, request):
+        return self.run(json.dumps(request).encode())
+
+
+def load(path=None):
+    """Engine if libaxiom can be loaded, else None."""
+    try:
+        return Engine(path)
+    except (OSError, AxiomError):
+        return None
@@ -133,7 +133,8 @@ export default function App() {
           <div className="field">
             <label>MARKET REGIME</label>
             <div className="regime-toggle">
-              {["Trending", "Sideways", "Mean Reversion"].map(m => (
+              {["Trending", "Sideways", "Mean Reversion", "Agents",
+                "GBM", "GARCH", "Jumps", "Switching"].map(m => (
                 <div 
                   key={m} 
                   className={`opt ${market === m ? "active" : ""}`} 